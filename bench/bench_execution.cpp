@@ -0,0 +1,57 @@
+// Inputs for the OpenMP execution policy: the cost of one parallel region
+// per thread count, and whole steps under each --exec strategy. Feed the
+// fork/join figure to ExecutionPolicy::setForkJoinCost to skip calibration.
+#include <benchmark/benchmark.h>
+#include "../include/execution_policy.hpp"
+#include "../include/simulation.hpp"
+#include <atomic>
+#include <omp.h>
+
+static void BM_ForkJoin(benchmark::State &state)
+{
+    const int threads = static_cast<int>(state.range(0));
+    std::atomic<int> arrivals(0);
+
+    for (auto _ : state)
+    {
+#pragma omp parallel num_threads(threads)
+        {
+            arrivals.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    benchmark::DoNotOptimize(arrivals.load());
+    state.counters["threads"] = threads;
+}
+BENCHMARK(BM_ForkJoin)->Arg(2)->Arg(4)->Arg(8)->UseRealTime()->Unit(benchmark::kMicrosecond);
+
+// Step time with every phase serial (0), parallel (1) or cost-model gated (2)
+static void BM_GatedStep(benchmark::State &state)
+{
+    const int num_traders = static_cast<int>(state.range(0));
+    const ExecutionStrategy strategy = state.range(1) == 0   ? ExecutionStrategy::SERIAL
+                                       : state.range(1) == 1 ? ExecutionStrategy::PARALLEL
+                                                             : ExecutionStrategy::AUTO;
+
+    ExecutionPolicy &execution = ExecutionPolicy::instance();
+    ExecutionStrategy previous = execution.getStrategy();
+    execution.calibrate();
+    execution.setStrategy(strategy);
+
+    TradingSimulation sim(num_traders, 170.0, 10000.0, 12345);
+    for (int i = 0; i < 50; i++)
+        sim.step();
+
+    for (auto _ : state)
+        sim.step();
+
+    execution.setStrategy(previous);
+
+    state.SetItemsProcessed(state.iterations());
+    state.counters["traders"] = num_traders;
+    state.SetLabel(state.range(1) == 0 ? "serial" : state.range(1) == 1 ? "parallel" : "auto");
+}
+BENCHMARK(BM_GatedStep)
+    ->ArgsProduct({{12, 1000, 10000}, {0, 1, 2}})
+    ->UseRealTime()
+    ->Unit(benchmark::kMicrosecond);
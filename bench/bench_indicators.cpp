@@ -0,0 +1,62 @@
+// Indicator benchmarks: the from-scratch TechnicalIndicators kernels over
+// several window sizes, and the streaming IndicatorEngine per tick.
+#include <benchmark/benchmark.h>
+#include "../include/trader.hpp"
+#include "../include/indicator_engine.hpp"
+#include "../include/counter_rng.hpp"
+#include <vector>
+
+static std::vector<double> makePriceWindow(int size)
+{
+    CounterRng rng(7, 0);
+    std::vector<double> prices(size);
+    double price = 170.0;
+    for (int i = 0; i < size; i++)
+    {
+        price += rng.uniform(i) - 0.5;
+        prices[i] = price;
+    }
+    return prices;
+}
+
+static void BM_CalculateRSI(benchmark::State &state)
+{
+    std::vector<double> prices = makePriceWindow(static_cast<int>(state.range(0)));
+    for (auto _ : state)
+        benchmark::DoNotOptimize(TechnicalIndicators::calculateRSI(prices));
+}
+BENCHMARK(BM_CalculateRSI)->Arg(50)->Arg(200)->Arg(1000);
+
+static void BM_CalculateMACD(benchmark::State &state)
+{
+    std::vector<double> prices = makePriceWindow(static_cast<int>(state.range(0)));
+    for (auto _ : state)
+        benchmark::DoNotOptimize(TechnicalIndicators::calculateMACD(prices));
+}
+BENCHMARK(BM_CalculateMACD)->Arg(50)->Arg(200)->Arg(1000);
+
+static void BM_CalculateBollinger(benchmark::State &state)
+{
+    std::vector<double> prices = makePriceWindow(static_cast<int>(state.range(0)));
+    for (auto _ : state)
+        benchmark::DoNotOptimize(TechnicalIndicators::calculateBollingerBands(prices));
+}
+BENCHMARK(BM_CalculateBollinger)->Arg(50)->Arg(200)->Arg(1000);
+
+// One tick of the shared engine with the default RSI/MACD/Bollinger set
+static void BM_IndicatorEngineUpdate(benchmark::State &state)
+{
+    std::vector<double> prices = makePriceWindow(4096);
+    IndicatorEngine engine;
+    IndicatorSet ids = engine.addDefaultSet();
+    size_t tick = 0;
+
+    for (auto _ : state)
+    {
+        engine.update(prices[tick++ & 4095]);
+        benchmark::DoNotOptimize(engine.getRSI(ids.rsi));
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_IndicatorEngineUpdate);
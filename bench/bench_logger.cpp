@@ -0,0 +1,42 @@
+// Logger throughput: trades per second through each DataLogger mode
+#include <benchmark/benchmark.h>
+#include "../include/logger.hpp"
+
+enum LoggerMode
+{
+    CSV_SYNC,
+    BINARY_SYNC,
+    CSV_ASYNC,
+    BINARY_ASYNC
+};
+
+static void BM_LogTrade(benchmark::State &state)
+{
+    LoggerMode mode = static_cast<LoggerMode>(state.range(0));
+    bool binary = mode == BINARY_SYNC || mode == BINARY_ASYNC;
+    bool async = mode == CSV_ASYNC || mode == BINARY_ASYNC;
+
+    DataLogger logger("bench_logs");
+    logger.setFormat(binary ? LogFormat::BINARY : LogFormat::CSV);
+    logger.initialize(false, 0, 1, static_cast<int>(mode));
+    if (async)
+        logger.startAsync(LogBackpressure::BLOCK);
+
+    ExecutedTrade trade{0, 1, 2, 3, 4, 170.0, 10, 0.0};
+    for (auto _ : state)
+    {
+        trade.trade_id++;
+        trade.buy_order_id += 2;
+        trade.sell_order_id += 2;
+        trade.timestamp += 0.001;
+        logger.logTrade(trade);
+    }
+
+    // Count the drain so async numbers include the I/O they deferred
+    logger.flush();
+
+    state.SetItemsProcessed(state.iterations());
+    static const char *labels[] = {"csv", "binary", "csv/async", "binary/async"};
+    state.SetLabel(labels[mode]);
+}
+BENCHMARK(BM_LogTrade)->DenseRange(CSV_SYNC, BINARY_ASYNC)->UseRealTime();
@@ -0,0 +1,203 @@
+// Order book benchmarks: insertion, matching, cancel and modify for both
+// book engines over synthetic order flow at several book depths.
+#include <benchmark/benchmark.h>
+#include "../include/order_book.hpp"
+#include "../include/counter_rng.hpp"
+#include <vector>
+
+static constexpr double MID_PRICE = 170.0;
+static constexpr double TICK = 0.01;
+
+// Deterministic limit orders spread over `depth` ticks on each side of the
+// mid. Non-crossing flow rests bids below and asks above the mid; crossing
+// flow shifts both sides across it so matchOrders() has work to do.
+static std::vector<Order> makeOrderFlow(int count, int depth, bool crossing, std::uint32_t seed)
+{
+    CounterRng rng(seed, 0);
+    std::vector<Order> orders;
+    orders.reserve(count);
+
+    for (int i = 0; i < count; i++)
+    {
+        bool is_buy = rng.uniformInt(i, 2, 0) == 0;
+        int offset = 1 + rng.uniformInt(i, depth, 1);
+        int quantity = 1 + rng.uniformInt(i, 20, 2);
+        if (crossing)
+            offset -= depth / 2;
+
+        double price = is_buy ? MID_PRICE - offset * TICK : MID_PRICE + offset * TICK;
+        orders.emplace_back(0, 1 + i % 1000, is_buy ? OrderType::BUY : OrderType::SELL, price, quantity, i * 0.001);
+    }
+
+    return orders;
+}
+
+static OrderBookType bookType(const benchmark::State &state)
+{
+    return state.range(1) ? OrderBookType::TICK : OrderBookType::MAP;
+}
+
+// Resting inserts into a book already holding `depth` levels per side
+static void BM_AddOrder(benchmark::State &state)
+{
+    const int depth = static_cast<int>(state.range(0));
+    const int batch = 1000;
+    std::vector<Order> prefill = makeOrderFlow(depth * 4, depth, false, 1);
+    std::vector<Order> flow = makeOrderFlow(batch, depth, false, 2);
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        auto book = createOrderBook(bookType(state), TICK);
+        for (const auto &order : prefill)
+            book->addOrder(order);
+        state.ResumeTiming();
+
+        for (const auto &order : flow)
+            book->addOrder(order);
+        benchmark::DoNotOptimize(book->getBestBid());
+    }
+
+    state.SetItemsProcessed(state.iterations() * batch);
+    state.SetLabel(state.range(1) ? "tick" : "map");
+}
+BENCHMARK(BM_AddOrder)->ArgsProduct({{16, 256, 4096}, {0, 1}});
+
+// Same flow through the bulk addOrders() path
+static void BM_AddOrders(benchmark::State &state)
+{
+    const int depth = static_cast<int>(state.range(0));
+    const int batch = 1000;
+    std::vector<Order> prefill = makeOrderFlow(depth * 4, depth, false, 1);
+    std::vector<Order> flow = makeOrderFlow(batch, depth, false, 2);
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        auto book = createOrderBook(bookType(state), TICK);
+        book->addOrders(prefill.data(), prefill.size());
+        state.ResumeTiming();
+
+        book->addOrders(flow.data(), flow.size());
+        benchmark::DoNotOptimize(book->getBestBid());
+    }
+
+    state.SetItemsProcessed(state.iterations() * batch);
+    state.SetLabel(state.range(1) ? "tick" : "map");
+}
+BENCHMARK(BM_AddOrders)->ArgsProduct({{16, 256, 4096}, {0, 1}});
+
+// One matchOrders() over a step's worth of crossing flow
+static void BM_MatchOrders(benchmark::State &state)
+{
+    const int depth = static_cast<int>(state.range(0));
+    const int batch = 2000;
+    const MatchingMode mode = state.range(2) ? MatchingMode::BATCH_AUCTION : MatchingMode::CONTINUOUS;
+    std::vector<Order> prefill = makeOrderFlow(depth * 4, depth, false, 3);
+    std::vector<Order> flow = makeOrderFlow(batch, depth, true, 4);
+    size_t trades = 0;
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        auto book = createOrderBook(bookType(state), TICK);
+        book->setMatchingMode(mode);
+        for (const auto &order : prefill)
+            book->addOrder(order);
+        for (const auto &order : flow)
+            book->addOrder(order);
+        state.ResumeTiming();
+
+        trades += book->matchOrders().size();
+    }
+
+    state.SetItemsProcessed(state.iterations() * batch);
+    state.counters["trades/iter"] = benchmark::Counter(static_cast<double>(trades) / state.iterations());
+    state.SetLabel(std::string(state.range(1) ? "tick" : "map") + (state.range(2) ? "/batch" : "/continuous"));
+}
+BENCHMARK(BM_MatchOrders)->ArgsProduct({{16, 256, 4096}, {0, 1}, {0, 1}});
+
+// Cancel every resting order by id
+static void BM_CancelOrder(benchmark::State &state)
+{
+    const int depth = static_cast<int>(state.range(0));
+    const int batch = 1000;
+    std::vector<Order> flow = makeOrderFlow(batch, depth, false, 5);
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        auto book = createOrderBook(bookType(state), TICK);
+        std::vector<int> ids;
+        ids.reserve(batch);
+        for (const auto &order : flow)
+            ids.push_back(book->addOrder(order));
+        state.ResumeTiming();
+
+        for (int id : ids)
+            benchmark::DoNotOptimize(book->cancelOrder(id));
+    }
+
+    state.SetItemsProcessed(state.iterations() * batch);
+    state.SetLabel(state.range(1) ? "tick" : "map");
+}
+BENCHMARK(BM_CancelOrder)->ArgsProduct({{16, 4096}, {0, 1}});
+
+// Reprice the oldest resting order back and forth between two levels while
+// `gap` cancelled ids sit between it and the live flow, as with a
+// long-resting GTC order among churning agents. A re-queue must cost the
+// same whatever the gap, and the order must stay findable and cancellable.
+static void BM_ModifyOldestOrder(benchmark::State &state)
+{
+    const int gap = static_cast<int>(state.range(0));
+    const int depth = 256;
+    std::vector<Order> flow = makeOrderFlow(1000, depth, false, 7);
+    auto book = createOrderBook(bookType(state), TICK);
+
+    int oldest = book->addOrder(Order(0, 1, OrderType::BUY, MID_PRICE - depth * TICK, 10, 0.0));
+    for (int i = 0; i < gap; i++)
+        book->cancelOrder(book->addOrder(Order(0, 2, OrderType::SELL, MID_PRICE + TICK, 1, 0.0)));
+    book->addOrders(flow.data(), flow.size());
+    const int resting = book->getBuyOrderCount() + book->getSellOrderCount();
+
+    int quantity = 10;
+    for (auto _ : state)
+    {
+        double price = MID_PRICE - (depth + 1 + quantity % 2) * TICK;
+        book->modifyOrder(oldest, ++quantity, price);
+        if (book->findOrder(oldest) == nullptr)
+        {
+            state.SkipWithError("modified order lost from the id index");
+            return;
+        }
+    }
+
+    if (!book->cancelOrder(oldest) || book->getBuyOrderCount() + book->getSellOrderCount() != resting - 1)
+        state.SkipWithError("modified order could not be cancelled");
+
+    state.SetItemsProcessed(state.iterations());
+    state.counters["dead ids"] = gap;
+    state.SetLabel(state.range(1) ? "tick" : "map");
+}
+BENCHMARK(BM_ModifyOldestOrder)->ArgsProduct({{0, 1000, 100000}, {0, 1}});
+
+// Top-of-book depth and side totals as the logger and TUI query them, over a
+// book holding `depth` levels per side with several orders queued on each
+static void BM_BookDepth(benchmark::State &state)
+{
+    const int depth = static_cast<int>(state.range(0));
+    std::vector<Order> flow = makeOrderFlow(depth * 16, depth, false, 6);
+    auto book = createOrderBook(bookType(state), TICK);
+    book->addOrders(flow.data(), flow.size());
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(book->getBuyDepth(5));
+        benchmark::DoNotOptimize(book->getSellDepth(5));
+        benchmark::DoNotOptimize(book->getBuyOrderCount() + book->getSellOrderCount());
+        benchmark::DoNotOptimize(book->getBuyQuantity() + book->getSellQuantity());
+    }
+
+    state.SetLabel(state.range(1) ? "tick" : "map");
+}
+BENCHMARK(BM_BookDepth)->ArgsProduct({{16, 256, 4096}, {0, 1}});
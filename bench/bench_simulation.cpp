@@ -0,0 +1,66 @@
+// End-to-end TradingSimulation::step() throughput over trader counts,
+// OpenMP thread counts, population layouts and activation modes.
+// items_per_second is steps/s.
+#include <benchmark/benchmark.h>
+#include "../include/simulation.hpp"
+#include <omp.h>
+
+static void BM_SimulationStep(benchmark::State &state)
+{
+    const int num_traders = static_cast<int>(state.range(0));
+    const int threads = static_cast<int>(state.range(1));
+    const PopulationLayout layout = state.range(2) ? PopulationLayout::SOA : PopulationLayout::OBJECTS;
+
+    int previous_threads = omp_get_max_threads();
+    omp_set_num_threads(threads);
+
+    TradingSimulation sim(num_traders, 170.0, 10000.0, 12345, layout);
+
+    // Fill the indicator and price windows before timing
+    for (int i = 0; i < 50; i++)
+        sim.step();
+
+    for (auto _ : state)
+        sim.step();
+
+    omp_set_num_threads(previous_threads);
+
+    state.SetItemsProcessed(state.iterations());
+    state.counters["traders"] = num_traders;
+    state.SetLabel(state.range(2) ? "soa" : "objects");
+}
+BENCHMARK(BM_SimulationStep)
+    ->ArgsProduct({{12, 1000, 10000}, {1, 2, 4}, {0, 1}})
+    ->UseRealTime()
+    ->Unit(benchmark::kMicrosecond);
+
+// Polled versus event-driven activation on one thread, OBJECTS layout
+static void BM_ActivationStep(benchmark::State &state)
+{
+    const int num_traders = static_cast<int>(state.range(0));
+    const bool event = state.range(1) != 0;
+
+    int previous_threads = omp_get_max_threads();
+    omp_set_num_threads(1);
+
+    TradingSimulation sim(num_traders, 170.0, 10000.0, 12345);
+    ActivationSettings settings;
+    settings.mode = event ? ActivationMode::EVENT : ActivationMode::POLL;
+    sim.setActivation(settings);
+
+    for (int i = 0; i < 50; i++)
+        sim.step();
+
+    for (auto _ : state)
+        sim.step();
+
+    omp_set_num_threads(previous_threads);
+
+    state.SetItemsProcessed(state.iterations());
+    state.counters["traders"] = num_traders;
+    state.SetLabel(event ? "event" : "poll");
+}
+BENCHMARK(BM_ActivationStep)
+    ->ArgsProduct({{1000, 10000}, {0, 1}})
+    ->UseRealTime()
+    ->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,99 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "timer_wheel.hpp"
+
+// Which traders TradingSimulation asks for a decision each step
+enum class ActivationMode
+{
+    POLL, // Every AI trader, every step
+    EVENT // Only traders whose wake-up condition fired (ActivationScheduler)
+};
+
+struct ActivationSettings
+{
+    ActivationMode mode = ActivationMode::POLL;
+    double mean_interval = 5.0; // Poisson arrivals: mean simulation seconds between wakes, 0 for none
+    double price_band = 0.02;   // Wake when the price leaves +-band of the last decision's, 0 for none
+    bool signal_wakes = true;   // Wake a strategy's traders when its shared signal turns on
+};
+
+// Wake-up conditions for event-driven activation.
+//
+// After each decision an agent is armed with a Poisson arrival, drawn on
+// its own counter stream (seed, agent, step) and kept in a TimerWheel over
+// steps, and a price band around the price it decided on. Agents armed on
+// the same step and price share one band, so arming is an append and the
+// two heaps of band edges (lowest upper edge and highest lower edge on top)
+// hold one entry per band rather than per agent. collect() touches only the
+// bands the price has left, their members and the timers that fire, never
+// every agent. Re-arming bumps the agent's generation rather than searching
+// for its old membership; bands are filtered once stale members outnumber
+// live ones. Signal wakes are the caller's: it knows which agents share a
+// signal and hands them to wake().
+class ActivationScheduler
+{
+private:
+    struct Member
+    {
+        int agent;
+        std::uint32_t generation;
+    };
+
+    struct Band
+    {
+        std::uint64_t step;
+        double price;
+        int edges; // Heap entries still naming the band; freed at 0
+        std::vector<Member> members;
+    };
+
+    struct Edge
+    {
+        double price;
+        int band;
+    };
+
+    double mean_steps = 0.0; // Mean arrival interval in steps, 0 for none
+    double price_band = 0.0;
+    unsigned int seed = 0;
+
+    TimerWheel arrivals;
+    std::vector<std::uint64_t> arrival_step; // Step each agent's live arrival fires on
+    std::vector<std::uint32_t> generation;   // Bumped on every arm, invalidating older memberships
+
+    std::vector<Band> bands;    // Pool of bands, reused through free_bands
+    std::vector<int> free_bands;
+    int open_band = -1;         // The band this step's arms join
+    std::vector<Edge> upper;    // Heap: fires once price >= edge
+    std::vector<Edge> lower;    // Heap: fires once price <= edge
+    size_t members = 0;         // Memberships over every band, stale ones included
+
+    std::vector<std::uint64_t> woken_step; // 1 + last step the agent was woken, 0 if never
+    std::vector<int> fired;                 // Scratch for the wheel
+    size_t armed = 0;                       // Agents armed at least once
+
+    int openBand(std::uint64_t step, double price);
+    void releaseEdge(int band);
+    void fireBand(int band, std::uint64_t step, std::vector<int> &woken);
+    void compact();
+
+public:
+    // Forget every agent and take mean_interval in steps of step_seconds;
+    // agents wake only once armed
+    void reset(int agents, const ActivationSettings &settings, double step_seconds, unsigned int rng_seed,
+               std::uint64_t step);
+
+    // Schedule agent's next arrival and band after it decided at step on price
+    void arm(int agent, std::uint64_t step, double price);
+
+    // Append every agent whose arrival or band fired by step at price, once
+    // per step and in no particular order
+    void collect(std::uint64_t step, double price, std::vector<int> &woken);
+
+    // Append agent unless it already woke this step
+    void wake(int agent, std::uint64_t step, std::vector<int> &woken);
+    bool isWoken(int agent, std::uint64_t step) const { return woken_step[agent] == step + 1; }
+
+    size_t getPendingArrivals() const { return arrivals.getPendingCount(); }
+};
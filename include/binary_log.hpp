@@ -0,0 +1,103 @@
+#pragma once
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Columnar binary log (.tslog).
+//
+// File layout (little-endian):
+//   header  "TSIMLOG1", u16 version, u16 column count,
+//           per column: u8 kind, u8 name length, name bytes
+//   blocks  u32 row count, then per column:
+//           i64 first value, i64 min delta, u8 width, (rows - 1) * width bytes
+//
+// Within a block every column is delta-encoded against the previous row and
+// stored frame-of-reference at the narrowest byte width that fits, so
+// sequential ids cost nothing and prices/timestamps a byte or two.
+enum class LogColumnKind : std::uint8_t
+{
+    INT = 0,    // Raw integer
+    FIXED2 = 1, // Decimal stored as value * 100, printed with two places like the CSV logs
+    FLOAT64 = 2 // Exact double bit pattern, for values that must round-trip (order prices)
+};
+
+struct LogColumn
+{
+    std::string name;
+    LogColumnKind kind;
+};
+
+class BinaryLogWriter
+{
+public:
+    static constexpr int BLOCK_ROWS = 4096;
+
+private:
+    std::vector<LogColumn> columns;
+    std::vector<std::int64_t> values; // Column-major, BLOCK_ROWS per column
+    std::vector<unsigned char> block; // Encoded block, sized for the worst case
+    int rows;
+    std::ofstream file;
+    std::uint64_t bytes_written;
+
+    void writeBlock();
+
+public:
+    explicit BinaryLogWriter(std::vector<LogColumn> schema);
+    ~BinaryLogWriter();
+
+    BinaryLogWriter(const BinaryLogWriter &) = delete;
+    BinaryLogWriter &operator=(const BinaryLogWriter &) = delete;
+
+    // Create the file and write the header; closes any previous file
+    bool open(const std::string &filename);
+    void close();
+    bool isOpen() const { return file.is_open(); }
+
+    // Append one row of column values; no allocation, a block write every BLOCK_ROWS rows
+    void appendRow(const std::int64_t *row)
+    {
+        for (size_t c = 0; c < columns.size(); c++)
+        {
+            values[c * BLOCK_ROWS + rows] = row[c];
+        }
+        if (++rows == BLOCK_ROWS)
+        {
+            writeBlock();
+        }
+    }
+
+    // Write the partial block and flush the file
+    void flush();
+
+    size_t getColumnCount() const { return columns.size(); }
+    std::uint64_t getBytesWritten() const { return bytes_written; }
+
+    // FIXED2 encoding of a double
+    static std::int64_t toFixed2(double value);
+
+    // FLOAT64 encoding of a double
+    static std::int64_t toFloat64(double value);
+};
+
+class BinaryLogReader
+{
+private:
+    std::vector<LogColumn> columns;
+    std::ifstream file;
+
+public:
+
+    // Open a file and parse its header. Returns false if it is not a .tslog file.
+    bool open(const std::string &filename);
+
+    const std::vector<LogColumn> &getColumns() const { return columns; }
+
+    // Decode the next block into column-major values[column][row].
+    // Returns the number of rows, 0 at end of file and -1 on a corrupt block.
+    int readBlock(std::vector<std::vector<std::int64_t>> &values);
+
+    // Decoded value of a column as a double, whatever its kind
+    static double toDouble(LogColumnKind kind, std::int64_t value);
+};
@@ -0,0 +1,163 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <type_traits>
+
+// Binary checkpoint (.tsck) of a whole simulation.
+//
+// File layout (native byte order; checkpoints are meant to be reloaded on
+// the machine or cluster that wrote them):
+//   header  "TSIMCKP1", u32 version, u32 reserved, u64 payload bytes
+//   payload fields in the fixed order each component's saveState() writes them
+//
+// Every field starts on an 8-byte boundary and arrays are a u64 count
+// followed by their raw elements, so a mapped file can be read in place:
+// arrays come back as views into the mapping and are copied only into the
+// containers that own them.
+class CheckpointWriter
+{
+private:
+    std::vector<char> bytes;
+
+    void pad()
+    {
+        bytes.resize((bytes.size() + 7) & ~static_cast<size_t>(7), 0);
+    }
+
+public:
+    CheckpointWriter();
+
+    template <typename T>
+    void put(const T &value)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "checkpoint fields must be trivially copyable");
+        putBytes(&value, sizeof(T));
+    }
+
+    template <typename T>
+    void putArray(const T *values, size_t count)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "checkpoint fields must be trivially copyable");
+        put(static_cast<std::uint64_t>(count));
+        putBytes(values, count * sizeof(T));
+    }
+
+    template <typename T>
+    void putVector(const std::vector<T> &values) { putArray(values.data(), values.size()); }
+
+    void putBytes(const void *data, size_t size)
+    {
+        size_t offset = bytes.size();
+        bytes.resize(offset + size);
+        if (size > 0)
+            std::memcpy(bytes.data() + offset, data, size);
+        pad();
+    }
+
+    // Header plus payload; the payload size is patched in here
+    const std::vector<char> &finish();
+
+    bool writeFile(const std::string &filename);
+};
+
+// Reads fields back in the order they were written. A short or mismatched
+// payload sets the failed flag and returns zeros from then on, so callers
+// check ok() once at the end instead of after every field.
+class CheckpointReader
+{
+private:
+    const char *data;
+    size_t size;
+    size_t offset;
+    bool failed;
+
+    const char *take(size_t count)
+    {
+        size_t aligned = (count + 7) & ~static_cast<size_t>(7);
+        if (failed || size - offset < aligned)
+        {
+            failed = true;
+            return nullptr;
+        }
+        const char *at = data + offset;
+        offset += aligned;
+        return at;
+    }
+
+public:
+    // bytes must hold a whole checkpoint (header included) and outlive the reader
+    CheckpointReader(const char *bytes, size_t length);
+
+    template <typename T>
+    T get()
+    {
+        T value{};
+        if (const char *at = take(sizeof(T)))
+            std::memcpy(&value, at, sizeof(T));
+        return value;
+    }
+
+    // View of an array in place; nullptr with count 0 on failure
+    template <typename T>
+    const T *getArray(size_t &count)
+    {
+        count = static_cast<size_t>(get<std::uint64_t>());
+        if (failed || count > (size - offset) / sizeof(T))
+        {
+            failed = true;
+            count = 0;
+            return nullptr;
+        }
+        return reinterpret_cast<const T *>(take(count * sizeof(T)));
+    }
+
+    template <typename T>
+    void getVector(std::vector<T> &values)
+    {
+        size_t count = 0;
+        const T *first = getArray<T>(count);
+        values.assign(first, first + count);
+    }
+
+    // Like getVector, but the stored length must match values.size()
+    template <typename T>
+    void getFixedVector(std::vector<T> &values)
+    {
+        size_t count = 0;
+        const T *first = getArray<T>(count);
+        if (count != values.size())
+        {
+            failed = true;
+            return;
+        }
+        std::copy(first, first + count, values.begin());
+    }
+
+    // Mark the checkpoint unusable, e.g. when it was saved with another configuration
+    void fail() { failed = true; }
+    bool ok() const { return !failed; }
+};
+
+// Read-only mapping of a checkpoint file
+class MappedCheckpoint
+{
+private:
+    const char *data;
+    size_t size;
+
+public:
+    MappedCheckpoint() : data(nullptr), size(0) {}
+    ~MappedCheckpoint();
+
+    MappedCheckpoint(const MappedCheckpoint &) = delete;
+    MappedCheckpoint &operator=(const MappedCheckpoint &) = delete;
+
+    // Map a file. Returns false if it cannot be read or is not a checkpoint.
+    bool open(const std::string &filename);
+
+    const char *getData() const { return data; }
+    size_t getSize() const { return size; }
+};
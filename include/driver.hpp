@@ -0,0 +1,81 @@
+#pragma once
+#include <iosfwd>
+#include <string>
+#include "simulation.hpp"
+#include "execution_policy.hpp"
+
+// Command-line settings shared by the TUI and headless drivers
+struct Config
+{
+    int num_traders = 12;
+    double initial_price = 170.0;
+    double initial_cash = 10000.0;
+    int duration_seconds = 60;
+    double time_scale = 1.0;
+    bool show_help = false;
+    int ensemble_count = 0;
+    unsigned int base_seed = 12345;
+    OrderBookType book_type = OrderBookType::MAP;
+    double tick_size = 0.01;
+    MatchingMode matching_mode = MatchingMode::CONTINUOUS;
+    double order_lifetime = TradingSimulation::DEFAULT_ORDER_LIFETIME;
+    PopulationLayout population_layout = PopulationLayout::OBJECTS;
+    LogFormat log_format = LogFormat::CSV;
+    int sim_threads = 1;
+    bool async_log = false;
+    LogBackpressure log_backpressure = LogBackpressure::BLOCK;
+    bool dynamic_schedule = false;
+    int chunk_size = 0; // 0: one pool's worth of sims per fetch
+    bool profile = false;
+    ExecutionStrategy exec_strategy = ExecutionStrategy::AUTO;
+    int instruments = 1;
+    double warmup_seconds = 0.0;
+    std::string load_checkpoint; // Start from this checkpoint instead of cold
+    std::string save_checkpoint; // Ensemble: write the shared warm start here
+    bool log_orders = false;
+    std::string replay_file;       // Replay this orders/trades log instead of simulating
+    std::string replay_output_dir; // Log the replayed trades here
+    std::string sweep_file;        // Run every config in this file, -E seeds each
+    std::string sweep_output = "sweep_results.csv";
+    std::string market_feed; // Publish each step to this shared-memory feed (market_feed.hpp)
+    ActivationSettings activation;
+};
+
+// Where this process sits among the MPI ranks. Built with USE_MPI it wraps
+// MPI_Init/MPI_Finalize around main; without, the process is a lone rank 0
+// and every collective below is local.
+class ProcessGroup
+{
+private:
+    int rank_index;
+    int rank_count;
+
+public:
+    ProcessGroup(int &argc, char **&argv);
+    ~ProcessGroup();
+
+    ProcessGroup(const ProcessGroup &) = delete;
+    ProcessGroup &operator=(const ProcessGroup &) = delete;
+
+    int rank() const { return rank_index; }
+    int size() const { return rank_count; }
+};
+
+Config parseArguments(int argc, char *argv[]);
+
+// interactive: the build has the TUI, so a bare run opens it
+void printHelp(bool interactive);
+
+// Per-phase latency table and work counters from getStats()
+void printStepProfile(const StepProfileSummary &profile, std::ostream &out);
+
+// Set up the execution policy and report build limits; call once after
+// parsing, before any simulation runs
+void prepareRun(const Config &config, const ProcessGroup &group);
+
+// --replay, --sweep or -E given
+bool isBatchRun(const Config &config);
+
+// Run the replay, sweep or ensemble config asks for and return the exit
+// code. Collective: every rank calls it.
+int runBatch(const Config &config, const ProcessGroup &group);
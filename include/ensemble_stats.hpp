@@ -0,0 +1,94 @@
+#pragma once
+#include <type_traits>
+#include "simulation.hpp"
+#include "quantile_sketch.hpp"
+
+// One finished ensemble simulation, sent between ranks as raw bytes
+struct SimulationSummaryPacket
+{
+    int simulation_index = -1;
+    SimulationStats stats{};
+};
+
+static_assert(std::is_trivially_copyable_v<SimulationSummaryPacket>, "SimulationSummaryPacket must be trivially copyable for MPI transfers.");
+
+// Welford mean/variance with min and max and the simulations they came from.
+// Two partial results combine exactly with Chan's pairwise update.
+struct RunningMoments
+{
+    long long count = 0;
+    double mean = 0.0;
+    double m2 = 0.0;
+    double min = 0.0;
+    double max = 0.0;
+    int min_index = -1;
+    int max_index = -1;
+
+    void add(double value, int simulation_index);
+    void merge(const RunningMoments &other);
+
+    // Population standard deviation, as printed in the ensemble summary
+    double stddev() const;
+};
+
+// Running ensemble summary. Packets can be added in any order as they
+// arrive; means and standard deviations use Welford's update so no
+// per-simulation history is kept, and quantiles come from fixed-size
+// sketches. Accumulators from different ranks or threads merge(), and the
+// whole object is trivially copyable, so MPI can reduce it as raw bytes.
+class EnsembleAccumulator
+{
+private:
+    int count;
+    long long total_trades;
+    double total_volume;
+    double sum_avg_price;
+    double sum_volatility;
+
+    RunningMoments trades;
+    RunningMoments volume;
+    RunningMoments volatility;
+    QuantileSketch trades_quantiles;
+    QuantileSketch volume_quantiles;
+    QuantileSketch volatility_quantiles;
+
+    SimulationSummaryPacket best; // Highest volume
+    SimulationSummaryPacket worst; // Lowest volume
+
+public:
+    EnsembleAccumulator();
+
+    void add(const SimulationSummaryPacket &packet);
+
+    // Fold in another accumulator. Ties for best/worst keep this side's
+    // simulation, so merging in rank order matches adding in rank order.
+    void merge(const EnsembleAccumulator &other);
+
+    int getCount() const { return count; }
+    long long getTotalTrades() const { return total_trades; }
+    double getTotalVolume() const { return total_volume; }
+
+    double getMeanTrades() const { return trades.mean; }
+    double getMeanVolume() const { return volume.mean; }
+    double getMeanPrice() const { return count ? sum_avg_price / count : 0.0; }
+    double getMeanVolatility() const { return count ? sum_volatility / count : 0.0; }
+
+    // Population standard deviations, as printed in the ensemble summary
+    double getStddevTrades() const { return trades.stddev(); }
+    double getStddevVolume() const { return volume.stddev(); }
+    double getStddevVolatility() const { return volatility.stddev(); }
+
+    const RunningMoments &getTradesMoments() const { return trades; }
+    const RunningMoments &getVolumeMoments() const { return volume; }
+    const RunningMoments &getVolatilityMoments() const { return volatility; }
+
+    // Estimated quantiles over simulations, q in [0, 1]
+    double getTradesQuantile(double q) const { return trades_quantiles.quantile(q); }
+    double getVolumeQuantile(double q) const { return volume_quantiles.quantile(q); }
+    double getVolatilityQuantile(double q) const { return volatility_quantiles.quantile(q); }
+
+    const SimulationSummaryPacket &getBest() const { return best; }
+    const SimulationSummaryPacket &getWorst() const { return worst; }
+};
+
+static_assert(std::is_trivially_copyable_v<EnsembleAccumulator>, "EnsembleAccumulator must be trivially copyable for MPI reductions.");
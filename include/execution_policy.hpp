@@ -0,0 +1,127 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+
+// Loops that may run as an OpenMP region, each with its own cost estimate
+enum class ParallelPhase
+{
+    GENERATE,     // Per-object order generation, one item per trader
+    POPULATION,   // SoA decision kernels, one item per trader in a group
+    INSTRUMENTS,  // Multi-instrument shard stage, one item per symbol
+    SETTLE,       // Bucketed settlement, one item per trade leg
+    TRADER_STATS, // Trader stats row formatting, one item per trader
+    COUNT
+};
+
+constexpr int PARALLEL_PHASE_COUNT = static_cast<int>(ParallelPhase::COUNT);
+
+const char *parallelPhaseName(ParallelPhase phase);
+
+enum class ExecutionMode
+{
+    SERIAL,       // No region at all
+    PARALLEL_FOR, // Static even split over the threads
+    BATCHED       // Dynamic chunks of batch items, for uneven item costs
+};
+
+// What the caller should run. Serial plans have threads == 1.
+struct ExecutionPlan
+{
+    ExecutionMode mode = ExecutionMode::SERIAL;
+    int threads = 1;
+    int batch = 1;
+
+    bool parallel() const { return mode != ExecutionMode::SERIAL; }
+};
+
+// --exec: AUTO uses the cost model, the others pin every phase (for timing)
+enum class ExecutionStrategy
+{
+    AUTO,
+    SERIAL,
+    PARALLEL
+};
+
+// One process-wide policy for every OpenMP region in the simulation.
+//
+// Each phase has a serial cost per item and a region overhead. A phase goes
+// parallel only if items * cost / threads + overhead beats the serial time
+// by GAIN_REQUIRED, with no more threads than each can be given at least
+// one overhead's worth of work. calibrate() measures the fork/join cost that
+// seeds every overhead; after that ParallelRegion timings take over: serial
+// runs refine the item cost, parallel runs the phase's actual overhead
+// (oversubscribed cores, cold or spinning teams), so a phase that loses in
+// parallel drifts back to serial. Overheads relax towards the calibrated
+// cost while a phase runs serially, so it is retried now and then. Inside
+// another parallel region (an ensemble worker, an instrument shard) every
+// plan is serial, so regions never nest.
+//
+// Only loops whose results do not depend on how the items are split are
+// gated here, so a plan changes timings but never output.
+class ExecutionPolicy
+{
+private:
+    std::atomic<double> fork_join_ns;
+    std::atomic<double> item_ns[PARALLEL_PHASE_COUNT];     // Serial cost per item
+    std::atomic<double> overhead_ns[PARALLEL_PHASE_COUNT]; // Parallel time beyond the split work
+    std::atomic<ExecutionStrategy> strategy;
+
+    ExecutionPolicy();
+
+public:
+    // Serial time over expected parallel time needed to go parallel
+    static constexpr double GAIN_REQUIRED = 1.25;
+    // Chunks per thread in BATCHED mode
+    static constexpr int BATCHES_PER_THREAD = 4;
+
+    static ExecutionPolicy &instance();
+
+    ExecutionPolicy(const ExecutionPolicy &) = delete;
+    ExecutionPolicy &operator=(const ExecutionPolicy &) = delete;
+
+    // Time parallel regions on this machine's thread count, each after a
+    // stretch of serial work as in a step. Call once at startup, outside any
+    // parallel region.
+    void calibrate();
+
+    ExecutionPlan plan(ParallelPhase phase, size_t items) const;
+
+    // Fold one measured run of a phase into its cost estimates
+    void record(ParallelPhase phase, const ExecutionPlan &plan, size_t items, double elapsed_ns);
+
+    void setStrategy(ExecutionStrategy value) { strategy.store(value, std::memory_order_relaxed); }
+    ExecutionStrategy getStrategy() const { return strategy.load(std::memory_order_relaxed); }
+
+    // Cost model inputs in nanoseconds, e.g. to seed them from a benchmark
+    // run. Setting the fork/join cost resets every phase's overhead to it.
+    void setForkJoinCost(double ns);
+    double getForkJoinCost() const { return fork_join_ns.load(std::memory_order_relaxed); }
+    void setItemCost(ParallelPhase phase, double ns);
+    double getItemCost(ParallelPhase phase) const;
+    double getOverhead(ParallelPhase phase) const;
+};
+
+// Plans a phase on construction and records its wall time on destruction:
+//
+//   ParallelRegion region(ParallelPhase::GENERATE, n);
+//   #pragma omp parallel for schedule(static) if (region.parallel()) num_threads(region.threads())
+class ParallelRegion
+{
+private:
+    ParallelPhase phase;
+    size_t items;
+    ExecutionPlan execution;
+    long long start_ns;
+
+public:
+    ParallelRegion(ParallelPhase phase, size_t items);
+    ~ParallelRegion();
+
+    ParallelRegion(const ParallelRegion &) = delete;
+    ParallelRegion &operator=(const ParallelRegion &) = delete;
+
+    const ExecutionPlan &plan() const { return execution; }
+    bool parallel() const { return execution.parallel(); }
+    int threads() const { return execution.threads; }
+    int batch() const { return execution.batch; }
+};
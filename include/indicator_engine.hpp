@@ -0,0 +1,159 @@
+#pragma once
+#include <vector>
+#include <tuple>
+#include "checkpoint.hpp"
+
+// Streaming technical indicators.
+// Every trader sees the same market price, so the simulation owns one
+// IndicatorEngine, feeds it each new price once per step, and traders read
+// the current values instead of recomputing them over private histories.
+// Each update is O(1) per registered parameter set.
+
+// Rolling mean/variance over the last `period` prices
+class RollingStats
+{
+private:
+    std::vector<double> window;
+    int period;
+    int next;
+    int count;
+    double sum;
+    double sum_sq;
+
+public:
+    explicit RollingStats(int period);
+
+    void update(double price);
+    bool isReady() const { return count >= period; }
+    double mean() const;
+    double stddev() const;
+    int getPeriod() const { return period; }
+
+    // Running state only; the parameters come from construction
+    void saveState(CheckpointWriter &out) const;
+    void loadState(CheckpointReader &in);
+};
+
+// Exponential moving average seeded with the SMA of its first `period` values
+class EmaState
+{
+private:
+    int period;
+    double multiplier;
+    double value;
+    double seed_sum;
+    int count;
+
+public:
+    explicit EmaState(int period);
+
+    void update(double x);
+    bool isReady() const { return count >= period; }
+    double getValue() const { return value; }
+
+    // Running state only; the parameters come from construction
+    void saveState(CheckpointWriter &out) const;
+    void loadState(CheckpointReader &in);
+};
+
+// Wilder-smoothed RSI
+class WilderRSI
+{
+private:
+    int period;
+    double previous_price;
+    double avg_gain;
+    double avg_loss;
+    int changes;
+    bool has_previous;
+
+public:
+    explicit WilderRSI(int period);
+
+    void update(double price);
+    bool isReady() const { return changes >= period; }
+    double getValue() const;
+    int getPeriod() const { return period; }
+
+    // Running state only; the parameters come from construction
+    void saveState(CheckpointWriter &out) const;
+    void loadState(CheckpointReader &in);
+};
+
+// MACD built from chained EMAs: fast/slow on price, signal on the MACD line
+class MacdState
+{
+private:
+    int fast_period;
+    int slow_period;
+    int signal_period;
+    EmaState fast;
+    EmaState slow;
+    EmaState signal;
+
+public:
+    MacdState(int fast_period, int slow_period, int signal_period);
+
+    void update(double price);
+    bool isReady() const { return signal.isReady(); }
+
+    // Returns {MACD line, Signal line, Histogram}
+    std::tuple<double, double, double> getValue() const;
+    bool matches(int f, int s, int sig) const { return f == fast_period && s == slow_period && sig == signal_period; }
+
+    // Running state only; the parameters come from construction
+    void saveState(CheckpointWriter &out) const;
+    void loadState(CheckpointReader &in);
+};
+
+// Parameter sets a trader reads from the engine
+struct IndicatorSet
+{
+    int rsi = -1;
+    int macd = -1;
+    int bollinger = -1;
+};
+
+class IndicatorEngine
+{
+private:
+    struct BollingerParams
+    {
+        int stats_index;
+        double std_dev;
+    };
+
+    std::vector<WilderRSI> rsi_states;
+    std::vector<MacdState> macd_states;
+    std::vector<RollingStats> rolling_stats;
+    std::vector<BollingerParams> bollinger_params;
+    long long samples;
+
+public:
+    IndicatorEngine();
+
+    // Register a parameter set and get an id for reads. Registering the same
+    // parameters twice returns the existing id.
+    int addRSI(int period = 14);
+    int addMACD(int fast_period = 12, int slow_period = 26, int signal_period = 9);
+    int addBollinger(int period = 20, double std_dev = 2.0);
+
+    // Register the default RSI(14), MACD(12,26,9) and Bollinger(20,2) sets
+    IndicatorSet addDefaultSet();
+
+    // Feed the next market price to every registered indicator
+    void update(double price);
+
+    // Current values. Indicators that are still warming up return the same
+    // neutral values TechnicalIndicators does (RSI 50, zeros otherwise).
+    double getRSI(int id) const;
+    std::tuple<double, double, double> getMACD(int id) const;
+    std::tuple<double, double, double> getBollinger(int id) const;
+
+    long long getSampleCount() const { return samples; }
+
+    // Indicator state for checkpoints. The loading engine must have the same
+    // parameter sets registered, as it does when built the same way.
+    void saveState(CheckpointWriter &out) const;
+    void loadState(CheckpointReader &in);
+};
@@ -0,0 +1,80 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include "../include/trader.hpp"
+#include "../include/market.hpp"
+#include "../include/order_book.hpp"
+#include "../include/logger.hpp"
+#include "../include/indicator_engine.hpp"
+#include "../include/reservations.hpp"
+
+// One symbol of a multi-instrument simulation: its own price process,
+// indicators, order book, logs and per-symbol trader agents. Agent i is
+// trader i's desk for this symbol; it holds the symbol's shares while cash
+// lives in the simulation's shared portfolio. A step touches nothing outside
+// the instrument, so each one can be stepped by its own worker thread.
+class Instrument
+{
+private:
+    std::string symbol;
+    int symbol_index;
+    Market market;
+    IndicatorEngine indicators;
+    std::unique_ptr<OrderBook> order_book;
+    std::vector<std::unique_ptr<Trader>> agents;
+    StrategyRuns agent_runs; // agents grouped by strategy
+    DataLogger logger;
+
+    std::vector<TraderOrder> order_slots;        // One per agent, reused every step
+    std::vector<Order> step_orders;              // Reused every step
+    std::vector<double> step_cash;               // Per trader, what this step settles against
+    std::vector<double> cash_delta;              // Per trader, from the last step
+    std::vector<ExecutedTrade> last_step_trades; // For volume logging and stats
+    size_t last_step_unsettled = 0;              // Fill legs an agent account refused
+    std::uint64_t steps_run = 0;                 // Step column of the order log
+    OrderReservations reservations;              // This symbol's resting orders
+    double order_lifetime;                       // Agent orders' GTT lifetime, 0 for GTC
+    std::vector<Order> expired_orders;           // Reused every step
+
+    void releaseExpiredOrders();
+
+public:
+    // seed is the simulation seed; the symbol index is mixed in so every
+    // symbol gets its own price path and agent RNG streams
+    Instrument(const std::string &symbol_name, int symbol_index, int num_traders,
+               double initial_price, double initial_cash, unsigned int seed,
+               const std::string &log_directory);
+
+    void setOrderBookType(OrderBookType type, double tick_size);
+    void setMatchingMode(MatchingMode mode);
+    void setOrderLifetime(double seconds) { order_lifetime = seconds; }
+
+    // One step against this symbol. free_cash[i] is the share of trader i's
+    // unreserved cash that new orders here may commit this step; the cash its
+    // resting buys here still reserve comes on top, so those fills are always
+    // paid. The change in spent/received cash is left in getCashDelta() for
+    // the simulation's reduce stage.
+    void step(double current_time, const std::vector<double> &free_cash);
+
+    // Market, indicators, book and agents for checkpoints. loadState() needs
+    // a freshly built instrument set up with the saved book type.
+    void saveState(CheckpointWriter &out) const;
+    void loadState(CheckpointReader &in);
+
+    // Move the symbol onto another simulation seed's streams
+    void reseed(unsigned int seed);
+
+    const std::string &getSymbol() const { return symbol; }
+    const Market &getMarket() const { return market; }
+    const OrderBook &getOrderBook() const { return *order_book; }
+    const std::vector<std::unique_ptr<Trader>> &getAgents() const { return agents; }
+    const std::vector<double> &getCashDelta() const { return cash_delta; }
+    const std::vector<ExecutedTrade> &getLastStepTrades() const { return last_step_trades; }
+    size_t getLastStepOrderCount() const { return step_orders.size(); }
+    size_t getLastStepUnsettledCount() const { return last_step_unsettled; }
+    size_t getDecisionCount() const { return agent_runs.indices.size(); } // AI agents asked per step
+    DataLogger &getLogger() { return logger; }
+    const OrderReservations &getReservations() const { return reservations; }
+};
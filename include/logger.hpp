@@ -4,43 +4,163 @@
 #include <fstream>
 #include <mutex>
 #include <memory>
+#include <thread>
+#include <atomic>
+#include <cstdint>
 #include "order.hpp"
 #include "trader.hpp"
+#include "trader_population.hpp"
+#include "binary_log.hpp"
+#include "spsc_ring.hpp"
+
+enum class LogFormat
+{
+    CSV,   // One text line per record
+    BINARY // Trades, prices and orders as columnar .tslog blocks (see binary_log.hpp)
+};
+
+// What an async log call does when its ring is full
+enum class LogBackpressure
+{
+    BLOCK, // Wait for the writer thread to make room
+    DROP,  // Discard the record and count it
+    GROW   // Queue it in an unbounded producer-side spill, drained into the ring later
+};
 
 class DataLogger
 {
 private:
+    // POD records queued to the writer thread in async mode
+    struct PriceRecord
+    {
+        double timestamp;
+        double price;
+        double volume;
+        int buy_orders;
+        int sell_orders;
+    };
+
+    struct DepthRecord
+    {
+        double timestamp;
+        double price;
+        int quantity;
+        bool is_buy;
+    };
+
+    struct OrderRecord
+    {
+        std::uint64_t step;
+        Order order;
+    };
+
+    struct TraderStatRecord
+    {
+        double timestamp;
+        int trader_id;
+        Strategy strategy;
+        double cash;
+        int holdings;
+        double net_worth;
+        double total_profit;
+        int trades_executed;
+        double rsi;
+        double macd;
+    };
+
+    // One ring per record type; spill is only touched by the producer
+    template <typename T>
+    struct AsyncChannel
+    {
+        SpscRing<T> ring;
+        std::vector<T> spill;
+        size_t spill_head = 0;
+
+        explicit AsyncChannel(size_t capacity) : ring(capacity) {}
+    };
+
     std::string log_directory;
     std::mutex log_mutex;
     bool mpi_enabled;
     int mpi_rank;
     int mpi_size;
+    int sim_index;
+    LogFormat format;
+    bool log_orders;
 
     // File streams
     std::ofstream trade_log;
     std::ofstream price_log;
     std::ofstream trader_stats_log;
     std::ofstream order_book_log;
+    std::ofstream order_log;
 
     // Buffered data for batch writing
     std::vector<std::string> trade_buffer;
     std::vector<std::string> price_buffer;
 
+    // Binary writers, used instead of trade_log/price_log in BINARY format
+    BinaryLogWriter trade_writer;
+    BinaryLogWriter price_writer;
+    BinaryLogWriter order_writer;
+
+    // Async mode: the simulation thread only pushes records, writer_thread formats and writes
+    std::unique_ptr<AsyncChannel<ExecutedTrade>> trade_channel;
+    std::unique_ptr<AsyncChannel<PriceRecord>> price_channel;
+    std::unique_ptr<AsyncChannel<DepthRecord>> depth_channel;
+    std::unique_ptr<AsyncChannel<TraderStatRecord>> stats_channel;
+    std::unique_ptr<AsyncChannel<OrderRecord>> order_channel;
+    std::thread writer_thread;
+    std::atomic<bool> stop_requested;
+    std::atomic<long long> dropped_records;
+    LogBackpressure backpressure;
+
 public:
     DataLogger(const std::string &directory = "logs");
     ~DataLogger();
 
+    // Takes effect at the next initialize()
+    void setFormat(LogFormat log_format) { format = log_format; }
+    LogFormat getFormat() const { return format; }
+
+    // Also record every submitted order (orders.csv / orders.tslog), the
+    // input --replay feeds back into a book. Takes effect at the next initialize().
+    void setOrderLogging(bool enabled) { log_orders = enabled; }
+    bool isOrderLogging() const { return log_orders; }
+
+    // Move formatting and I/O to a background thread fed by SPSC rings.
+    // All log* calls must then come from a single thread.
+    void startAsync(LogBackpressure policy = LogBackpressure::BLOCK, size_t ring_capacity = 16384);
+
+    // Drain every queued record, then join the writer thread
+    void stopAsync();
+
+    bool isAsync() const { return writer_thread.joinable(); }
+    long long getDroppedRecords() const { return dropped_records.load(); }
+
     // Initialize logger with MPI support
     void initialize(bool use_mpi = false, int rank = 0, int size = 1, int sim_index = -1);
 
+    // Initialize with the same format and MPI/sim file naming as other, in this logger's directory
+    void initializeLike(const DataLogger &other);
+
+    const std::string &getDirectory() const { return log_directory; }
+
     // Log trade data (CSV format)
     void logTrade(const ExecutedTrade &trade);
 
+    // Log a step's trades under one lock (or one run of ring pushes)
+    void logTrades(const ExecutedTrade *trades, size_t count);
+
+    // Log orders submitted before step's match, in submission order (no-op unless order logging is on)
+    void logOrders(std::uint64_t step, const Order *orders, size_t count);
+
     // Log price history (CSV format)
     void logPrice(double timestamp, double price, double volume, int buy_orders, int sell_orders);
 
     // Log trader statistics (CSV format)
     void logTraderStats(double timestamp, const std::vector<std::unique_ptr<Trader>> &traders, double market_price);
+    void logTraderStats(double timestamp, const TraderPopulation &population, double market_price);
 
     // Log order book depth (CSV format)
     void logOrderBook(double timestamp,
@@ -54,9 +174,25 @@ public:
     void exportToJSON(const std::string &filename);
 
 private:
+    // Format and write one record; log_mutex must be held
+    void writeTrade(const ExecutedTrade &trade);
+    void writePrice(const PriceRecord &record);
+    void writeDepth(const DepthRecord &record);
+    void writeTraderStat(const TraderStatRecord &record);
+    void writeOrder(const OrderRecord &record);
+
+    template <typename T>
+    void pushRecord(AsyncChannel<T> &channel, const T &record);
+    template <typename T>
+    bool drainSpill(AsyncChannel<T> &channel);
+
+    // Wait until the writer thread has written everything queued so far
+    void waitForDrain();
+    void writerLoop();
+
     // Helper to create directory
     void createDirectory(const std::string &dir);
 
-    // Parallel file write
+    // Append data to filename in order
     void parallelWrite(const std::string &filename, const std::vector<std::string> &data);
 };
@@ -1,7 +1,12 @@
 #pragma once
 #include <vector>
-#include <random>
 #include <deque>
+#include <cstdint>
+#include "counter_rng.hpp"
+#include "price_history.hpp"
+
+// Prices Market keeps for statistics and the TUI chart
+constexpr size_t MARKET_HISTORY_CAPACITY = 1000;
 
 class Market
 {
@@ -9,15 +14,25 @@ private:
     double current_price;
     double previous_price;
     double base_price;
-    std::vector<double> price_history;
-    std::mt19937 rng;
-    std::uniform_real_distribution<> noise_dist;
+    PriceHistory price_history; // Shared read-only with traders
+    CounterRng rng;
+    std::uint64_t update_count; // Counter for the noise draws
 
     int buy_pressure;
     int sell_pressure;
 
+    // Welford moments of the prices currently in price_history. A push into
+    // a full history swaps the evicted price for the new one; the moments
+    // are recomputed exactly once per capacity pushes so rounding cannot drift.
+    double window_mean;
+    double window_m2;
+    size_t pushes_since_resync;
+
+    void pushPrice(double price);
+
 public:
-    Market(double initial_price);
+    // Noise is drawn from (seed, MARKET_RNG_STREAM, update #), so a seed fixes the path
+    Market(double initial_price, unsigned int seed);
 
     // Update price based on market dynamics and trading activity
     void updatePrice(int buy_orders, int sell_orders);
@@ -33,11 +48,22 @@ public:
         return ((current_price - previous_price) / previous_price) * 100.0;
     }
 
-    // Get price history
-    const std::vector<double> &getPriceHistory() const { return price_history; }
+    // Population standard deviation of the prices in getPriceHistory(), O(1)
+    double getPriceVolatility() const;
+
+    // Get price history, oldest first
+    PriceSpan getPriceHistory() const { return price_history.view(); }
+    const PriceHistory &getHistory() const { return price_history; }
+
+    // Get recent price history (last N points); a view valid until the next update
+    PriceSpan getRecentHistory(int points) const { return price_history.recent(points > 0 ? points : 0); }
+
+    // Prices, history, pressures and noise position for checkpoints
+    void saveState(CheckpointWriter &out) const;
+    void loadState(CheckpointReader &in);
 
-    // Get recent price history (last N points)
-    std::vector<double> getRecentHistory(int points) const;
+    // Continue the noise path on another seed's stream from the same update count
+    void reseed(unsigned int seed) { rng = CounterRng(seed, MARKET_RNG_STREAM); }
 
     // Reset market pressures
     void resetPressures()
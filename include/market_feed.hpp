@@ -0,0 +1,242 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Live market data in POSIX shared memory, one segment per book.
+//
+// The simulation writes one MarketFeedTick per step into a ring of slots,
+// each guarded by a seqlock: the slot's sequence is odd while it is being
+// written and 2 * (tick number + 1) once complete. The writer never waits,
+// so a reader that falls a whole ring behind loses ticks rather than
+// slowing the simulation; next() reports how many. Readers only map the
+// segment read-only and copy slots out.
+//
+// This header is all an external process needs (no simulation headers, no
+// libraries beyond librt on old glibc):
+//
+//   MarketFeedSubscriber feed;
+//   if (feed.open("tradingsim"))
+//       for (MarketFeedTick tick; feed.isLive();)
+//           if (feed.next(tick))
+//               use(tick.best_bid, tick.bids[0].quantity, ...);
+
+constexpr std::uint32_t MARKET_FEED_MAGIC = 0x54534d46; // "TSMF"
+constexpr std::uint32_t MARKET_FEED_VERSION = 1;
+constexpr int MARKET_FEED_DEPTH = 10;  // Book levels per side
+constexpr int MARKET_FEED_TRADES = 32; // Trades per tick; the rest are only counted
+
+struct MarketFeedLevel
+{
+    double price;
+    std::int64_t quantity;
+};
+
+struct MarketFeedTrade
+{
+    double price;
+    double timestamp;
+    std::int32_t quantity;
+    std::int32_t buyer_id;
+    std::int32_t seller_id;
+    std::int32_t trade_id;
+};
+
+// The book after one step. Levels and trades past their counts are stale.
+struct MarketFeedTick
+{
+    std::uint64_t step;
+    double simulation_time;
+    double price; // Market price the next step trades on
+    double best_bid;
+    double best_ask;
+    double spread;
+    double step_volume; // Notional traded this step, all trades
+    std::int32_t symbol;
+    std::int32_t bid_levels;
+    std::int32_t ask_levels;
+    std::int32_t trade_count;      // Trades in trades[]
+    std::int64_t step_trade_count; // Trades this step, may exceed MARKET_FEED_TRADES
+    MarketFeedLevel bids[MARKET_FEED_DEPTH]; // Best first
+    MarketFeedLevel asks[MARKET_FEED_DEPTH];
+    MarketFeedTrade trades[MARKET_FEED_TRADES]; // Oldest first
+};
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "The feed needs lock-free 64-bit atomics in shared memory.");
+
+struct alignas(64) MarketFeedSlot
+{
+    std::atomic<std::uint64_t> sequence;
+    MarketFeedTick tick;
+};
+
+struct alignas(64) MarketFeedHeader
+{
+    std::atomic<std::uint32_t> magic; // Written last by the publisher, once the rest is valid
+    std::uint32_t version;
+    std::uint32_t slot_count;
+    std::uint32_t slot_size;
+    std::atomic<std::uint64_t> published; // Ticks written so far
+    std::atomic<std::uint32_t> live;      // Cleared when the publisher closes
+};
+
+// Bytes of a segment with slot_count slots
+inline size_t marketFeedSize(std::uint32_t slot_count)
+{
+    return sizeof(MarketFeedHeader) + static_cast<size_t>(slot_count) * sizeof(MarketFeedSlot);
+}
+
+// shm_open names start with one '/'; "tradingsim" and "/tradingsim" are the same feed
+inline std::string marketFeedPath(const std::string &name)
+{
+    return (!name.empty() && name[0] == '/') ? name : "/" + name;
+}
+
+class MarketFeedSubscriber
+{
+private:
+    const char *mapping = nullptr;
+    size_t mapped_size = 0;
+    std::uint64_t cursor = 0; // Next tick next() returns
+    std::uint64_t dropped = 0;
+
+    const MarketFeedHeader &header() const { return *reinterpret_cast<const MarketFeedHeader *>(mapping); }
+
+    const MarketFeedSlot &slot(std::uint64_t tick) const
+    {
+        return reinterpret_cast<const MarketFeedSlot *>(mapping + sizeof(MarketFeedHeader))[tick % header().slot_count];
+    }
+
+    // Copy tick number `tick` out; false if it is not written yet, being
+    // rewritten, or already overwritten
+    bool read(std::uint64_t tick, MarketFeedTick &out) const
+    {
+        const MarketFeedSlot &s = slot(tick);
+        std::uint64_t expected = 2 * (tick + 1);
+        if (s.sequence.load(std::memory_order_acquire) != expected)
+            return false;
+        std::memcpy(&out, &s.tick, sizeof(MarketFeedTick));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return s.sequence.load(std::memory_order_relaxed) == expected;
+    }
+
+public:
+    MarketFeedSubscriber() = default;
+    ~MarketFeedSubscriber() { close(); }
+
+    MarketFeedSubscriber(const MarketFeedSubscriber &) = delete;
+    MarketFeedSubscriber &operator=(const MarketFeedSubscriber &) = delete;
+
+    // Map a running publisher's feed. False if there is none (yet), or it
+    // was written by an incompatible build. next() starts at the newest tick.
+    bool open(const std::string &name)
+    {
+        close();
+        int fd = shm_open(marketFeedPath(name).c_str(), O_RDONLY, 0);
+        if (fd < 0)
+            return false;
+
+        struct stat info;
+        void *view = MAP_FAILED;
+        if (fstat(fd, &info) == 0 && static_cast<size_t>(info.st_size) >= sizeof(MarketFeedHeader))
+            view = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (view == MAP_FAILED)
+            return false;
+
+        mapping = static_cast<const char *>(view);
+        mapped_size = info.st_size;
+        const MarketFeedHeader &h = header();
+        if (h.magic.load(std::memory_order_acquire) != MARKET_FEED_MAGIC ||
+            h.version != MARKET_FEED_VERSION || h.slot_size != sizeof(MarketFeedSlot) || h.slot_count == 0 ||
+            mapped_size < marketFeedSize(h.slot_count))
+        {
+            close();
+            return false;
+        }
+
+        std::uint64_t written = h.published.load(std::memory_order_acquire);
+        cursor = written > 0 ? written - 1 : 0;
+        dropped = 0;
+        return true;
+    }
+
+    void close()
+    {
+        if (mapping != nullptr)
+            munmap(const_cast<char *>(mapping), mapped_size);
+        mapping = nullptr;
+        mapped_size = 0;
+    }
+
+    bool isOpen() const { return mapping != nullptr; }
+
+    // The publisher has not closed the feed (a crashed one stays live)
+    bool isLive() const { return isOpen() && header().live.load(std::memory_order_acquire) != 0; }
+
+    // Ticks published so far
+    std::uint64_t published() const { return isOpen() ? header().published.load(std::memory_order_acquire) : 0; }
+
+    // The next unseen tick, in order. False if there is none yet. Ticks the
+    // ring overwrote before they were read are skipped and counted.
+    bool next(MarketFeedTick &out)
+    {
+        if (!isOpen())
+            return false;
+        while (true)
+        {
+            std::uint64_t newest = published();
+            if (cursor >= newest)
+                return false;
+
+            // Lapped: the ring holds the newest `slots` ticks and the oldest
+            // of them is rewritten next, so resume just after it
+            std::uint64_t slots = header().slot_count;
+            if (newest - cursor >= slots)
+            {
+                std::uint64_t oldest = newest - slots + 1;
+                dropped += oldest - cursor;
+                cursor = oldest;
+            }
+            if (read(cursor, out))
+            {
+                cursor++;
+                return true;
+            }
+            if (cursor >= published())
+                return false;
+            // Overwritten while copying; catch up and retry
+            dropped++;
+            cursor++;
+        }
+    }
+
+    // The newest complete tick, skipping any unread ones. False if none yet.
+    bool latest(MarketFeedTick &out)
+    {
+        if (!isOpen())
+            return false;
+        while (true)
+        {
+            std::uint64_t newest = published();
+            if (newest == 0)
+                return false;
+            if (read(newest - 1, out))
+            {
+                if (newest > cursor)
+                    dropped += newest - 1 - cursor;
+                cursor = newest;
+                return true;
+            }
+        }
+    }
+
+    // Ticks skipped by next() and latest() since open()
+    std::uint64_t getDropped() const { return dropped; }
+};
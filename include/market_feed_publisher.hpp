@@ -0,0 +1,40 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include "market_feed.hpp"
+#include "order_book.hpp"
+
+// Writer side of a market_feed.hpp segment. Creates the named shared-memory
+// object on open(), replacing any earlier one, and unlinks it on close();
+// readers that still have it mapped keep reading until they close theirs.
+// publish() is a few kilobytes of copying and never blocks.
+class MarketFeedPublisher
+{
+private:
+    std::string path;
+    char *mapping = nullptr;
+    size_t mapped_size = 0;
+    std::uint64_t ticks = 0;
+
+    MarketFeedHeader &header() { return *reinterpret_cast<MarketFeedHeader *>(mapping); }
+    MarketFeedSlot &slot(std::uint64_t tick);
+
+public:
+    static constexpr std::uint32_t DEFAULT_SLOTS = 1024;
+
+    MarketFeedPublisher() = default;
+    ~MarketFeedPublisher() { close(); }
+
+    MarketFeedPublisher(const MarketFeedPublisher &) = delete;
+    MarketFeedPublisher &operator=(const MarketFeedPublisher &) = delete;
+
+    // False, with the reason on std::cerr, if the segment cannot be created
+    bool open(const std::string &name, std::uint32_t slot_count = DEFAULT_SLOTS);
+    void close();
+    bool isOpen() const { return mapping != nullptr; }
+
+    // One tick: top of book and depth from the book, this step's trades, and
+    // the market price the next step trades on
+    void publish(std::uint64_t step, double simulation_time, int symbol, double price, const OrderBook &book,
+                 const ExecutedTrade *trades, size_t trade_count);
+};
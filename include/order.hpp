@@ -15,25 +15,45 @@ enum class OrderStatus
     CANCELLED
 };
 
+// How long an order may rest. IOC and FOK never outlive the matchOrders()
+// call that follows their entry: IOC cancels whatever did not fill, FOK is
+// killed unless the opposite side can fill all of it.
+enum class TimeInForce
+{
+    GTC, // Good till cancelled
+    GTT, // Good till expire_time (simulation time)
+    IOC, // Immediate or cancel
+    FOK  // Fill or kill
+};
+
 struct Order
 {
     int order_id;
     int trader_id;
     OrderType type;
+    TimeInForce time_in_force;
     double price;
     int quantity;
     int filled_quantity;
     OrderStatus status;
     double timestamp;
+    double expire_time; // GTT only
 
-    Order() : order_id(0), trader_id(0), type(OrderType::BUY),
+    Order() : order_id(0), trader_id(0), type(OrderType::BUY), time_in_force(TimeInForce::GTC),
               price(0.0), quantity(0), filled_quantity(0),
-              status(OrderStatus::PENDING), timestamp(0.0) {}
+              status(OrderStatus::PENDING), timestamp(0.0), expire_time(0.0) {}
 
     Order(int id, int t_id, OrderType t, double p, int q, double ts)
-        : order_id(id), trader_id(t_id), type(t), price(p),
+        : order_id(id), trader_id(t_id), type(t), time_in_force(TimeInForce::GTC), price(p),
           quantity(q), filled_quantity(0), status(OrderStatus::PENDING),
-          timestamp(ts) {}
+          timestamp(ts), expire_time(0.0) {}
+
+    // Good till timestamp + lifetime, or good till cancelled if lifetime <= 0
+    void setLifetime(double lifetime)
+    {
+        time_in_force = lifetime > 0.0 ? TimeInForce::GTT : TimeInForce::GTC;
+        expire_time = lifetime > 0.0 ? timestamp + lifetime : 0.0;
+    }
 
     int getRemainingQuantity() const
     {
@@ -1,46 +1,256 @@
 #pragma once
 #include "order.hpp"
+#include "order_pool.hpp"
+#include "checkpoint.hpp"
+#include "timer_wheel.hpp"
 #include <vector>
 #include <map>
+#include <deque>
 #include <mutex>
+#include <memory>
+#include <functional>
 #include <algorithm>
+#include <cstdint>
 
-class OrderBook
+enum class OrderBookType
 {
-private:
-    // Price-level order books (price -> list of orders)
-    std::map<double, std::vector<Order>, std::greater<double>> buy_orders; // Descending (highest first)
-    std::map<double, std::vector<Order>> sell_orders;                      // Ascending (lowest first)
+    MAP, // std::map keyed on raw double prices
+    TICK // Integer price ticks over a contiguous ring of levels
+};
+
+enum class MatchingMode
+{
+    CONTINUOUS,   // Sequential price-time priority, trades at the resting price
+    BATCH_AUCTION // One uniform clearing price per matchOrders() call
+};
+
+// Outcome of crossing aggregated bid/ask level volumes
+struct AuctionResult
+{
+    int volume = 0;           // Executable quantity at the clearing price
+    double marginal_bid = 0;  // Lowest bid level that participates
+    double marginal_ask = 0;  // Highest ask level that participates
+};
 
-    std::vector<ExecutedTrade> executed_trades;
+// Work counters for profiling, cumulative over the book's lifetime
+struct BookCounters
+{
+    std::uint64_t levels_touched = 0; // Levels visited by insert and matching
+    std::uint64_t allocations = 0;    // Level nodes, level ring regrowths and pool slabs
+    std::uint64_t expired = 0;        // GTT orders removed at their expire_time
+    std::uint64_t killed = 0;         // IOC/FOK orders cancelled unfilled or part filled
+};
+
+// Running totals over every trade the book has executed
+struct TradeTotals
+{
+    std::uint64_t count = 0;
+    double volume = 0.0;    // Sum of price * quantity
+    double price_sum = 0.0; // Sum of trade prices, for the average trade price
+};
+
+// Common interface shared by the order book implementations.
+// Resting orders live in an OrderPool and are queued FIFO on PriceLevels;
+// matching, cancel and modify are implemented here on top of a small set of
+// level hooks that each book provides.
+class OrderBook
+{
+protected:
+    OrderPool pool;
+    std::deque<ExecutedTrade> recent_trades; // Newest trade_retention trades, oldest first
+    size_t trade_retention;
+    TradeTotals trade_totals;
     std::mutex book_mutex;
 
     int next_order_id;
     int next_trade_id;
+    std::uint64_t next_sequence; // Arrival order of queued orders, apart from ids (modify keeps the id)
+    MatchingMode matching_mode;
+
+    // Side totals, maintained alongside the level aggregates
+    int buy_order_count;
+    int sell_order_count;
+    int buy_quantity;
+    int sell_quantity;
+
+    BookCounters counters; // allocations excludes pool slabs, added by getCounters()
+
+    // Time in force: GTT orders are keyed on their expiry tick, IOC/FOK ids
+    // wait for the next match. Orders the book removes itself are kept for
+    // takeExpiredOrders().
+    TimerWheel expiry_wheel;
+    std::vector<int> immediate_orders;
+    std::vector<Order> expired_orders;
+    std::vector<int> fired_timers; // Scratch for expireOrders()
+
+    // Levels already seen during one addOrders call (power of two slots)
+    static constexpr int BULK_LEVEL_CACHE = 64;
+    struct BulkLevelSlot
+    {
+        OrderType side;
+        double price;
+        PriceLevel *level;
+    };
+
+    // Called with price-level visits, best first; return false to stop
+    using LevelVisitor = std::function<bool(double price, const PriceLevel &level)>;
+
+    // Level hooks implemented by each book
+    virtual double snapPrice(OrderType /*side*/, double price) const { return price; }
+    virtual PriceLevel &getOrCreateLevel(OrderType side, double price) = 0; // Always followed by a push
+    virtual void removeLevel(OrderType side, double price) = 0;             // Level just became empty
+    virtual PriceLevel *bestLevel(OrderType side) = 0;                      // nullptr if side is empty
+    virtual double bestPrice(OrderType side) const = 0;                     // 0.0 if side is empty
+    virtual void visitLevels(OrderType side, const LevelVisitor &visit) const = 0;
+
+    // Queue an order (already carrying its id) at the tail of its level,
+    // as the newest arrival
+    void insertOrder(const Order &order);
+
+    // Register a newly queued order for expiry or end-of-match cancellation
+    void trackTimeInForce(const Order &order);
+
+    // Before matching: kill FOK orders the opposite side cannot fill. After
+    // matching: cancel what is left of every IOC/FOK order.
+    void killUnfillable();
+    void cancelImmediateRemainders();
+
+    // Take a resting order out unfilled and keep it for takeExpiredOrders()
+    void expireOrder(int handle);
+
+    // Unlink a resting order, drop its level if emptied and free the slot.
+    // Returns true if the level was removed.
+    bool removeOrder(int handle);
+
+    // Adjust side totals for an order entering (+) or leaving (-) the book
+    void addSideTotals(const Order &order, int sign);
+
+    // Take quantity off a resting order's level and side totals after a fill
+    // or an in-place size reduction
+    void reduceResting(int handle, int quantity);
+
+    // Fill two orders against each other and record the trade
+    void fillOrders(Order &buy_order, Order &sell_order, int quantity, double price,
+                    double timestamp, std::vector<ExecutedTrade> &new_trades);
+
+    // Walk crossed level heads FIFO. With uniform_price every fill uses
+    // clearing_price, otherwise the resting order's price.
+    void crossBook(std::vector<ExecutedTrade> &new_trades, bool uniform_price, double clearing_price);
+
+    void matchContinuous(std::vector<ExecutedTrade> &new_trades);
+    void matchBatchAuction(std::vector<ExecutedTrade> &new_trades);
+
+    // Levels of side from its best price up to limit_price (inclusive), with quantities
+    std::vector<std::pair<double, int>> crossingLevels(OrderType side, double limit_price) const;
+    std::vector<std::pair<double, int>> getDepth(OrderType side, int levels) const;
+    static int levelQuantity(const PriceLevel &level) { return level.quantity; }
+
+    // One side's levels best first: prices, orders per level, then every
+    // order FIFO and their arrival sequences
+    void saveSide(CheckpointWriter &out, OrderType side) const;
+
+    // Single pass over cumulative depth. Levels are (price, quantity) sorted
+    // best first, i.e. bids descending and asks ascending.
+    static AuctionResult crossAggregates(const std::vector<std::pair<double, int>> &bid_levels,
+                                         const std::vector<std::pair<double, int>> &ask_levels);
 
 public:
     OrderBook();
+    virtual ~OrderBook() = default;
+
+    // Add order to book, returns the assigned order id
+    int addOrder(const Order &order);
+
+    // Add count orders under one lock. Ids are assigned as one block in input
+    // order (the first id is returned), so time priority matches calling
+    // addOrder on each in turn. Orders are copied straight into pool slots
+    // and grouped by side and price, so each level is looked up once per
+    // batch rather than once per order.
+    int addOrders(const Order *orders, std::size_t count);
+
+    // Remove a resting order. Returns false if it is not in the book.
+    bool cancelOrder(int order_id);
+
+    // Change a resting order's total quantity and/or price. Reducing the
+    // quantity at the same price keeps time priority; anything else re-queues
+    // the order at the back of its (new) level. A quantity at or below what is
+    // already filled cancels the remainder.
+    bool modifyOrder(int order_id, int new_quantity, double new_price);
 
-    // Add order to book
-    int addOrder(Order order);
+    // Resting order by id, or nullptr if it is no longer in the book
+    const Order *findOrder(int order_id) const;
 
-    // Match orders and execute trades (parallelized with OpenMP)
+    // Match orders and execute trades using the current matching mode.
+    // IOC/FOK orders entered since the last call are done afterwards. FOK is
+    // checked against the crossing depth before matching; if earlier orders
+    // in the same match take that liquidity first it is part filled and the
+    // rest cancelled, as with IOC.
     std::vector<ExecutedTrade> matchOrders();
 
-    // Get order book statistics
-    int getBuyOrderCount() const;
-    int getSellOrderCount() const;
-    double getBestBid() const;
-    double getBestAsk() const;
+    // Simulation time per expiry tick: GTT orders leave at most this late
+    static constexpr double EXPIRY_RESOLUTION = 0.01;
+
+    // Remove GTT orders whose expire_time is at or before now. Costs
+    // O(expired + ticks crossed), whatever the book size. Returns the count.
+    int expireOrders(double now);
+
+    // Swap out the orders the book removed by itself since the last call
+    // (expired GTT orders and IOC/FOK remainders), in id order per cause,
+    // so their owners can release what they reserved. cancelOrder() and
+    // modifyOrder() do not report here; their caller already knows.
+    void takeExpiredOrders(std::vector<Order> &expired);
+
+    void setMatchingMode(MatchingMode mode) { matching_mode = mode; }
+    MatchingMode getMatchingMode() const { return matching_mode; }
+
+    // Get order book statistics (all O(1))
+    int getBuyOrderCount() const { return buy_order_count; }
+    int getSellOrderCount() const { return sell_order_count; }
+    int getBuyQuantity() const { return buy_quantity; }
+    int getSellQuantity() const { return sell_quantity; }
+    double getBestBid() const { return bestPrice(OrderType::BUY); }
+    double getBestAsk() const { return bestPrice(OrderType::SELL); }
     double getSpread() const;
+    BookCounters getCounters() const;
 
-    // Get all executed trades
-    const std::vector<ExecutedTrade> &getExecutedTrades() const { return executed_trades; }
+    // Totals over every executed trade, whatever the retention
+    const TradeTotals &getTradeTotals() const { return trade_totals; }
 
-    // Clear old filled orders
-    void cleanupFilledOrders();
+    // Keep the newest count trades in memory (default 0: none, the trade
+    // logs hold the full record). Shrinking drops the oldest at once.
+    void setTradeRetention(size_t count);
+    size_t getTradeRetention() const { return trade_retention; }
+    const std::deque<ExecutedTrade> &getRecentTrades() const { return recent_trades; }
 
-    // Get order book depth (for display)
-    std::vector<std::pair<double, int>> getBuyDepth(int levels = 5) const;
-    std::vector<std::pair<double, int>> getSellDepth(int levels = 5) const;
+    // Resting orders with their queue positions, id counters, matching mode,
+    // work counters, trade totals, the retained trades and expiry state. loadState() expects an empty book
+    // of the type and tick size that saved it (the simulation records both).
+    void saveState(CheckpointWriter &out) const;
+    void loadState(CheckpointReader &in);
+
+    // Get order book depth (for display), O(levels) from the level aggregates
+    std::vector<std::pair<double, int>> getBuyDepth(int levels = 5) const { return getDepth(OrderType::BUY, levels); }
+    std::vector<std::pair<double, int>> getSellDepth(int levels = 5) const { return getDepth(OrderType::SELL, levels); }
 };
+
+// Original book: one std::map node per distinct double price
+class MapOrderBook : public OrderBook
+{
+private:
+    // Price levels (price -> FIFO queue of pooled orders)
+    std::map<double, PriceLevel, std::greater<double>> buy_levels; // Descending (highest first)
+    std::map<double, PriceLevel> sell_levels;                      // Ascending (lowest first)
+
+protected:
+    PriceLevel &getOrCreateLevel(OrderType side, double price) override;
+    void removeLevel(OrderType side, double price) override;
+    PriceLevel *bestLevel(OrderType side) override;
+    double bestPrice(OrderType side) const override;
+    void visitLevels(OrderType side, const LevelVisitor &visit) const override;
+
+public:
+    MapOrderBook() = default;
+};
+
+// Create a book of the requested type (tick_size only applies to TICK)
+std::unique_ptr<OrderBook> createOrderBook(OrderBookType type, double tick_size = 0.01);
@@ -0,0 +1,79 @@
+#pragma once
+#include "order.hpp"
+#include <cstdint>
+#include <vector>
+#include <deque>
+#include <memory>
+
+// FIFO queue of resting orders at one price, linked through OrderNode.
+// The aggregates are kept up to date by the queue operations and by fills,
+// so depth queries never walk the queue.
+struct PriceLevel
+{
+    int head = -1;
+    int tail = -1;
+    int order_count = 0;
+    int quantity = 0; // Remaining (unfilled) quantity of the queued orders
+};
+
+// Pool slot holding one resting order and its intrusive queue links
+struct OrderNode
+{
+    Order order;
+    std::uint64_t sequence = 0;  // Book arrival order; a re-queued order takes a new one
+    PriceLevel *level = nullptr; // Level the order is queued on
+    int prev = -1;
+    int next = -1; // Doubles as the free-list link while the slot is unused
+};
+
+// Slab allocator for resting orders.
+// Slots live in fixed-size slabs that are never moved, so a handle (slot
+// index) and the node address both stay valid until the order is released.
+// Freed slots are recycled through a free list, and an order_id -> handle
+// index gives O(1) lookup for cancel/modify.
+class OrderPool
+{
+private:
+    static constexpr int SLAB_SHIFT = 12;
+    static constexpr int SLAB_SIZE = 1 << SLAB_SHIFT;
+    static constexpr int SLAB_MASK = SLAB_SIZE - 1;
+
+    std::vector<std::unique_ptr<OrderNode[]>> slabs;
+    int capacity;
+    int free_head;
+    int live_count;
+
+    // Order ids are handed out sequentially, so the index is a window of
+    // handles starting at id_base. Dead entries at the front are trimmed, and
+    // an id older than the window grows it at the front.
+    std::deque<int> id_to_handle;
+    int id_base;
+
+    void addSlab();
+
+public:
+    OrderPool();
+
+    // Store a copy of order and register its id
+    int allocate(const Order &order);
+
+    // Make sure count more orders fit without growing mid-insert
+    void reserve(int count);
+
+    // Return a slot to the free list and forget its id
+    void release(int handle);
+
+    // Handle of a resting order, or -1 if it is not in the pool
+    int find(int order_id) const;
+
+    OrderNode &operator[](int handle) { return slabs[handle >> SLAB_SHIFT][handle & SLAB_MASK]; }
+    const OrderNode &operator[](int handle) const { return slabs[handle >> SLAB_SHIFT][handle & SLAB_MASK]; }
+
+    // Intrusive queue operations, which also maintain the level aggregates
+    // from the order's remaining quantity
+    void pushBack(PriceLevel &level, int handle);
+    void unlink(int handle);
+
+    int getLiveCount() const { return live_count; }
+    int getSlabCount() const { return static_cast<int>(slabs.size()); }
+};
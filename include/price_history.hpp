@@ -0,0 +1,85 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+#include <algorithm>
+#include "checkpoint.hpp"
+
+// Read-only view of contiguous prices, oldest first. Converts implicitly from
+// a vector so the indicator kernels accept either.
+struct PriceSpan
+{
+    const double *data = nullptr;
+    size_t count = 0;
+
+    PriceSpan() = default;
+    PriceSpan(const double *first, size_t n) : data(first), count(n) {}
+    PriceSpan(const std::vector<double> &prices) : data(prices.data()), count(prices.size()) {}
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    const double *begin() const { return data; }
+    const double *end() const { return data + count; }
+    double operator[](size_t i) const { return data[i]; }
+    double back() const { return data[count - 1]; }
+};
+
+// Fixed-capacity price history with O(1) push and no erase-from-front.
+// Every value is stored twice, at slot and slot + capacity, so the newest n
+// values always sit in one contiguous run and recent(n) is a plain view.
+class PriceHistory
+{
+private:
+    std::vector<double> buffer; // 2 * capacity
+    size_t capacity;
+    size_t next; // Slot the next push writes, in [0, capacity)
+    size_t count;
+
+public:
+    explicit PriceHistory(size_t max_size)
+        : buffer(2 * std::max<size_t>(max_size, 1)), capacity(std::max<size_t>(max_size, 1)), next(0), count(0)
+    {
+    }
+
+    void push(double price)
+    {
+        buffer[next] = price;
+        buffer[next + capacity] = price;
+        next = (next + 1 == capacity) ? 0 : next + 1;
+        count = std::min(count + 1, capacity);
+    }
+
+    // Newest min(n, size()) values, oldest first. Valid until the next push.
+    PriceSpan recent(size_t n) const
+    {
+        n = std::min(n, count);
+        return PriceSpan(buffer.data() + next + capacity - n, n);
+    }
+
+    PriceSpan view() const { return recent(count); }
+
+    size_t size() const { return count; }
+    size_t getCapacity() const { return capacity; }
+    bool empty() const { return count == 0; }
+    double back() const { return recent(1).back(); }
+
+    // Capacity is fixed at construction and must match the saved one
+    void saveState(CheckpointWriter &out) const
+    {
+        out.put(static_cast<std::uint64_t>(next));
+        out.put(static_cast<std::uint64_t>(count));
+        out.putVector(buffer);
+    }
+
+    void loadState(CheckpointReader &in)
+    {
+        next = static_cast<size_t>(in.get<std::uint64_t>());
+        count = static_cast<size_t>(in.get<std::uint64_t>());
+        in.getFixedVector(buffer);
+        if (next >= capacity || count > capacity)
+        {
+            in.fail();
+            next = 0;
+            count = 0;
+        }
+    }
+};
@@ -0,0 +1,153 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+
+// Phases of TradingSimulation::step(), in execution order
+enum class StepPhase
+{
+    INDICATORS,   // Shared indicator engine update
+    GENERATE,     // Trader order generation (parallel)
+    INSERT,       // addOrder for every generated order
+    MATCH,        // matchOrders (multi-instrument: the whole parallel shard stage)
+    SETTLE,       // Bucketed trade settlement and bulk trade logging (multi-instrument: the cash reduce)
+    MARKET,       // market.updatePrice
+    FEED,         // Shared-memory market feed publish, when one is open
+    PERIODIC_LOG, // Price, trader stats and depth logging on whole seconds
+    COUNT
+};
+
+constexpr int STEP_PHASE_COUNT = static_cast<int>(StepPhase::COUNT);
+
+const char *stepPhaseName(StepPhase phase);
+
+// Latency percentiles of one phase, in microseconds
+struct PhaseSummary
+{
+    std::uint64_t samples = 0;
+    double total_us = 0.0;
+    double p50_us = 0.0;
+    double p99_us = 0.0;
+    double max_us = 0.0;
+};
+
+// Work done by the steps so far
+struct StepCounters
+{
+    std::uint64_t steps = 0;
+    std::uint64_t orders = 0;         // Orders admitted and inserted
+    std::uint64_t rejected = 0;       // Orders refused by the pre-trade funds check
+    std::uint64_t expired = 0;        // GTT orders expired plus IOC/FOK orders killed
+    std::uint64_t trades = 0;         // Trades executed
+    std::uint64_t decisions = 0;      // Trader decisions evaluated
+    std::uint64_t unsettled = 0;      // Fill legs an account refused; reservations keep this 0
+    std::uint64_t levels_touched = 0; // Price levels visited by insert/match
+    std::uint64_t allocations = 0;    // Book level nodes, ring regrowths and pool slabs
+};
+
+// Plain data so it can travel inside SimulationStats over MPI
+struct StepProfileSummary
+{
+    bool enabled = false; // Phase timings were collected
+    PhaseSummary phases[STEP_PHASE_COUNT];
+    StepCounters counters;
+};
+
+// Log-linear histogram of nanosecond durations: each power of two is split
+// into 8 sub-buckets, so any value is within 12.5% of its bucket bound.
+// Fixed size, recording is a couple of shifts and an increment.
+class LatencyHistogram
+{
+private:
+    static constexpr int SUB_BITS = 3;
+    static constexpr int SUB_COUNT = 1 << SUB_BITS;
+    static constexpr int BUCKET_COUNT = (64 - SUB_BITS + 1) * SUB_COUNT;
+
+    std::uint64_t buckets[BUCKET_COUNT] = {};
+    std::uint64_t count = 0;
+    std::uint64_t total_ns = 0;
+    std::uint64_t max_ns = 0;
+
+    static int bucketFor(std::uint64_t ns);
+    static std::uint64_t bucketUpperBound(int bucket);
+
+public:
+    void record(std::uint64_t ns);
+
+    // Upper bound of the bucket holding quantile q (0..1), never above max
+    std::uint64_t percentile(double q) const;
+
+    std::uint64_t getCount() const { return count; }
+    std::uint64_t getTotal() const { return total_ns; }
+    std::uint64_t getMax() const { return max_ns; }
+};
+
+// Per-phase histograms for one simulation. Timing is off until enabled at
+// runtime, and compiled out entirely unless TRADINGSIM_PROFILING is defined.
+class StepProfiler
+{
+private:
+    bool enabled = false;
+    LatencyHistogram phases[STEP_PHASE_COUNT];
+    StepCounters counters;
+
+public:
+    void setEnabled(bool on) { enabled = on; }
+    bool isEnabled() const { return enabled; }
+
+    // Drop every timing and counter, keeping the enabled setting
+    void reset();
+
+    void record(StepPhase phase, std::uint64_t ns) { phases[static_cast<int>(phase)].record(ns); }
+
+    void countStep(std::uint64_t orders, std::uint64_t trades)
+    {
+        counters.steps++;
+        counters.orders += orders;
+        counters.trades += trades;
+    }
+
+    void countDecisions(std::uint64_t decisions) { counters.decisions += decisions; }
+    void countUnsettled(std::uint64_t legs) { counters.unsettled += legs; }
+
+    // Book-level counters are owned by the book and filled in by the caller
+    StepProfileSummary summarize() const;
+};
+
+// Times the enclosing scope into one phase when the profiler is enabled
+class PhaseTimer
+{
+private:
+    using Clock = std::chrono::steady_clock;
+
+    StepProfiler *profiler; // nullptr when profiling is off
+    StepPhase phase;
+    Clock::time_point start;
+
+public:
+    PhaseTimer(StepProfiler &owner, StepPhase timed_phase)
+        : profiler(owner.isEnabled() ? &owner : nullptr), phase(timed_phase)
+    {
+        if (profiler)
+            start = Clock::now();
+    }
+
+    ~PhaseTimer()
+    {
+        if (profiler)
+        {
+            auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start);
+            profiler->record(phase, static_cast<std::uint64_t>(elapsed.count()));
+        }
+    }
+
+    PhaseTimer(const PhaseTimer &) = delete;
+    PhaseTimer &operator=(const PhaseTimer &) = delete;
+};
+
+#ifdef TRADINGSIM_PROFILING
+constexpr bool PROFILING_COMPILED = true;
+#define PROFILE_PHASE(profiler, phase) PhaseTimer phase_timer(profiler, phase)
+#else
+constexpr bool PROFILING_COMPILED = false;
+#define PROFILE_PHASE(profiler, phase) ((void)0)
+#endif
@@ -0,0 +1,44 @@
+#pragma once
+#include <cstdint>
+
+// Fixed-size mergeable quantile sketch (merging t-digest, Dunning 2019).
+// Values are kept as weighted centroids that are small near the tails and
+// large around the median, so extreme percentiles stay accurate while the
+// sketch never grows. Everything lives inline, so a sketch is trivially
+// copyable and can travel as raw bytes in an MPI reduction.
+class QuantileSketch
+{
+public:
+    static constexpr int COMPRESSION = 100; // Roughly the centroid count after compress()
+    static constexpr int CAPACITY = 2 * COMPRESSION + 56;
+
+private:
+    double means[CAPACITY];
+    double weights[CAPACITY];
+    int centroid_count;
+    bool compressed; // Sorted and merged since the last add
+    double total_weight;
+    double min_value;
+    double max_value;
+
+    void append(double mean, double weight);
+
+public:
+    QuantileSketch();
+
+    void add(double value);
+
+    // Fold another sketch in (the order of merges does not change the count,
+    // only the exact centroid boundaries)
+    void merge(const QuantileSketch &other);
+
+    // Sort and merge centroids down to about COMPRESSION
+    void compress();
+
+    // Estimated value at quantile q in [0, 1]; 0.0 when empty
+    double quantile(double q) const;
+
+    double getCount() const { return total_weight; }
+    double getMin() const { return min_value; }
+    double getMax() const { return max_value; }
+};
@@ -0,0 +1,129 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "order.hpp"
+#include "order_book.hpp"
+#include "binary_log.hpp"
+#include "logger.hpp"
+#include "profiler.hpp"
+
+// Recorded order flow fed back into a book by --replay. Two logs are
+// understood, as CSV or .tslog:
+//   orders log  Step,Timestamp,TraderID,Side,Price,Quantity,TimeInForce,
+//               ExpireTime (DataLogger's order logging; the last two are
+//               optional, GTC if absent). Each step is one round of
+//               expireOrders + addOrders + matchOrders, exactly as the
+//               simulation ran it, so a fresh book of the same type
+//               reproduces the recorded trades. Rounds expire orders at
+//               their latest order timestamp, the step's clock.
+//   trades log  TradeID,Timestamp,...,Price,Quantity. Each trade becomes a
+//               crossing sell and buy matched as its own round: a load
+//               source, not a reproduction (prices are rounded to cents and
+//               the resting liquidity is not in the log).
+enum class OrderFlowFormat
+{
+    ORDERS,
+    TRADES
+};
+
+// Streams rounds out of a log. CSV files are mapped read-only and parsed in
+// place, so only the current round's orders are ever copied.
+class OrderFlowReader
+{
+private:
+    // Fields of one log row that either format needs
+    struct Row
+    {
+        std::uint64_t step = 0;
+        double timestamp = 0.0;
+        int trader_id = 0;
+        int buyer_id = 0;
+        int seller_id = 0;
+        bool is_buy = true;
+        double price = 0.0;
+        int quantity = 0;
+        TimeInForce time_in_force = TimeInForce::GTC;
+        double expire_time = 0.0;
+    };
+
+    enum Field
+    {
+        STEP,
+        TIMESTAMP,
+        TRADER_ID,
+        SIDE,
+        BUYER_ID,
+        SELLER_ID,
+        PRICE,
+        QUANTITY,
+        TIME_IN_FORCE,
+        EXPIRE_TIME,
+        FIELD_COUNT
+    };
+
+    OrderFlowFormat format;
+    int field_columns[FIELD_COUNT]; // Column index per field, -1 if absent
+    long long rows_read;
+
+    // CSV input: the mapping and the parse position
+    const char *map_data;
+    size_t map_size;
+    size_t position;
+
+    // .tslog input: the decoded block and the next row in it
+    bool binary;
+    BinaryLogReader binary_reader;
+    std::vector<std::vector<std::int64_t>> block;
+    int block_rows;
+    int block_row;
+
+    Row pending; // First row of the next round, already read
+    bool has_pending;
+
+    void close();
+    bool bindColumns(const std::vector<std::string> &names);
+    int readRow(Row &row); // 1 row read, 0 end of input, -1 malformed
+    int readCsvRow(Row &row);
+    int readBinaryRow(Row &row);
+
+public:
+    OrderFlowReader();
+    ~OrderFlowReader();
+
+    OrderFlowReader(const OrderFlowReader &) = delete;
+    OrderFlowReader &operator=(const OrderFlowReader &) = delete;
+
+    // Open a CSV or .tslog orders/trades log. Returns false if it cannot be
+    // read or its columns are neither.
+    bool open(const std::string &filename);
+
+    OrderFlowFormat getFormat() const { return format; }
+
+    // The next round's orders (ids unassigned). Returns the order count,
+    // 0 at end of input and -1 on a malformed row.
+    int nextRound(std::vector<Order> &orders);
+
+    // Data rows consumed so far, for error messages
+    long long getRowsRead() const { return rows_read; }
+};
+
+struct ReplayResult
+{
+    bool ok = false; // Input was read to the end
+    std::uint64_t rounds = 0;
+    std::uint64_t orders = 0;
+    std::uint64_t trades = 0;
+    double volume = 0.0;
+    double wall_seconds = 0.0;        // Whole replay, parsing included
+    double book_seconds = 0.0;        // addOrders + matchOrders only
+    LatencyHistogram match_latency;   // matchOrders per round, ns
+    std::uint64_t trade_checksum = 0; // FNV-1a over every trade's ids, price bits and quantity
+
+    double ordersPerSecond() const { return book_seconds > 0.0 ? orders / book_seconds : 0.0; }
+};
+
+// Push every round through book as fast as it will go, optionally logging
+// the resulting trades. The book should be fresh so its order and trade ids
+// line up with the recording; equal checksums mean identical trades.
+ReplayResult replayOrderFlow(OrderFlowReader &reader, OrderBook &book, DataLogger *trade_log = nullptr);
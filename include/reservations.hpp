@@ -0,0 +1,95 @@
+#pragma once
+#include <vector>
+#include <deque>
+#include <cstdint>
+#include "order.hpp"
+#include "checkpoint.hpp"
+
+// Pre-trade funds check and open-order exposure per trader.
+//
+// An order is admitted only if its trader's free cash (buys, at the limit
+// price) or free holdings (sells) cover it, and that amount stays reserved
+// while the order rests. Resting orders are therefore always fundable:
+// fills settle against the reservation instead of being skipped for lack
+// of funds, and the book never fills up with orders that cannot trade.
+//
+// Records are kept per order id. The book hands out ids in submission
+// order, so admitted orders are bound to ids in one contiguous run; every
+// order of the book must go through admit() or reserve() for that to hold.
+class OrderReservations
+{
+private:
+    struct Reservation
+    {
+        int trader_id;
+        bool is_buy;
+        int remaining; // Quantity still reserved, 0 once filled or released
+        double price;  // Limit price the cash was reserved at (buys)
+    };
+
+    std::vector<double> reserved_cash;  // Per trader
+    std::vector<int> reserved_holdings; // Per trader
+    std::deque<Reservation> orders;     // By order id, from first_id
+    int first_id;
+    std::uint64_t rejected;
+
+    Reservation *find(int order_id);
+
+public:
+    explicit OrderReservations(int trader_count = 0);
+
+    void reset(int trader_count);
+
+    // Whether a trader holding cash and holdings can take on order beyond
+    // what its open orders already reserve
+    bool canAfford(const Order &order, double cash, int holdings) const;
+
+    // Check and reserve each order in turn, in trader id / submission order,
+    // and compact orders down to the admitted ones. funds(trader_id) returns
+    // the trader's {cash, holdings}. The two totals lose what is rejected.
+    template <typename Funds>
+    void admit(std::vector<Order> &batch, Funds funds, int &total_buy_quantity, int &total_sell_quantity)
+    {
+        size_t kept = 0;
+        for (size_t i = 0; i < batch.size(); i++)
+        {
+            const Order &order = batch[i];
+            auto account = funds(order.trader_id);
+            if (!reserve(order, account.first, account.second))
+            {
+                if (order.type == OrderType::BUY)
+                    total_buy_quantity -= order.quantity;
+                else
+                    total_sell_quantity -= order.quantity;
+                continue;
+            }
+            batch[kept++] = order;
+        }
+        batch.resize(kept);
+    }
+
+    // Single-order form of admit(); false (and counted) if it cannot be afforded
+    bool reserve(const Order &order, double cash, int holdings);
+
+    // Attach the orders just admitted to the ids the book gave them (first
+    // id from addOrders/addOrder, count in submission order)
+    void bind(int first_order_id, const Order *admitted, size_t count);
+
+    // A fill of quantity against order_id: releases that much of the
+    // reservation. Only touches the order's trader, so fills of different
+    // traders may be applied concurrently; call trim() afterwards.
+    void fill(int order_id, int quantity);
+
+    // Release whatever an order still holds (cancelled or expired)
+    void release(int order_id);
+
+    // Drop finished records from the front of the id range
+    void trim();
+
+    double getReservedCash(int trader_id) const { return reserved_cash[trader_id]; }
+    int getReservedHoldings(int trader_id) const { return reserved_holdings[trader_id]; }
+    std::uint64_t getRejectedCount() const { return rejected; }
+
+    void saveState(CheckpointWriter &out) const;
+    void loadState(CheckpointReader &in);
+};
@@ -0,0 +1,66 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+#include "order.hpp"
+#include "execution_policy.hpp"
+
+// Applies a step's fills to trader accounts. Every trade is a buy leg for
+// its buyer and a sell leg for its seller; the legs are bucketed by trader
+// id range with a stable counting sort, so each trader still sees its legs
+// in trade order, and the buckets are applied in parallel when the
+// execution policy says a step has enough legs. Only a trader's own bucket
+// writes its account, so the result is exactly that of settling the trades
+// one after another.
+class SettlementStage
+{
+private:
+    struct Leg
+    {
+        int trader_id;
+        int order_id;
+        bool is_buy;
+        double price;
+        int quantity;
+    };
+
+    std::vector<Leg> legs;            // Grouped by bucket, reused every step
+    std::vector<size_t> bucket_start; // bucket_count + 1 offsets into legs
+    std::vector<size_t> bucket_cursor;
+    int bucket_count = 0;
+
+    // Buckets for a plan's threads, 0 to settle serially
+    static int bucketsFor(const ExecutionPlan &plan, int trader_count);
+
+    void bucket(const std::vector<ExecutedTrade> &trades, int trader_count);
+
+public:
+    // apply(trader_id, order_id, is_buy, price, quantity) for both legs of every trade.
+    // Trader ids must be in [0, trader_count).
+    template <typename Apply>
+    void settle(const std::vector<ExecutedTrade> &trades, int trader_count, Apply apply)
+    {
+        ParallelRegion region(ParallelPhase::SETTLE, 2 * trades.size());
+        bucket_count = bucketsFor(region.plan(), trader_count);
+        if (bucket_count == 0)
+        {
+            for (const auto &trade : trades)
+            {
+                apply(trade.buyer_id, trade.buy_order_id, true, trade.price, trade.quantity);
+                apply(trade.seller_id, trade.sell_order_id, false, trade.price, trade.quantity);
+            }
+            return;
+        }
+
+        bucket(trades, trader_count);
+
+#pragma omp parallel for schedule(dynamic) num_threads(region.threads())
+        for (int b = 0; b < bucket_count; b++)
+        {
+            for (size_t i = bucket_start[b]; i < bucket_start[b + 1]; i++)
+            {
+                const Leg &leg = legs[i];
+                apply(leg.trader_id, leg.order_id, leg.is_buy, leg.price, leg.quantity);
+            }
+        }
+    }
+};
@@ -0,0 +1,51 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+#include "../include/simulation.hpp"
+
+struct LeaderboardEntry
+{
+    int trader_id;
+    Strategy strategy;
+    double net_worth;
+};
+
+// Immutable copy of everything the TUI draws, published by the simulation
+// thread so the renderer never reads live simulation state
+struct SimulationSnapshot
+{
+    std::uint64_t steps = 0;
+    double simulation_time = 0.0;
+    double current_price = 0.0;
+    double price_change_percent = 0.0;
+    std::vector<double> price_window; // Oldest first
+    std::vector<std::pair<double, int>> buy_depth;
+    std::vector<std::pair<double, int>> sell_depth;
+    double best_bid = 0.0;
+    double best_ask = 0.0;
+    double spread = 0.0;
+    SimulationStats stats;
+    std::vector<LeaderboardEntry> leaderboard; // Best net worth first, human excluded
+
+    int human_id = 0;
+    double human_cash = 0.0;
+    int human_holdings = 0;
+    double human_net_worth = 0.0;
+    std::string human_notification;
+};
+
+// Fills snapshots on the simulation thread. Keeps its ranking scratch
+// between captures so a large population is not reallocated every frame.
+class SnapshotBuilder
+{
+private:
+    std::vector<LeaderboardEntry> ranking;
+
+public:
+    int history_points = 200;
+    int depth_levels = 5;
+    int leaderboard_size = 5;
+
+    void capture(const TradingSimulation &simulation, int human_id, std::uint64_t steps, SimulationSnapshot &out);
+};
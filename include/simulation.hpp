@@ -1,10 +1,19 @@
 #pragma once
 #include <vector>
 #include <memory>
+#include <cstdint>
 #include "../include/trader.hpp"
 #include "../include/market.hpp"
 #include "../include/order_book.hpp"
 #include "../include/logger.hpp"
+#include "../include/indicator_engine.hpp"
+#include "../include/trader_population.hpp"
+#include "../include/profiler.hpp"
+#include "../include/instrument.hpp"
+#include "../include/settlement.hpp"
+#include "../include/reservations.hpp"
+#include "../include/market_feed_publisher.hpp"
+#include "../include/activation.hpp"
 
 // Struct for final simulation statistics
 struct SimulationStats {
@@ -18,41 +27,167 @@ struct SimulationStats {
     double best_bid = 0.0;
     double best_ask = 0.0;
     double spread = 0.0;
+    int instrument_count = 1; // >1: trades, volume and pending orders are summed, prices averaged, quotes are symbol 0's
+    StepProfileSummary profile; // Phase timings when profiling is enabled; counters always
 };
 
 class TradingSimulation {
 public:
-    TradingSimulation(int num_traders, double initial_price, double initial_cash, unsigned int seed = 12345);
+    TradingSimulation(int num_traders, double initial_price, double initial_cash, unsigned int seed = 12345,
+                      PopulationLayout layout = PopulationLayout::OBJECTS);
     
     void setTimeScale(double scale);
+
+    // Swap in a different book implementation (call before the first step)
+    void setOrderBookType(OrderBookType type, double tick_size = 0.01);
+    void setMatchingMode(MatchingMode mode);
+
+    // Agent orders are good till timestamp + seconds of simulation time, so
+    // stale quotes leave the book and free their reservations; 0 rests them
+    // until filled. Human orders are always good till cancelled. A run
+    // setting like the logs: not part of checkpoints.
+    static constexpr double DEFAULT_ORDER_LIFETIME = 10.0;
+    void setOrderLifetime(double seconds);
+    double getOrderLifetime() const { return order_lifetime; }
+
     void initializeMPI(bool use_mpi, int rank, int size);
+
+    // Host count symbols (count > 1), each with its own market, book, logs
+    // and per-symbol agents; traders share one cash account across them.
+    // Call after the book setup and logger initialize(); symbol k logs to
+    // <log dir>/SYM<k>/. Headless only: human orders still go to the
+    // single-symbol book.
+    void setInstrumentCount(int count);
+    int getInstrumentCount() const { return instruments.empty() ? 1 : static_cast<int>(instruments.size()); }
+    const std::vector<std::unique_ptr<Instrument>> &getInstruments() const { return instruments; } // Empty with one symbol
+    SimulationStats getInstrumentStats(int index) const;
+
+    // Shared cash account and net worth over every symbol (multi-instrument)
+    double getPortfolioCash(int trader_id) const { return portfolio_cash[trader_id]; }
+    double getPortfolioNetWorth(int trader_id) const;
+
+    // Publish every step's quotes, depth and trades to POSIX shared memory
+    // for external readers (market_feed.hpp): the segment is name, or
+    // name.SYM<k> per symbol with several. Follows later symbol count
+    // changes. False, with the reason on std::cerr, if a segment cannot be
+    // created; an empty name closes the feeds.
+    bool openMarketFeed(const std::string &name);
+
+    // Which traders decide each step (activation.hpp). EVENT asks only those
+    // whose arrival, price band or strategy signal fired, and supports the
+    // OBJECTS layout with one symbol: false, with the reason on std::cerr,
+    // otherwise, and several symbols set later are polled. Wake-ups are
+    // armed afresh on the next step, and after every load, restart, reseed
+    // or time scale change.
+    bool setActivation(const ActivationSettings &settings);
+    const ActivationSettings &getActivation() const { return activation_settings; }
+
+    // Time each step() phase into latency histograms (needs TRADINGSIM_PROFILING)
+    void setProfiling(bool enabled) { profiler.setEnabled(enabled); }
     
+    // Checkpoints of the full state: books, traders, market, indicators, RNG
+    // positions, id counters and the clock (see checkpoint.hpp). Loading needs
+    // a simulation built with the same trader count and layout; the book type,
+    // matching mode, time step and symbol count come from the checkpoint.
+    // Logs, profiler and MPI settings stay as they are. A failed load leaves
+    // the simulation partially overwritten, so discard it.
+    void saveState(CheckpointWriter &out) const;
+    bool loadState(CheckpointReader &in);
+    bool saveCheckpoint(const std::string &filename) const;
+    bool loadCheckpoint(const std::string &filename); // Reads the file through a read-only mapping
+    bool loadCheckpoint(const char *data, size_t size) { CheckpointReader in(data, size); return loadState(in); }
+
+    // Start a new run from a saved state on seed, in place: traders, arrays
+    // and the logger's writer thread are reused rather than rebuilt (sweep
+    // jobs). Profiler counters restart like a fresh simulation's; call the
+    // logger's initialize() first, the symbols' logs follow it.
+    bool restart(const char *data, size_t size, unsigned int seed);
+
+    // Continue on another seed's RNG streams, e.g. to fork ensemble variants
+    // off one warm start. Counters are kept, so the paths diverge at once.
+    void reseed(unsigned int seed);
+
     void step();
     SimulationStats runHeadless(double duration_seconds);
     SimulationStats getStats() const;
     
-    const Market& getMarket() const { return market; }
-    const OrderBook& getOrderBook() const { return order_book; }
-    const std::vector<std::unique_ptr<Trader>>& getTraders() const { return traders; }
+    const Market& getMarket() const { return instruments.empty() ? market : instruments[0]->getMarket(); }
+    const IndicatorEngine& getIndicators() const { return indicators; }
+    const OrderBook& getOrderBook() const { return instruments.empty() ? *order_book : instruments[0]->getOrderBook(); }
+    const std::vector<std::unique_ptr<Trader>>& getTraders() const { return traders; } // Empty with SOA layout
+    const TraderPopulation* getPopulation() const { return population.get(); }          // nullptr with OBJECTS layout
     DataLogger& getLogger() { return logger; }
 
     // --- NEW: Function for interactive TUI ---
-    void addHumanOrder(Order order);
-    std::string getHumanNotification() const { return last_human_trade_notification; }
+    // Returns the order id, or -1 if trader 0's free cash/holdings cannot cover it
+    int addHumanOrder(const Order &order);
+    std::string getHumanNotification() const; // Formatted from the human's last fill on each call
 
 
 private:
     Market market;
-    OrderBook order_book;
+    IndicatorEngine indicators;
+    std::unique_ptr<OrderBook> order_book;
     std::vector<std::unique_ptr<Trader>> traders;
+    std::unique_ptr<TraderPopulation> population;
+    StrategyRuns trader_runs;             // traders grouped by strategy
+    std::vector<TraderOrder> order_slots; // One per trader, reused every step
+    IndicatorSet trader_indicator_ids;    // The set every trader reads
+
+    // Event-driven activation: the scheduler, this step's woken traders in
+    // id order and grouped by strategy, and each strategy run's shared signal
+    struct RunSignal
+    {
+        IndicatorCache indicators;
+        bool on = false;
+    };
+    ActivationSettings activation_settings;
+    ActivationScheduler activation;
+    bool activation_armed = false;
+    std::vector<int> woken;
+    StrategyRuns woken_runs;
+    std::vector<RunSignal> run_signals; // Parallel to trader_runs.runs
     DataLogger logger;
+    StepProfiler profiler;
+
+    std::string feed_name;
+    std::vector<std::unique_ptr<MarketFeedPublisher>> feeds; // One per symbol while a feed is open
+
+    // Multi-instrument state: one shard per symbol plus the shared cash account
+    std::vector<std::unique_ptr<Instrument>> instruments;
+    std::vector<double> portfolio_cash;
+    std::vector<double> free_cash;    // This step's per-symbol share of each trader's unreserved cash
+    int trader_count;
+    double starting_cash;
+    OrderBookType book_type;
+    double book_tick_size;
     
     double current_time;
     double time_step;
+    std::uint64_t steps_run; // Step column of the order log; restarts on every run, not checkpointed
+    double order_lifetime;
+    std::vector<Order> expired_orders; // Reused every step
     unsigned int base_seed;
     
     bool mpi_enabled;
     int mpi_rank;
     int mpi_size;
-    std::string last_human_trade_notification;
+    ExecutedTrade last_human_trade; // Trader 0's most recent fill
+    bool has_human_trade;
+    Order last_human_rejection; // Shown instead of the fill until the next human fill
+    bool human_rejected;
+    OrderReservations reservations;
+    SettlementStage settlement;
+
+    // Release the reservations of orders the book expired or cancelled
+    void releaseExpiredOrders();
+
+    // Step every symbol in parallel, then reduce cash changes in symbol order
+    void stepInstruments();
+
+    // Per-object order generation for the OBJECTS layout
+    void createRunOrders(const StrategyRuns &runs, double current_price);
+    void collectWokenTraders(double current_price);
+    void generateTraderOrders(double current_price, std::vector<Order> &current_orders,
+                              int &total_buy_quantity, int &total_sell_quantity);
 };
\ No newline at end of file
@@ -0,0 +1,79 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Bounded lock-free single-producer/single-consumer queue.
+// Capacity is rounded up to a power of two. The producer and consumer
+// indices live on separate cache lines, and each side caches the other's
+// index so the shared atomics are only read when the ring looks full/empty.
+template <typename T>
+class SpscRing
+{
+private:
+    static constexpr size_t CACHE_LINE = 64;
+
+    std::vector<T> slots;
+    size_t mask;
+
+    alignas(CACHE_LINE) std::atomic<size_t> head; // Next slot to pop (consumer)
+    alignas(CACHE_LINE) size_t cached_tail;       // Consumer's view of tail
+    alignas(CACHE_LINE) std::atomic<size_t> tail; // Next slot to push (producer)
+    alignas(CACHE_LINE) size_t cached_head;       // Producer's view of head
+
+public:
+    explicit SpscRing(size_t capacity)
+        : head(0), cached_tail(0), tail(0), cached_head(0)
+    {
+        size_t size = 2;
+        while (size < capacity)
+        {
+            size <<= 1;
+        }
+        slots.resize(size);
+        mask = size - 1;
+    }
+
+    SpscRing(const SpscRing &) = delete;
+    SpscRing &operator=(const SpscRing &) = delete;
+
+    // Producer side. Returns false if the ring is full.
+    bool tryPush(const T &value)
+    {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - cached_head > mask)
+        {
+            cached_head = head.load(std::memory_order_acquire);
+            if (t - cached_head > mask)
+                return false;
+        }
+
+        slots[t & mask] = value;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. Returns false if the ring is empty.
+    bool tryPop(T &value)
+    {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == cached_tail)
+        {
+            cached_tail = tail.load(std::memory_order_acquire);
+            if (h == cached_tail)
+                return false;
+        }
+
+        value = slots[h & mask];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Either side; exact only when the other side is idle
+    bool empty() const
+    {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+
+    size_t capacity() const { return mask + 1; }
+};
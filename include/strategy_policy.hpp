@@ -0,0 +1,265 @@
+#pragma once
+#include <algorithm>
+#include <tuple>
+#include "trader.hpp"
+
+// Strategies as compile-time policy types.
+//
+// Each policy names its Strategy, the indicators it reads (refreshIndicators
+// computes only those), its order size, and a signal() over the shared price
+// window; RANDOM instead maps a per-trader roll through fromRoll().
+// visitStrategy() is the only runtime switch: callers dispatch once per
+// strategy group and run a loop specialised on the policy, so signals and
+// sizes inline and no per-trader branch on the strategy remains. Trader (per
+// object) and TraderPopulation (per group) decide through the same policies,
+// so both layouts stay bit-identical.
+//
+// A new strategy is a Strategy value, a policy struct below and a case in
+// visitStrategy().
+
+// Indicators a policy reads, as bits of needs
+constexpr unsigned NEEDS_NONE = 0;
+constexpr unsigned NEEDS_RSI = 1u << 0;
+constexpr unsigned NEEDS_MACD = 1u << 1;
+constexpr unsigned NEEDS_BOLLINGER = 1u << 2;
+
+struct Signal
+{
+    bool buy = false;
+    bool sell = false;
+};
+
+// What a signal sees: the newest TRADER_PRICE_WINDOW prices (at least 5),
+// the indicators after refreshIndicators, and the MACD histogram before it
+struct SignalInputs
+{
+    PriceSpan prices;
+    double current_price;
+    const IndicatorCache &indicators;
+    double previous_macd;
+};
+
+static inline double windowMean(PriceSpan prices, size_t begin, size_t end)
+{
+    double sum = 0;
+    for (size_t i = begin; i < end; i++)
+        sum += prices[i];
+    return sum / (end - begin);
+}
+
+// Trader 0: orders come from the UI, never from a signal
+struct HumanPolicy
+{
+    static constexpr Strategy strategy = Strategy::HUMAN;
+    static constexpr unsigned needs = NEEDS_NONE;
+    static constexpr int trade_size = 10;
+    static constexpr bool draws_per_trader = false;
+    static Signal signal(const SignalInputs &) { return {}; }
+};
+
+// Buy when the newer half of the window averages 2% above the older half
+struct MomentumPolicy
+{
+    static constexpr Strategy strategy = Strategy::MOMENTUM;
+    static constexpr unsigned needs = NEEDS_NONE;
+    static constexpr int trade_size = 10;
+    static constexpr bool draws_per_trader = false;
+    static Signal signal(const SignalInputs &in)
+    {
+        size_t half = in.prices.size() / 2;
+        double older_avg = windowMean(in.prices, 0, half);
+        double recent_avg = windowMean(in.prices, half, in.prices.size());
+        Signal s;
+        s.buy = recent_avg > older_avg * 1.02;
+        s.sell = !s.buy && recent_avg < older_avg * 0.98;
+        return s;
+    }
+};
+
+// Buy below the window mean by band, sell above it
+template <Strategy S, int Size, int BandPercent>
+struct MeanBandPolicy
+{
+    static constexpr Strategy strategy = S;
+    static constexpr unsigned needs = NEEDS_NONE;
+    static constexpr int trade_size = Size;
+    static constexpr bool draws_per_trader = false;
+    static Signal signal(const SignalInputs &in)
+    {
+        double mean = windowMean(in.prices, 0, in.prices.size());
+        Signal s;
+        s.buy = in.current_price < mean * (1.0 - BandPercent / 100.0);
+        s.sell = !s.buy && in.current_price > mean * (1.0 + BandPercent / 100.0);
+        return s;
+    }
+};
+
+using MeanReversionPolicy = MeanBandPolicy<Strategy::MEAN_REVERSION, 10, 5>;
+using RiskAversePolicy = MeanBandPolicy<Strategy::RISK_AVERSE, 5, 10>; // Wider band, small positions
+
+// Each trader rolls 0..10 on its own stream: 1 buys, 2 sells
+struct RandomPolicy
+{
+    static constexpr Strategy strategy = Strategy::RANDOM;
+    static constexpr unsigned needs = NEEDS_NONE;
+    static constexpr int trade_size = 10;
+    static constexpr bool draws_per_trader = true;
+    static constexpr int ROLL_SIDES = 11;
+    static Signal fromRoll(int roll) { return Signal{roll == 1, roll == 2}; }
+};
+
+// Chase 1% moves off the last three prices, in large positions
+struct HighRiskPolicy
+{
+    static constexpr Strategy strategy = Strategy::HIGH_RISK;
+    static constexpr unsigned needs = NEEDS_NONE;
+    static constexpr int trade_size = 20;
+    static constexpr bool draws_per_trader = false;
+    static Signal signal(const SignalInputs &in)
+    {
+        size_t recent_count = std::min<size_t>(3, in.prices.size());
+        double recent_avg = windowMean(in.prices, in.prices.size() - recent_count, in.prices.size());
+        Signal s;
+        s.buy = in.current_price > recent_avg * 1.01;
+        s.sell = !s.buy && in.current_price < recent_avg * 0.99;
+        return s;
+    }
+};
+
+struct RsiPolicy
+{
+    static constexpr Strategy strategy = Strategy::RSI_BASED;
+    static constexpr unsigned needs = NEEDS_RSI;
+    static constexpr int trade_size = 10;
+    static constexpr bool draws_per_trader = false;
+    static Signal signal(const SignalInputs &in)
+    {
+        Signal s;
+        s.buy = in.indicators.rsi < 30;
+        s.sell = !s.buy && in.indicators.rsi > 70;
+        return s;
+    }
+};
+
+// Histogram zero-crossing since the previous decision
+struct MacdPolicy
+{
+    static constexpr Strategy strategy = Strategy::MACD_BASED;
+    static constexpr unsigned needs = NEEDS_MACD;
+    static constexpr int trade_size = 10;
+    static constexpr bool draws_per_trader = false;
+    static Signal signal(const SignalInputs &in)
+    {
+        double histogram = in.indicators.macd;
+        Signal s;
+        s.buy = histogram > 0 && in.previous_macd <= 0;
+        s.sell = !s.buy && histogram < 0 && in.previous_macd >= 0;
+        return s;
+    }
+};
+
+struct BollingerPolicy
+{
+    static constexpr Strategy strategy = Strategy::BOLLINGER;
+    static constexpr unsigned needs = NEEDS_BOLLINGER;
+    static constexpr int trade_size = 10;
+    static constexpr bool draws_per_trader = false;
+    static Signal signal(const SignalInputs &in)
+    {
+        Signal s;
+        s.buy = in.current_price < in.indicators.bollinger_lower;
+        s.sell = !s.buy && in.current_price > in.indicators.bollinger_upper;
+        return s;
+    }
+};
+
+// Two of RSI, Bollinger and MACD sign agreeing; both sides can fire
+struct MultiIndicatorPolicy
+{
+    static constexpr Strategy strategy = Strategy::MULTI_INDICATOR;
+    static constexpr unsigned needs = NEEDS_RSI | NEEDS_MACD | NEEDS_BOLLINGER;
+    static constexpr int trade_size = 10;
+    static constexpr bool draws_per_trader = false;
+    static Signal signal(const SignalInputs &in)
+    {
+        const IndicatorCache &c = in.indicators;
+        int buy_signals = (c.rsi < 35) + (in.current_price < c.bollinger_lower) + (c.macd > 0);
+        int sell_signals = (c.rsi > 65) + (in.current_price > c.bollinger_upper) + (c.macd < 0);
+        return Signal{buy_signals >= 2, sell_signals >= 2};
+    }
+};
+
+// visit(Policy{}) for strategy's policy
+template <typename Visitor>
+decltype(auto) visitStrategy(Strategy strategy, Visitor &&visit)
+{
+    switch (strategy)
+    {
+    case Strategy::MOMENTUM:
+        return visit(MomentumPolicy{});
+    case Strategy::MEAN_REVERSION:
+        return visit(MeanReversionPolicy{});
+    case Strategy::RANDOM:
+        return visit(RandomPolicy{});
+    case Strategy::RISK_AVERSE:
+        return visit(RiskAversePolicy{});
+    case Strategy::HIGH_RISK:
+        return visit(HighRiskPolicy{});
+    case Strategy::RSI_BASED:
+        return visit(RsiPolicy{});
+    case Strategy::MACD_BASED:
+        return visit(MacdPolicy{});
+    case Strategy::BOLLINGER:
+        return visit(BollingerPolicy{});
+    case Strategy::MULTI_INDICATOR:
+        return visit(MultiIndicatorPolicy{});
+    default:
+        return visit(HumanPolicy{});
+    }
+}
+
+// Recompute the indicators in needs, from the shared engine when attached,
+// otherwise over the price window. Under 14 prices they keep their values.
+template <unsigned Needs>
+void refreshIndicators(IndicatorCache &cache, PriceSpan prices, const IndicatorEngine *engine, const IndicatorSet &ids)
+{
+    if constexpr (Needs != NEEDS_NONE)
+    {
+        if (prices.size() < 14)
+            return;
+
+        if constexpr ((Needs & NEEDS_RSI) != 0)
+            cache.rsi = engine ? engine->getRSI(ids.rsi) : TechnicalIndicators::calculateRSI(prices);
+        if constexpr ((Needs & NEEDS_MACD) != 0)
+            cache.macd = std::get<2>(engine ? engine->getMACD(ids.macd) : TechnicalIndicators::calculateMACD(prices));
+        if constexpr ((Needs & NEEDS_BOLLINGER) != 0)
+        {
+            auto [upper, middle, lower] = engine ? engine->getBollinger(ids.bollinger)
+                                                 : TechnicalIndicators::calculateBollingerBands(prices);
+            cache.bollinger_upper = upper;
+            cache.bollinger_lower = lower;
+        }
+    }
+}
+
+// Whether strategy's shared signal fires on prices (at least 5), with cache
+// refreshed as one of its traders would. RANDOM and HUMAN never signal.
+inline bool sharedSignal(Strategy strategy, IndicatorCache &cache, PriceSpan prices, double current_price,
+                         const IndicatorEngine *engine, const IndicatorSet &ids)
+{
+    return visitStrategy(strategy, [&](auto policy)
+                         {
+                             using Policy = decltype(policy);
+                             if constexpr (Policy::draws_per_trader || Policy::strategy == Strategy::HUMAN)
+                             {
+                                 return false;
+                             }
+                             else
+                             {
+                                 double previous_macd = cache.macd;
+                                 refreshIndicators<Policy::needs>(cache, prices, engine, ids);
+                                 Signal signal = Policy::signal(SignalInputs{prices, current_price, cache, previous_macd});
+                                 return signal.buy || signal.sell;
+                             }
+                         });
+}
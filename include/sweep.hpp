@@ -0,0 +1,48 @@
+#pragma once
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "simulation.hpp"
+#include "ensemble_stats.hpp"
+
+// One configuration of a --sweep run. Whatever the sweep file leaves out
+// comes from the command line.
+struct SweepPoint
+{
+    int num_traders = 12;
+    double initial_price = 170.0;
+    double initial_cash = 10000.0;
+    double time_scale = 1.0;
+    double duration_seconds = 60.0;
+    OrderBookType book_type = OrderBookType::MAP;
+    double tick_size = 0.01;
+    MatchingMode matching_mode = MatchingMode::CONTINUOUS;
+    double order_lifetime = TradingSimulation::DEFAULT_ORDER_LIFETIME;
+    PopulationLayout population_layout = PopulationLayout::OBJECTS;
+    int instruments = 1;
+};
+
+static_assert(std::is_trivially_copyable_v<SweepPoint>, "SweepPoint must be trivially copyable for MPI broadcasts.");
+
+// Sweep files hold one line per grid, '#' starting a comment:
+//
+//   traders=12,100,1000 cash=10000,50000   # 6 configs
+//   traders=5000 layout=soa book=tick      # 1 config
+//
+// Each line is the product of its comma-separated values, the last key
+// varying fastest. Keys: traders, price, cash, speed, duration, book
+// (map|tick), tick, matching (continuous|batch), ttl, layout (objects|soa),
+// instruments. Appends the expanded configs to points; false, with the
+// offending line on std::cerr, if the file cannot be read or a key or value
+// is not understood.
+bool loadSweepFile(const std::string &filename, const SweepPoint &defaults, std::vector<SweepPoint> &points);
+
+// The config as a sweep file line, for progress output
+std::string describeSweepPoint(const SweepPoint &point);
+
+// One CSV row per config: its settings, then the seeds run, their summed
+// wall time and the ensemble statistics over them. The best/worst columns
+// are seeds. False if the file cannot be written.
+bool writeSweepResults(const std::string &filename, const std::vector<SweepPoint> &points,
+                       const std::vector<EnsembleAccumulator> &results, const std::vector<double> &wall_seconds,
+                       int seeds, unsigned int base_seed);
@@ -0,0 +1,53 @@
+#pragma once
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <atomic>
+
+// Fixed-size work-stealing thread pool for coarse tasks (whole simulations).
+// Every worker owns a deque: it pops its own work from the back and, when
+// empty, steals from the front of the others. Workers run with a single
+// OpenMP thread so the parallel regions inside a task do not oversubscribe
+// the machine.
+class ThreadPool
+{
+private:
+    struct WorkQueue
+    {
+        std::deque<std::function<void()>> tasks;
+        std::mutex mutex;
+    };
+
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::vector<std::thread> workers;
+
+    std::mutex state_mutex;
+    std::condition_variable work_available;
+    std::condition_variable all_done;
+    int queued;  // Tasks sitting in a queue, guarded by state_mutex
+    int pending; // Tasks submitted and not yet finished, guarded by state_mutex
+    bool stopping;
+    std::atomic<unsigned> next_queue;
+
+    bool takeTask(int worker, std::function<void()> &task);
+    void workerLoop(int worker);
+
+public:
+    // num_threads <= 0 uses one worker per hardware thread
+    explicit ThreadPool(int num_threads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    void submit(std::function<void()> task);
+
+    // Block until every submitted task has finished
+    void wait();
+
+    int size() const { return static_cast<int>(workers.size()); }
+};
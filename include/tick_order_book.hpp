@@ -0,0 +1,59 @@
+#pragma once
+#include "order_book.hpp"
+#include <vector>
+#include <cstdint>
+
+// Order book keyed on integer price ticks.
+// Each side is a power-of-two ring of levels indexed by (tick & mask). The ring
+// covers a sliding window of ticks around the mid, so price drift needs no
+// re-centring, a level lookup is a single array access and nothing is
+// allocated for prices already in range.
+class TickOrderBook : public OrderBook
+{
+private:
+    struct BookSide
+    {
+        std::vector<PriceLevel> levels;
+        std::int64_t mask = 0;
+        std::int64_t best_tick = 0;  // Highest bid / lowest ask
+        std::int64_t worst_tick = 0; // Lowest bid / highest ask
+        int level_count = 0;
+        bool is_bid = false;
+
+        bool empty() const { return level_count == 0; }
+        PriceLevel &at(std::int64_t tick) { return levels[tick & mask]; }
+        const PriceLevel &at(std::int64_t tick) const { return levels[tick & mask]; }
+        bool better(std::int64_t a, std::int64_t b) const { return is_bid ? a > b : a < b; }
+    };
+
+    double tick_size;
+    BookSide bids;
+    BookSide asks;
+
+    BookSide &sideFor(OrderType side) { return side == OrderType::BUY ? bids : asks; }
+    const BookSide &sideFor(OrderType side) const { return side == OrderType::BUY ? bids : asks; }
+
+    // Ticks of prices that are already on the grid
+    std::int64_t toTick(double price) const;
+    double tickToPrice(std::int64_t tick) const { return tick * tick_size; }
+
+    // Widen the ring so that the side's live ticks plus tick fit without aliasing
+    void ensureRange(BookSide &side, std::int64_t tick);
+    void advanceBest(BookSide &side);
+    void retreatWorst(BookSide &side);
+
+protected:
+    // Bids round down and asks round up so that a snapped order never
+    // trades through its original limit
+    double snapPrice(OrderType side, double price) const override;
+    PriceLevel &getOrCreateLevel(OrderType side, double price) override;
+    void removeLevel(OrderType side, double price) override;
+    PriceLevel *bestLevel(OrderType side) override;
+    double bestPrice(OrderType side) const override;
+    void visitLevels(OrderType side, const LevelVisitor &visit) const override;
+
+public:
+    TickOrderBook(double tick_size = 0.01, int initial_levels = 4096);
+
+    double getTickSize() const { return tick_size; }
+};
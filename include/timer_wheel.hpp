@@ -0,0 +1,56 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Hierarchical timer wheel over integer ticks (Varghese & Lauck).
+//
+// LEVELS wheels of SLOTS slots each: level L holds timers whose tick first
+// differs from the current tick in bits [L*SLOT_BITS, (L+1)*SLOT_BITS), in
+// the slot named by those bits of the tick. Advancing one tick fires one
+// level-0 slot, and each time a level's lower bits wrap to zero the next
+// slot of that level is cascaded down. Timers beyond the top level wait in
+// an overflow list re-placed whenever the top level wraps.
+//
+// schedule() is O(1); advance() is O(ticks crossed + timers fired or
+// cascaded), and jumps straight to the target tick when nothing is pending.
+// Timers cannot be cancelled: the owner ignores ids that no longer apply.
+class TimerWheel
+{
+public:
+    static constexpr int SLOT_BITS = 6;
+    static constexpr int SLOTS = 1 << SLOT_BITS;
+    static constexpr int LEVELS = 4; // 2^24 ticks before the overflow list
+
+private:
+    struct Timer
+    {
+        int id;
+        std::uint64_t tick;
+    };
+
+    std::vector<Timer> slots[LEVELS][SLOTS];
+    std::vector<Timer> overflow; // Beyond the top level
+    std::vector<Timer> due;      // Scheduled at or before the current tick
+    std::uint64_t current_tick;
+    size_t pending;
+
+    void place(const Timer &timer);
+    void cascade(std::vector<Timer> &slot);
+
+public:
+    TimerWheel();
+
+    // Drop every timer and restart at tick
+    void reset(std::uint64_t tick = 0);
+
+    // Fire id once the wheel reaches tick (at the next advance if already past)
+    void schedule(int id, std::uint64_t tick);
+
+    // Move to now_tick, appending the ids of every timer due by then to
+    // fired, in no particular order. Never moves backwards.
+    void advance(std::uint64_t now_tick, std::vector<int> &fired);
+
+    std::uint64_t getCurrentTick() const { return current_tick; }
+    size_t getPendingCount() const { return pending; }
+};
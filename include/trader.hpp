@@ -1,7 +1,12 @@
 #pragma once
 #include <string>
 #include <vector>
-#include <random>
+#include <memory>
+#include <tuple>
+#include <cstdint>
+#include "indicator_engine.hpp"
+#include "counter_rng.hpp"
+#include "price_history.hpp"
 
 enum class Strategy
 {   
@@ -17,23 +22,30 @@ enum class Strategy
     MULTI_INDICATOR // Combination of multiple indicators
 };
 
+// Prices a trader's rule-based strategies look back over
+constexpr size_t TRADER_PRICE_WINDOW = 50;
+
+// Strategy for the trader at index i (trader 0 is the human player)
+Strategy assignStrategy(int trader_index);
+std::string strategyName(Strategy strategy);
+
 // Technical Indicators class for parallel computation
 class TechnicalIndicators
 {
 public:
     // Calculate Simple Moving Average
-    static double calculateSMA(const std::vector<double> &prices, int period);
+    static double calculateSMA(PriceSpan prices, int period);
 
     // Calculate Exponential Moving Average
-    static double calculateEMA(const std::vector<double> &prices, int period);
+    static double calculateEMA(PriceSpan prices, int period);
 
     // Calculate RSI (Relative Strength Index)
-    static double calculateRSI(const std::vector<double> &prices, int period = 14);
+    static double calculateRSI(PriceSpan prices, int period = 14);
 
     // Calculate MACD (Moving Average Convergence Divergence)
     // Returns {MACD line, Signal line, Histogram}
     static std::tuple<double, double, double> calculateMACD(
-        const std::vector<double> &prices,
+        PriceSpan prices,
         int fast_period = 12,
         int slow_period = 26,
         int signal_period = 9);
@@ -41,18 +53,28 @@ public:
     // Calculate Bollinger Bands
     // Returns {Upper band, Middle band, Lower band}
     static std::tuple<double, double, double> calculateBollingerBands(
-        const std::vector<double> &prices,
+        PriceSpan prices,
         int period = 20,
         double std_dev = 2.0);
 
     // Parallel computation of multiple indicators
     static void calculateAllIndicators(
-        const std::vector<double> &prices,
+        PriceSpan prices,
         double &rsi,
         std::tuple<double, double, double> &macd,
         std::tuple<double, double, double> &bollinger);
 };
 
+// Indicator values a strategy last decided on. Each strategy refreshes only
+// the ones it reads; they stay stale while the history is too short.
+struct IndicatorCache
+{
+    double rsi = 50.0;
+    double macd = 0.0; // Histogram
+    double bollinger_upper = 0.0;
+    double bollinger_lower = 0.0;
+};
+
 struct Trade
 {
     int trader_id;
@@ -80,27 +102,64 @@ private:
     int holdings;
     double total_profit;
     int trades_executed;
-    std::vector<double> price_history;
-    std::mt19937 rng;
+    // Market's shared history, or own_history until one is attached
+    const PriceHistory *price_history;
+    std::unique_ptr<PriceHistory> own_history;
+    CounterRng rng;              // Stream keyed by (seed, id)
+    std::uint64_t decision_step; // createOrder calls so far, the RNG counter
+
+    // Shared streaming indicators (nullptr: compute from the price window)
+    const IndicatorEngine *indicators;
+    IndicatorSet indicator_ids;
+    IndicatorCache last_indicators;
 
 public:
+    // seed is the simulation seed; the trader id selects the RNG stream
     Trader(int trader_id, Strategy strat, double initial_cash, unsigned int seed);
 
+    // Read indicators from a shared engine instead of recomputing them
+    void attachIndicators(const IndicatorEngine *engine, IndicatorSet ids);
+
+    // Read prices from the market's history instead of recording a private
+    // copy. createOrder must then be called once per market update, as the
+    // simulation does, so the newest entry is the price being traded on.
+    void attachPriceHistory(const PriceHistory *history);
+
     // Make trading decision based on current price and strategy
     Trade makeDecision(double current_price, double timestamp);
 
     // Create limit order based on strategy
     TraderOrder createOrder(double current_price, double timestamp);
 
+    // createOrder for traders[indices[0..count)], which must all follow
+    // strategy, into slots[index]. Dispatches on the strategy once, not per
+    // trader.
+    static void createOrders(Strategy strategy, const std::vector<std::unique_ptr<Trader>> &traders,
+                             const int *indices, int count, double current_price, double timestamp,
+                             TraderOrder *slots);
+
     // Execute a trade
     void executeTrade(const Trade &trade);
 
-    // Execute order (for order book)
-    void executeOrder(bool is_buy, double price, int quantity);
+    // Execute order (for order book). False if the account cannot pay or
+    // deliver, in which case nothing changes: with reservations that is a bug
+    bool executeOrder(bool is_buy, double price, int quantity);
 
     // Give initial holdings
     void setInitialHoldings(int initial_holdings) { holdings = initial_holdings; }
 
+    // Replace spendable cash (multi-instrument buying power for this step)
+    void setCash(double amount) { cash = amount; }
+
+    // Account, RNG position and cached indicators for checkpoints. Id and
+    // strategy must match; attached histories are saved by their owner.
+    void saveState(CheckpointWriter &out) const;
+    void loadState(CheckpointReader &in);
+
+    // Switch to the RNG stream of another simulation seed, keeping the
+    // decision counter (forks variants off a shared warm start)
+    void reseed(unsigned int seed) { rng = CounterRng(seed, static_cast<std::uint32_t>(id)); }
+
     // Getters
     int getId() const { return id; }
     Strategy getStrategy() const { return strategy; }
@@ -116,14 +175,38 @@ public:
     std::string getStrategyName() const;
 
     // Get recent technical indicators (cached)
-    double getLastRSI() const { return last_rsi; }
-    double getLastMACD() const { return last_macd; }
+    double getLastRSI() const { return last_indicators.rsi; }
+    double getLastMACD() const { return last_indicators.macd; }
 
 private:
-    // Technical indicator calculations (with caching)
-    void updateIndicators();
-    double last_rsi;
-    double last_macd;
-    double last_bollinger_upper;
-    double last_bollinger_lower;
+    // Newest TRADER_PRICE_WINDOW prices, oldest first
+    PriceSpan recentPrices() const { return price_history->recent(TRADER_PRICE_WINDOW); }
+
+    // makeDecision and createOrder specialised on a strategy policy
+    // (strategy_policy.hpp)
+    template <typename Policy>
+    Trade decide(double current_price, double timestamp);
+    template <typename Policy>
+    TraderOrder createOrderAs(double current_price, double timestamp);
+};
+
+// A stretch of StrategyRuns::indices whose traders share a strategy
+struct StrategyRun
+{
+    Strategy strategy;
+    int begin;
+    int end;
+};
+
+// AI traders grouped by strategy, in id order inside each run, so order
+// generation can dispatch once per run. The human trader is left out.
+struct StrategyRuns
+{
+    std::vector<int> indices; // Positions in the trader vector
+    std::vector<StrategyRun> runs;
+
+    void build(const std::vector<std::unique_ptr<Trader>> &traders);
+
+    // Only the traders at positions[0..count), which must be ascending
+    void build(const std::vector<std::unique_ptr<Trader>> &traders, const int *positions, size_t count);
 };
@@ -0,0 +1,112 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include "order.hpp"
+#include "trader.hpp"
+#include "indicator_engine.hpp"
+
+// How TradingSimulation stores its AI traders
+enum class PopulationLayout
+{
+    OBJECTS, // One heap-allocated Trader per agent
+    SOA      // TraderPopulation: contiguous per-field arrays grouped by strategy
+};
+
+// Structure-of-arrays trader population.
+// Traders are laid out in contiguous slots grouped by Strategy, with cash,
+// holdings and profit each in their own array. Random draws come from the
+// counter-based (seed, trader id, step) stream Trader uses, so no per-trader
+// RNG state is stored at all. Every
+// trader in a group sees the same market price history, so a strategy's
+// signal is computed once per group and a branch-free kernel then turns it
+// into per-trader order quantities. Orders are emitted in trader id order,
+// so both layouts feed the book identically. Trader 0 (the human player) is kept for
+// id compatibility but never generates orders.
+class TraderPopulation
+{
+public:
+    struct StrategyGroup
+    {
+        Strategy strategy;
+        int begin; // First slot
+        int end;   // One past the last slot
+
+        // Indicators the group last decided on, refreshed like a Trader's
+        IndicatorCache last_indicators;
+    };
+
+private:
+    // Per-slot state
+    std::vector<int> trader_ids;
+    std::vector<Strategy> strategies;
+    std::vector<double> cash;
+    std::vector<int> holdings;
+    std::vector<double> total_profit;
+    std::vector<int> trades_executed;
+    std::vector<int> decisions; // Scratch: +qty buy, -qty sell, 0 none
+
+    std::vector<int> slot_of; // trader id -> slot
+    std::vector<StrategyGroup> groups;
+
+    // Market's shared history, or own_history until one is attached
+    const PriceHistory *price_history;
+    std::unique_ptr<PriceHistory> own_history;
+
+    unsigned int seed;
+    std::uint64_t tick; // generateOrders calls so far, the RNG counter
+
+    const IndicatorEngine *indicators;
+    IndicatorSet indicator_ids;
+
+    // Per-trader quantities for a group that shares one signal from the
+    // window and indicators, or for RANDOM, each trader rolling on its own
+    // stream. Policy is the group's strategy (strategy_policy.hpp).
+    template <typename Policy>
+    void decideGroup(StrategyGroup &group, double current_price);
+    template <typename Policy>
+    void decideRandomGroup(const StrategyGroup &group, double current_price);
+
+public:
+    TraderPopulation(int num_traders, double initial_cash, unsigned int seed);
+
+    void attachIndicators(const IndicatorEngine *engine, IndicatorSet ids);
+
+    // Same contract as Trader::attachPriceHistory: one generateOrders per market update
+    void attachPriceHistory(const PriceHistory *history);
+
+    // Give initial holdings to the first `count` trader ids
+    void setInitialHoldings(int count, int initial_holdings);
+
+    // Evaluate every strategy group and append the resulting limit orders
+    void generateOrders(double current_price, double timestamp, std::vector<Order> &orders,
+                        int &total_buy_quantity, int &total_sell_quantity);
+
+    // Execute order (for order book); same contract as Trader::executeOrder
+    bool executeOrder(int trader_id, bool is_buy, double price, int quantity);
+
+    // Accounts, RNG position and group indicator caches for checkpoints;
+    // the population must have been built with the same trader count
+    void saveState(CheckpointWriter &out) const;
+    void loadState(CheckpointReader &in);
+
+    // Same as Trader::reseed for every trader
+    void reseed(unsigned int rng_seed) { seed = rng_seed; }
+
+    int size() const { return static_cast<int>(trader_ids.size()); }
+    const std::vector<StrategyGroup> &getGroups() const { return groups; }
+
+    // Getters by trader id
+    Strategy getStrategy(int trader_id) const { return strategies[slot_of[trader_id]]; }
+    double getCash(int trader_id) const { return cash[slot_of[trader_id]]; }
+    int getHoldings(int trader_id) const { return holdings[slot_of[trader_id]]; }
+    double getTotalProfit(int trader_id) const { return total_profit[slot_of[trader_id]]; }
+    int getTradesExecuted(int trader_id) const { return trades_executed[slot_of[trader_id]]; }
+    double getNetWorth(int trader_id, double current_price) const
+    {
+        int slot = slot_of[trader_id];
+        return cash[slot] + holdings[slot] * current_price;
+    }
+    double getLastRSI(int trader_id) const;
+    double getLastMACD(int trader_id) const;
+};
@@ -0,0 +1,46 @@
+#pragma once
+#include <atomic>
+
+// Lock-free single-writer/single-reader handoff of the latest value.
+// The writer fills writeBuffer() and publish()es it; the reader's read()
+// returns the newest published value and never waits. Three slots mean
+// neither side ever touches the slot the other is using, and the reader
+// simply skips values it was too slow to see.
+template <typename T>
+class TripleBuffer
+{
+private:
+    static constexpr int INDEX_MASK = 3;
+    static constexpr int FRESH = 4; // Set on middle when it holds an unread value
+
+    T slots[3];
+    std::atomic<int> middle; // Slot index in transit, plus FRESH
+    int back;                // Writer-owned
+    int front;               // Reader-owned
+
+public:
+    TripleBuffer() : middle(2), back(0), front(1) {}
+
+    TripleBuffer(const TripleBuffer &) = delete;
+    TripleBuffer &operator=(const TripleBuffer &) = delete;
+
+    // Writer side. Holds whatever was published two rounds ago, so fill it completely.
+    T &writeBuffer() { return slots[back]; }
+
+    void publish()
+    {
+        int previous = middle.exchange(back | FRESH, std::memory_order_acq_rel);
+        back = previous & INDEX_MASK;
+    }
+
+    // Reader side. Latest published value, or the last one read if nothing new.
+    const T &read()
+    {
+        if (middle.load(std::memory_order_relaxed) & FRESH)
+        {
+            int previous = middle.exchange(front, std::memory_order_acq_rel);
+            front = previous & INDEX_MASK;
+        }
+        return slots[front];
+    }
+};
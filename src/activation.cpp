@@ -0,0 +1,197 @@
+#include "../include/activation.hpp"
+#include "../include/counter_rng.hpp"
+#include <algorithm>
+#include <cmath>
+
+// Lane of the agent's stream used for arrivals; Trader decisions draw lane 0
+static constexpr std::uint32_t ARRIVAL_LANE = 1;
+
+// Heap orders putting the edge a moving price reaches first on top
+struct LowestFirst
+{
+    template <typename Edge>
+    bool operator()(const Edge &a, const Edge &b) const { return a.price > b.price; }
+};
+
+struct HighestFirst
+{
+    template <typename Edge>
+    bool operator()(const Edge &a, const Edge &b) const { return a.price < b.price; }
+};
+
+// An arrival step no timer reaches: the agent is not armed
+static constexpr std::uint64_t NEVER = ~std::uint64_t(0);
+
+void ActivationScheduler::reset(int agents, const ActivationSettings &settings, double step_seconds,
+                                unsigned int rng_seed, std::uint64_t step)
+{
+    mean_steps = (settings.mean_interval > 0.0 && step_seconds > 0.0) ? settings.mean_interval / step_seconds : 0.0;
+    price_band = std::max(settings.price_band, 0.0);
+    seed = rng_seed;
+
+    arrivals.reset(step);
+    arrival_step.assign(agents, NEVER);
+    generation.assign(agents, 0);
+    woken_step.assign(agents, 0);
+
+    // Bands keep their member buffers for reuse
+    free_bands.clear();
+    for (size_t b = bands.size(); b-- > 0;)
+    {
+        bands[b].edges = 0;
+        bands[b].members.clear();
+        free_bands.push_back(static_cast<int>(b));
+    }
+    open_band = -1;
+    upper.clear();
+    lower.clear();
+    members = 0;
+    armed = 0;
+}
+
+int ActivationScheduler::openBand(std::uint64_t step, double price)
+{
+    if (open_band >= 0 && bands[open_band].step == step && bands[open_band].price == price)
+        return open_band;
+
+    int band;
+    if (free_bands.empty())
+    {
+        band = static_cast<int>(bands.size());
+        bands.emplace_back();
+    }
+    else
+    {
+        band = free_bands.back();
+        free_bands.pop_back();
+    }
+    bands[band].step = step;
+    bands[band].price = price;
+    bands[band].edges = 2;
+
+    upper.push_back(Edge{price * (1.0 + price_band), band});
+    std::push_heap(upper.begin(), upper.end(), LowestFirst());
+    lower.push_back(Edge{price * (1.0 - price_band), band});
+    std::push_heap(lower.begin(), lower.end(), HighestFirst());
+    open_band = band;
+    return band;
+}
+
+void ActivationScheduler::releaseEdge(int band)
+{
+    if (--bands[band].edges > 0)
+        return;
+    members -= bands[band].members.size();
+    bands[band].members.clear();
+    free_bands.push_back(band);
+    if (open_band == band)
+        open_band = -1;
+}
+
+void ActivationScheduler::arm(int agent, std::uint64_t step, double price)
+{
+    if (generation[agent] == 0) // First arm
+        armed++;
+    generation[agent]++;
+    arrival_step[agent] = NEVER;
+
+    if (mean_steps > 0.0)
+    {
+        // Exponential gap, rounded up to whole steps
+        CounterRng rng(seed, static_cast<std::uint32_t>(agent));
+        double gap = -std::log1p(-rng.uniform(step, ARRIVAL_LANE)) * mean_steps;
+        std::uint64_t wake = step + std::max<std::uint64_t>(1, static_cast<std::uint64_t>(std::ceil(gap)));
+        arrival_step[agent] = wake;
+        arrivals.schedule(agent, wake);
+    }
+
+    if (price_band > 0.0)
+    {
+        bands[openBand(step, price)].members.push_back(Member{agent, generation[agent]});
+        members++;
+
+        // Each armed agent is live in one band; the rest are stale
+        if (members > 2 * armed + 1024)
+            compact();
+    }
+}
+
+void ActivationScheduler::compact()
+{
+    for (Band &band : bands)
+    {
+        auto stale = [this](const Member &member) { return member.generation != generation[member.agent]; };
+        size_t before = band.members.size();
+        band.members.erase(std::remove_if(band.members.begin(), band.members.end(), stale), band.members.end());
+        members -= before - band.members.size();
+    }
+
+    // Bands left empty leave both heaps
+    auto empty = [this](const Edge &edge) { return bands[edge.band].members.empty(); };
+    for (std::vector<Edge> *heap : {&upper, &lower})
+    {
+        for (const Edge &edge : *heap)
+        {
+            if (empty(edge))
+                releaseEdge(edge.band);
+        }
+        heap->erase(std::remove_if(heap->begin(), heap->end(), empty), heap->end());
+    }
+    std::make_heap(upper.begin(), upper.end(), LowestFirst());
+    std::make_heap(lower.begin(), lower.end(), HighestFirst());
+}
+
+void ActivationScheduler::wake(int agent, std::uint64_t step, std::vector<int> &woken)
+{
+    if (woken_step[agent] == step + 1)
+        return;
+    woken_step[agent] = step + 1;
+    woken.push_back(agent);
+
+    // Disarmed until the next arm(): later arrivals and bands skip it
+    generation[agent]++;
+    arrival_step[agent] = NEVER;
+}
+
+void ActivationScheduler::fireBand(int band, std::uint64_t step, std::vector<int> &woken)
+{
+    // Every live member wakes, leaving the whole band stale
+    std::vector<Member> &list = bands[band].members;
+    for (const Member &member : list)
+    {
+        if (member.generation == generation[member.agent])
+            wake(member.agent, step, woken);
+    }
+    members -= list.size();
+    list.clear();
+    releaseEdge(band);
+}
+
+void ActivationScheduler::collect(std::uint64_t step, double price, std::vector<int> &woken)
+{
+    // Arrivals; a timer whose agent has been re-armed or woken since is stale
+    fired.clear();
+    arrivals.advance(step, fired);
+    for (int agent : fired)
+    {
+        if (arrival_step[agent] <= step)
+            wake(agent, step, woken);
+    }
+
+    // Bands the price has moved out of, until the nearest edge is ahead
+    while (!upper.empty() && upper.front().price <= price)
+    {
+        int band = upper.front().band;
+        std::pop_heap(upper.begin(), upper.end(), LowestFirst());
+        upper.pop_back();
+        fireBand(band, step, woken);
+    }
+
+    while (!lower.empty() && lower.front().price >= price)
+    {
+        int band = lower.front().band;
+        std::pop_heap(lower.begin(), lower.end(), HighestFirst());
+        lower.pop_back();
+        fireBand(band, step, woken);
+    }
+}
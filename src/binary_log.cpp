@@ -0,0 +1,265 @@
+#include "../include/binary_log.hpp"
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+static const char LOG_MAGIC[8] = {'T', 'S', 'I', 'M', 'L', 'O', 'G', '1'};
+static constexpr std::uint16_t LOG_VERSION = 1;
+
+// Per-column block prefix: first value, min delta, width
+static constexpr size_t COLUMN_PREFIX_BYTES = 8 + 8 + 1;
+
+static void putBytes(unsigned char *&out, std::uint64_t value, int width)
+{
+    for (int i = 0; i < width; i++)
+    {
+        *out++ = static_cast<unsigned char>(value >> (8 * i));
+    }
+}
+
+static std::uint64_t getBytes(const unsigned char *&in, int width)
+{
+    std::uint64_t value = 0;
+    for (int i = 0; i < width; i++)
+    {
+        value |= static_cast<std::uint64_t>(*in++) << (8 * i);
+    }
+    return value;
+}
+
+static int byteWidth(std::uint64_t range)
+{
+    if (range == 0)
+        return 0;
+    if (range <= 0xFFu)
+        return 1;
+    if (range <= 0xFFFFu)
+        return 2;
+    if (range <= 0xFFFFFFFFu)
+        return 4;
+    return 8;
+}
+
+BinaryLogWriter::BinaryLogWriter(std::vector<LogColumn> schema)
+    : columns(std::move(schema)), rows(0), bytes_written(0)
+{
+    values.resize(columns.size() * BLOCK_ROWS);
+    block.resize(4 + columns.size() * (COLUMN_PREFIX_BYTES + 8 * BLOCK_ROWS));
+}
+
+BinaryLogWriter::~BinaryLogWriter()
+{
+    close();
+}
+
+std::int64_t BinaryLogWriter::toFixed2(double value)
+{
+    return std::llround(value * 100.0);
+}
+
+std::int64_t BinaryLogWriter::toFloat64(double value)
+{
+    std::int64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+bool BinaryLogWriter::open(const std::string &filename)
+{
+    close();
+
+    file.open(filename, std::ios::out | std::ios::trunc | std::ios::binary);
+    if (!file.is_open())
+        return false;
+
+    // Header is small, build it in the block buffer
+    unsigned char *out = block.data();
+    std::memcpy(out, LOG_MAGIC, sizeof(LOG_MAGIC));
+    out += sizeof(LOG_MAGIC);
+    putBytes(out, LOG_VERSION, 2);
+    putBytes(out, columns.size(), 2);
+    for (const auto &column : columns)
+    {
+        size_t name_length = std::min<size_t>(column.name.size(), 255);
+        *out++ = static_cast<unsigned char>(column.kind);
+        *out++ = static_cast<unsigned char>(name_length);
+        std::memcpy(out, column.name.data(), name_length);
+        out += name_length;
+    }
+
+    std::streamsize size = out - block.data();
+    file.write(reinterpret_cast<const char *>(block.data()), size);
+    bytes_written = size;
+    rows = 0;
+    return true;
+}
+
+void BinaryLogWriter::close()
+{
+    if (!file.is_open())
+        return;
+
+    flush();
+    file.close();
+}
+
+void BinaryLogWriter::writeBlock()
+{
+    if (rows == 0 || !file.is_open())
+    {
+        rows = 0;
+        return;
+    }
+
+    unsigned char *out = block.data();
+    putBytes(out, static_cast<std::uint32_t>(rows), 4);
+
+    for (size_t c = 0; c < columns.size(); c++)
+    {
+        const std::int64_t *column = &values[c * BLOCK_ROWS];
+
+        std::int64_t min_delta = 0;
+        std::uint64_t range = 0;
+        if (rows > 1)
+        {
+            // Unsigned arithmetic so deltas wrap instead of overflowing
+            min_delta = static_cast<std::int64_t>(static_cast<std::uint64_t>(column[1]) - static_cast<std::uint64_t>(column[0]));
+            std::int64_t max_delta = min_delta;
+            for (int r = 2; r < rows; r++)
+            {
+                std::int64_t delta = static_cast<std::int64_t>(static_cast<std::uint64_t>(column[r]) - static_cast<std::uint64_t>(column[r - 1]));
+                min_delta = std::min(min_delta, delta);
+                max_delta = std::max(max_delta, delta);
+            }
+            range = static_cast<std::uint64_t>(max_delta) - static_cast<std::uint64_t>(min_delta);
+        }
+        int width = byteWidth(range);
+
+        putBytes(out, static_cast<std::uint64_t>(column[0]), 8);
+        putBytes(out, static_cast<std::uint64_t>(min_delta), 8);
+        *out++ = static_cast<unsigned char>(width);
+
+        if (width > 0)
+        {
+            for (int r = 1; r < rows; r++)
+            {
+                std::uint64_t delta = static_cast<std::uint64_t>(column[r]) - static_cast<std::uint64_t>(column[r - 1]);
+                putBytes(out, delta - static_cast<std::uint64_t>(min_delta), width);
+            }
+        }
+    }
+
+    std::streamsize size = out - block.data();
+    file.write(reinterpret_cast<const char *>(block.data()), size);
+    bytes_written += size;
+    rows = 0;
+}
+
+void BinaryLogWriter::flush()
+{
+    writeBlock();
+    if (file.is_open())
+        file.flush();
+}
+
+bool BinaryLogReader::open(const std::string &filename)
+{
+    columns.clear();
+    file.close();
+    file.clear();
+    file.open(filename, std::ios::in | std::ios::binary);
+    if (!file.is_open())
+        return false;
+
+    char magic[sizeof(LOG_MAGIC)];
+    unsigned char counts[4];
+    if (!file.read(magic, sizeof(magic)) || std::memcmp(magic, LOG_MAGIC, sizeof(LOG_MAGIC)) != 0)
+        return false;
+    if (!file.read(reinterpret_cast<char *>(counts), sizeof(counts)))
+        return false;
+
+    const unsigned char *in = counts;
+    std::uint16_t version = static_cast<std::uint16_t>(getBytes(in, 2));
+    std::uint16_t column_count = static_cast<std::uint16_t>(getBytes(in, 2));
+    if (version != LOG_VERSION)
+        return false;
+
+    for (int c = 0; c < column_count; c++)
+    {
+        unsigned char descriptor[2];
+        if (!file.read(reinterpret_cast<char *>(descriptor), sizeof(descriptor)))
+            return false;
+
+        LogColumn column;
+        column.kind = static_cast<LogColumnKind>(descriptor[0]);
+        column.name.resize(descriptor[1]);
+        if (!file.read(&column.name[0], descriptor[1]))
+            return false;
+        columns.push_back(column);
+    }
+
+    return true;
+}
+
+int BinaryLogReader::readBlock(std::vector<std::vector<std::int64_t>> &values)
+{
+    unsigned char count_bytes[4];
+    if (!file.read(reinterpret_cast<char *>(count_bytes), sizeof(count_bytes)))
+        return 0;
+
+    const unsigned char *in = count_bytes;
+    std::uint32_t rows = static_cast<std::uint32_t>(getBytes(in, 4));
+    if (rows == 0 || rows > static_cast<std::uint32_t>(BinaryLogWriter::BLOCK_ROWS))
+        return -1;
+
+    values.resize(columns.size());
+    std::vector<unsigned char> data;
+
+    for (size_t c = 0; c < columns.size(); c++)
+    {
+        unsigned char prefix[COLUMN_PREFIX_BYTES];
+        if (!file.read(reinterpret_cast<char *>(prefix), sizeof(prefix)))
+            return -1;
+
+        in = prefix;
+        std::uint64_t value = getBytes(in, 8);
+        std::uint64_t min_delta = getBytes(in, 8);
+        int width = *in;
+        if (width != 0 && width != 1 && width != 2 && width != 4 && width != 8)
+            return -1;
+
+        data.resize(static_cast<size_t>(rows - 1) * width);
+        if (!data.empty() && !file.read(reinterpret_cast<char *>(data.data()), data.size()))
+            return -1;
+
+        std::vector<std::int64_t> &column = values[c];
+        column.resize(rows);
+        column[0] = static_cast<std::int64_t>(value);
+
+        in = data.data();
+        for (std::uint32_t r = 1; r < rows; r++)
+        {
+            value += min_delta + getBytes(in, width);
+            column[r] = static_cast<std::int64_t>(value);
+        }
+    }
+
+    return static_cast<int>(rows);
+}
+
+double BinaryLogReader::toDouble(LogColumnKind kind, std::int64_t value)
+{
+    switch (kind)
+    {
+    case LogColumnKind::FIXED2:
+        return value / 100.0;
+    case LogColumnKind::FLOAT64:
+    {
+        double decoded;
+        std::memcpy(&decoded, &value, sizeof(decoded));
+        return decoded;
+    }
+    default:
+        return static_cast<double>(value);
+    }
+}
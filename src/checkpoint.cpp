@@ -0,0 +1,91 @@
+#include "../include/checkpoint.hpp"
+#include <cstddef>
+#include <fstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const char CHECKPOINT_MAGIC[8] = {'T', 'S', 'I', 'M', 'C', 'K', 'P', '1'};
+static constexpr std::uint32_t CHECKPOINT_VERSION = 6;
+
+struct CheckpointHeader
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t reserved;
+    std::uint64_t payload_bytes;
+};
+
+CheckpointWriter::CheckpointWriter()
+{
+    CheckpointHeader header = {};
+    std::memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+    header.version = CHECKPOINT_VERSION;
+    put(header);
+}
+
+const std::vector<char> &CheckpointWriter::finish()
+{
+    std::uint64_t payload_bytes = bytes.size() - sizeof(CheckpointHeader);
+    std::memcpy(bytes.data() + offsetof(CheckpointHeader, payload_bytes), &payload_bytes, sizeof(payload_bytes));
+    return bytes;
+}
+
+bool CheckpointWriter::writeFile(const std::string &filename)
+{
+    const std::vector<char> &contents = finish();
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+        return false;
+    file.write(contents.data(), contents.size());
+    return static_cast<bool>(file);
+}
+
+CheckpointReader::CheckpointReader(const char *bytes, size_t length)
+    : data(bytes), size(length), offset(0), failed(false)
+{
+    CheckpointHeader header = get<CheckpointHeader>();
+    if (failed || std::memcmp(header.magic, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC)) != 0 ||
+        header.version != CHECKPOINT_VERSION || header.payload_bytes != size - offset)
+    {
+        failed = true;
+    }
+}
+
+MappedCheckpoint::~MappedCheckpoint()
+{
+    if (data != nullptr)
+        munmap(const_cast<char *>(data), size);
+}
+
+bool MappedCheckpoint::open(const std::string &filename)
+{
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(CheckpointHeader)))
+    {
+        ::close(fd);
+        return false;
+    }
+
+    void *mapping = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED)
+        return false;
+
+    data = static_cast<const char *>(mapping);
+    size = static_cast<size_t>(info.st_size);
+
+    if (!CheckpointReader(data, size).ok())
+    {
+        munmap(mapping, size);
+        data = nullptr;
+        size = 0;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,955 @@
+#include "../include/driver.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+#ifdef USE_MPI
+#include <mpi.h>
+#endif
+
+#include "../include/thread_pool.hpp"
+#include "../include/ensemble_stats.hpp"
+#include "../include/replay.hpp"
+#include "../include/sweep.hpp"
+
+void printHelp(bool interactive)
+{
+    std::cout << "Algorithmic Trading Simulator\n\n";
+    if (interactive)
+    {
+        std::cout << "Usage: tradingSim [options]\n\n";
+        std::cout << "Standard TUI Mode (default):\n";
+    }
+    else
+    {
+        std::cout << "Usage: tradingSim_headless [options]\n\n";
+        std::cout << "Simulation Options (without -E, --sweep or --replay: one headless run, as -E 1):\n";
+    }
+    std::cout << "  -t, --traders <num>     Number of trader agents (default: 12)\n";
+    std::cout << "  -d, --duration <sec>    Simulation duration in seconds (default: 60)\n";
+    std::cout << "  -p, --price <value>     Initial asset price (default: 170.0)\n";
+    std::cout << "  -c, --cash <value>      Initial cash per trader (default: 10000.0)\n";
+    std::cout << "  -s, --speed <scale>     Time scale multiplier (default: 1.0)\n";
+    std::cout << "  --book <map|tick>       Order book implementation (default: map)\n";
+    std::cout << "  --tick-size <value>     Price tick for the tick book (default: 0.01)\n";
+    std::cout << "  --matching <mode>       continuous | batch (uniform-price auction per step)\n";
+    std::cout << "  --order-ttl <sec>       Agent orders expire after this much simulation time (default: 10, 0 = never)\n";
+    std::cout << "  --log-format <fmt>      csv | binary (.tslog trades/prices, see tslog2csv)\n";
+    std::cout << "  --async-log <policy>    Write logs on a background thread; block | drop | grow when full\n";
+    std::cout << "  --log-orders            Also log every submitted order (orders.csv / orders.tslog, input for --replay)\n";
+    std::cout << "  --feed <name>           Publish quotes, depth and trades each step to shared memory /<name> (see feedtail)\n";
+    std::cout << "  --activation <mode>     poll (every trader decides each step) | event (only woken traders decide)\n";
+    std::cout << "  --wake-interval <sec>   Event mode: mean time between a trader's Poisson wake-ups (default: 5, 0 = none)\n";
+    std::cout << "  --wake-band <frac>      Event mode: wake once the price moves this fraction from the last decision (default: 0.02)\n";
+    std::cout << "  --profile               Time each step phase and report p50/p99/max and work counters\n";
+    std::cout << "  --exec <mode>           auto (cost model picks serial/parallel per phase) | serial | parallel\n";
+    std::cout << "  --load-checkpoint <f>   Start from a saved checkpoint (book type comes from the file)\n";
+    std::cout << "  -h, --help              Show this help message\n\n";
+    std::cout << "Ensemble (Headless) Mode:\n";
+    std::cout << "  -E, --ensemble <N>      Run N simulations headlessly (disables TUI)\n";
+    std::cout << "  --seed <S>              Base seed for ensemble runs (default: 12345)\n";
+    std::cout << "  -J, --sim-threads <K>   Simulations run concurrently per rank (default: 1, 0 = all cores)\n";
+    std::cout << "  --schedule <mode>       static (even split) | dynamic (ranks pull chunks of sims)\n";
+    std::cout << "  --chunk <C>             Sims claimed per fetch with dynamic scheduling\n";
+    std::cout << "  --soa                   Store traders as strategy-grouped arrays (large populations)\n";
+    std::cout << "  --instruments <N>       Symbols per simulation, each book stepped on its own thread (default: 1)\n";
+    std::cout << "  --warmup <sec>          Run one shared warm-up on rank 0, broadcast it, and fork every sim from it\n";
+    std::cout << "  --save-checkpoint <f>   Write the shared warm start (after --warmup / --load-checkpoint) to a file\n\n";
+    std::cout << "Sweep Mode:\n";
+    std::cout << "  --sweep <file>          Run a grid of configs (key=v1,v2 lines, see README) in one launch, -E seeds\n";
+    std::cout << "                          each (default 1), over the ranks and -J threads with the ensemble scheduling\n";
+    std::cout << "  --sweep-out <file>      Results table, one CSV row per config (default: sweep_results.csv)\n\n";
+    std::cout << "Replay Mode:\n";
+    std::cout << "  --replay <file>         Feed an orders or trades log (CSV or .tslog) through a fresh book at full\n";
+    std::cout << "                          speed and report throughput and match latency (uses --book/--matching)\n";
+    std::cout << "  --replay-out <dir>      Log the replayed trades to <dir> for diffing against the recording\n\n";
+    if (interactive)
+    {
+        std::cout << "Example (TUI):\n";
+        std::cout << "  ./tradingSim -t 20 -d 120 -s 2.0\n";
+    }
+    std::cout << "Example (Ensemble):\n";
+    std::cout << "  mpiexec -n 4 ./tradingSim -E 100 --seed 42\n";
+    std::cout << "Example (Sweep):\n";
+    std::cout << "  mpiexec -n 4 ./tradingSim --sweep grid.txt -E 10 -J 0 --schedule dynamic\n\n";
+}
+Config parseArguments(int argc, char *argv[])
+{
+    Config config;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "-h" || arg == "--help")
+        {
+            config.show_help = true;
+            return config;
+        }
+        else if ((arg == "-t" || arg == "--traders") && i + 1 < argc)
+        {
+            config.num_traders = std::stoi(argv[++i]);
+        }
+        else if ((arg == "-d" || arg == "--duration") && i + 1 < argc)
+        {
+            config.duration_seconds = std::stoi(argv[++i]);
+        }
+        else if ((arg == "-p" || arg == "--price") && i + 1 < argc)
+        {
+            config.initial_price = std::stod(argv[++i]);
+        }
+        else if ((arg == "-c" || arg == "--cash") && i + 1 < argc)
+        {
+            config.initial_cash = std::stod(argv[++i]);
+        }
+        else if ((arg == "-s" || arg == "--speed") && i + 1 < argc)
+        {
+            config.time_scale = std::stod(argv[++i]);
+            if (config.time_scale <= 0.0)
+                config.time_scale = 1.0;
+        }
+        else if ((arg == "-E" || arg == "--ensemble") && i + 1 < argc)
+        {
+            config.ensemble_count = std::stoi(argv[++i]);
+        }
+        else if ((arg == "-J" || arg == "--sim-threads") && i + 1 < argc)
+        {
+            config.sim_threads = std::stoi(argv[++i]);
+        }
+        else if ((arg == "--schedule") && i + 1 < argc)
+        {
+            config.dynamic_schedule = (std::string(argv[++i]) == "dynamic");
+        }
+        else if ((arg == "--chunk") && i + 1 < argc)
+        {
+            config.chunk_size = std::max(0, std::stoi(argv[++i]));
+        }
+        else if ((arg == "--seed") && i + 1 < argc)
+        {
+            config.base_seed = std::stoul(argv[++i]);
+        }
+        else if ((arg == "--book") && i + 1 < argc)
+        {
+            std::string book = argv[++i];
+            config.book_type = (book == "tick") ? OrderBookType::TICK : OrderBookType::MAP;
+        }
+        else if ((arg == "--tick-size") && i + 1 < argc)
+        {
+            config.tick_size = std::stod(argv[++i]);
+            if (config.tick_size <= 0.0)
+                config.tick_size = 0.01;
+        }
+        else if ((arg == "--order-ttl") && i + 1 < argc)
+        {
+            config.order_lifetime = std::stod(argv[++i]);
+            if (config.order_lifetime < 0.0)
+                config.order_lifetime = 0.0;
+        }
+        else if ((arg == "--matching") && i + 1 < argc)
+        {
+            std::string mode = argv[++i];
+            config.matching_mode = (mode == "batch") ? MatchingMode::BATCH_AUCTION : MatchingMode::CONTINUOUS;
+        }
+        else if ((arg == "--log-format") && i + 1 < argc)
+        {
+            std::string format = argv[++i];
+            config.log_format = (format == "binary") ? LogFormat::BINARY : LogFormat::CSV;
+        }
+        else if ((arg == "--async-log") && i + 1 < argc)
+        {
+            std::string policy = argv[++i];
+            config.async_log = true;
+            if (policy == "drop")
+                config.log_backpressure = LogBackpressure::DROP;
+            else if (policy == "grow")
+                config.log_backpressure = LogBackpressure::GROW;
+            else
+                config.log_backpressure = LogBackpressure::BLOCK;
+        }
+        else if ((arg == "--instruments") && i + 1 < argc)
+        {
+            config.instruments = std::max(1, std::stoi(argv[++i]));
+        }
+        else if ((arg == "--warmup") && i + 1 < argc)
+        {
+            config.warmup_seconds = std::max(0.0, std::stod(argv[++i]));
+        }
+        else if ((arg == "--load-checkpoint") && i + 1 < argc)
+        {
+            config.load_checkpoint = argv[++i];
+        }
+        else if ((arg == "--save-checkpoint") && i + 1 < argc)
+        {
+            config.save_checkpoint = argv[++i];
+        }
+        else if (arg == "--log-orders")
+        {
+            config.log_orders = true;
+        }
+        else if ((arg == "--feed") && i + 1 < argc)
+        {
+            config.market_feed = argv[++i];
+        }
+        else if ((arg == "--replay") && i + 1 < argc)
+        {
+            config.replay_file = argv[++i];
+        }
+        else if ((arg == "--replay-out") && i + 1 < argc)
+        {
+            config.replay_output_dir = argv[++i];
+        }
+        else if ((arg == "--sweep") && i + 1 < argc)
+        {
+            config.sweep_file = argv[++i];
+        }
+        else if ((arg == "--sweep-out") && i + 1 < argc)
+        {
+            config.sweep_output = argv[++i];
+        }
+        else if ((arg == "--activation") && i + 1 < argc)
+        {
+            std::string mode = argv[++i];
+            config.activation.mode = (mode == "event") ? ActivationMode::EVENT : ActivationMode::POLL;
+        }
+        else if ((arg == "--wake-interval") && i + 1 < argc)
+        {
+            config.activation.mean_interval = std::max(0.0, std::stod(argv[++i]));
+        }
+        else if ((arg == "--wake-band") && i + 1 < argc)
+        {
+            config.activation.price_band = std::max(0.0, std::stod(argv[++i]));
+        }
+        else if (arg == "--profile")
+        {
+            config.profile = true;
+        }
+        else if ((arg == "--exec") && i + 1 < argc)
+        {
+            std::string mode = argv[++i];
+            if (mode == "serial")
+                config.exec_strategy = ExecutionStrategy::SERIAL;
+            else if (mode == "parallel")
+                config.exec_strategy = ExecutionStrategy::PARALLEL;
+            else
+                config.exec_strategy = ExecutionStrategy::AUTO;
+        }
+        else if (arg == "--soa")
+        {
+            config.population_layout = PopulationLayout::SOA;
+        }
+    }
+    return config;
+}
+
+void printStepProfile(const StepProfileSummary &profile, std::ostream &out)
+{
+    const StepCounters &counters = profile.counters;
+    out << "  Steps: " << counters.steps << ", Orders: " << counters.orders
+        << ", Rejected: " << counters.rejected << ", Expired: " << counters.expired << ", Trades: " << counters.trades << ", Unsettled: " << counters.unsettled << ", Decisions: " << counters.decisions << ", Levels touched: " << counters.levels_touched
+        << ", Allocations: " << counters.allocations << "\n";
+
+    if (!profile.enabled)
+        return;
+
+    out << "  " << std::left << std::setw(14) << "phase" << std::right
+        << std::setw(12) << "total ms" << std::setw(10) << "p50 us"
+        << std::setw(10) << "p99 us" << std::setw(10) << "max us" << "\n";
+    out << std::fixed << std::setprecision(1);
+    for (int i = 0; i < STEP_PHASE_COUNT; i++)
+    {
+        const PhaseSummary &phase = profile.phases[i];
+        out << "  " << std::left << std::setw(14) << stepPhaseName(static_cast<StepPhase>(i)) << std::right
+            << std::setw(12) << phase.total_us / 1000.0 << std::setw(10) << phase.p50_us
+            << std::setw(10) << phase.p99_us << std::setw(10) << phase.max_us << "\n";
+    }
+
+    // The process-wide cost model the OpenMP regions were gated on
+    const ExecutionPolicy &execution = ExecutionPolicy::instance();
+    out << "  Fork/join " << execution.getForkJoinCost() / 1000.0 << " us; ns/item + region us:";
+    for (int i = 0; i < PARALLEL_PHASE_COUNT; i++)
+    {
+        ParallelPhase phase = static_cast<ParallelPhase>(i);
+        out << " " << parallelPhaseName(phase) << " " << execution.getItemCost(phase)
+            << " + " << execution.getOverhead(phase) / 1000.0;
+    }
+    out << "\n";
+}
+
+// Shared ensemble starting point on rank 0: the --load-checkpoint state
+// and/or --warmup seconds stepped on the base seed. Empty on failure.
+static std::vector<char> buildWarmStart(const Config &config)
+{
+    TradingSimulation sim(config.num_traders, config.initial_price, config.initial_cash, config.base_seed,
+                          config.population_layout);
+    sim.setTimeScale(config.time_scale);
+    sim.setOrderBookType(config.book_type, config.tick_size);
+    sim.setMatchingMode(config.matching_mode);
+    sim.setOrderLifetime(config.order_lifetime);
+    sim.setInstrumentCount(config.instruments);
+    sim.setActivation(config.activation);
+
+    if (!config.load_checkpoint.empty() && !sim.loadCheckpoint(config.load_checkpoint))
+    {
+        std::cerr << "Error: cannot load checkpoint '" << config.load_checkpoint
+                  << "' (missing, corrupt, or saved with another trader count / --soa setting)\n";
+        return {};
+    }
+
+    if (config.warmup_seconds > 0.0)
+    {
+        std::cout << "Warm-up: " << config.warmup_seconds << "s on seed " << config.base_seed << "..." << std::endl;
+        sim.runHeadless(config.warmup_seconds);
+    }
+
+    CheckpointWriter out;
+    sim.saveState(out);
+    if (!config.save_checkpoint.empty())
+    {
+        if (out.writeFile(config.save_checkpoint))
+            std::cout << "Checkpoint written to " << config.save_checkpoint << "\n";
+        else
+            std::cerr << "Warning: could not write checkpoint '" << config.save_checkpoint << "'\n";
+    }
+    return out.finish();
+}
+
+// --replay: one book driven from a recorded log, no traders or market.
+// Returns the process exit code.
+static int runReplay(const Config &config)
+{
+    OrderFlowReader reader;
+    if (!reader.open(config.replay_file))
+    {
+        std::cerr << "Error: cannot replay '" << config.replay_file
+                  << "' (missing, or not an orders/trades log in CSV or .tslog form)\n";
+        return 1;
+    }
+
+    std::unique_ptr<OrderBook> book = createOrderBook(config.book_type, config.tick_size);
+    book->setMatchingMode(config.matching_mode);
+
+    std::unique_ptr<DataLogger> trade_log;
+    if (!config.replay_output_dir.empty())
+    {
+        trade_log = std::make_unique<DataLogger>(config.replay_output_dir);
+        trade_log->setFormat(config.log_format);
+        trade_log->initialize(false, 0, 1, -1);
+    }
+
+    bool orders_log = reader.getFormat() == OrderFlowFormat::ORDERS;
+    std::cout << "=== Replay ===\n"
+              << "Input: " << config.replay_file << (orders_log ? " (orders log)" : " (trades log, one crossing pair per trade)") << "\n"
+              << "Book: " << (config.book_type == OrderBookType::TICK ? "tick" : "map")
+              << ", " << (config.matching_mode == MatchingMode::BATCH_AUCTION ? "batch" : "continuous") << " matching\n";
+
+    ReplayResult result = replayOrderFlow(reader, *book, trade_log.get());
+    if (!result.ok)
+        std::cerr << "Error: malformed row after " << reader.getRowsRead() << " rows, replay stopped there\n";
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "Rounds: " << result.rounds << ", Orders: " << result.orders << ", Trades: " << result.trades
+              << ", Volume: $" << result.volume << "\n";
+    std::cout << "Wall time: " << std::setprecision(3) << result.wall_seconds * 1000.0 << " ms (book "
+              << result.book_seconds * 1000.0 << " ms), " << std::setprecision(0)
+              << result.ordersPerSecond() << " orders/sec through the book\n";
+    std::cout << std::setprecision(1) << "Match latency per round: p50 " << result.match_latency.percentile(0.50) / 1000.0
+              << " us, p99 " << result.match_latency.percentile(0.99) / 1000.0
+              << " us, max " << result.match_latency.getMax() / 1000.0 << " us\n";
+    std::cout << std::setprecision(2) << "Final book: " << book->getBuyOrderCount() << " bids / "
+              << book->getSellOrderCount() << " asks, best $" << book->getBestBid() << " / $" << book->getBestAsk() << "\n";
+    std::cout << "Trade checksum: " << std::hex << std::setw(16) << std::setfill('0') << result.trade_checksum
+              << std::dec << std::setfill(' ') << "\n";
+    if (trade_log)
+        std::cout << "Replayed trades logged to " << config.replay_output_dir << "/\n";
+
+    return result.ok ? 0 : 1;
+}
+
+ProcessGroup::ProcessGroup(int &argc, char **&argv)
+    : rank_index(0), rank_count(1)
+{
+#ifdef USE_MPI
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank_index);
+    MPI_Comm_size(MPI_COMM_WORLD, &rank_count);
+#else
+    (void)argc;
+    (void)argv;
+#endif
+}
+
+ProcessGroup::~ProcessGroup()
+{
+#ifdef USE_MPI
+    MPI_Finalize();
+#endif
+}
+
+#ifdef USE_MPI
+// MPI reduction op over EnsembleAccumulator blocks: inout = in (lower ranks) merged with inout
+static void mergeSummaries(void *in, void *inout, int *len, MPI_Datatype *)
+{
+    for (int i = 0; i < *len; i++)
+    {
+        EnsembleAccumulator left;
+        EnsembleAccumulator right;
+        std::memcpy(&left, static_cast<char *>(in) + i * sizeof(EnsembleAccumulator), sizeof(left));
+        std::memcpy(&right, static_cast<char *>(inout) + i * sizeof(EnsembleAccumulator), sizeof(right));
+        left.merge(right);
+        std::memcpy(static_cast<char *>(inout) + i * sizeof(EnsembleAccumulator), &left, sizeof(left));
+    }
+}
+#endif
+
+// Rank 0's bytes to every rank
+static void broadcastBytes(void *data, size_t bytes)
+{
+#ifdef USE_MPI
+    MPI_Bcast(data, static_cast<int>(bytes), MPI_BYTE, 0, MPI_COMM_WORLD);
+#else
+    (void)data;
+    (void)bytes;
+#endif
+}
+
+// Merge every rank's count accumulators element-wise into rank 0's result.
+// The blocks travel as opaque bytes; the op is declared non-commutative so
+// MPI combines ranks in rank order and the result does not depend on the
+// reduction tree.
+static void reduceSummaries(const EnsembleAccumulator *local, EnsembleAccumulator *result, int count)
+{
+#ifdef USE_MPI
+    MPI_Datatype summary_type;
+    MPI_Type_contiguous(sizeof(EnsembleAccumulator), MPI_BYTE, &summary_type);
+    MPI_Type_commit(&summary_type);
+    MPI_Op merge_op;
+    MPI_Op_create(mergeSummaries, 0, &merge_op);
+
+    MPI_Reduce(local, result, count, summary_type, merge_op, 0, MPI_COMM_WORLD);
+
+    MPI_Op_free(&merge_op);
+    MPI_Type_free(&summary_type);
+#else
+    std::copy(local, local + count, result);
+#endif
+}
+
+// Element-wise sums over the ranks into rank 0's result
+static void reduceSums(const double *local, double *result, int count)
+{
+#ifdef USE_MPI
+    MPI_Reduce(local, result, count, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+#else
+    std::copy(local, local + count, result);
+#endif
+}
+
+// Shared next-job counter on rank 0, claimed with one-sided fetch-and-add
+class JobCounter
+{
+private:
+    int next_index;
+#ifdef USE_MPI
+    MPI_Win window;
+#endif
+
+public:
+    explicit JobCounter(int mpi_rank)
+        : next_index(0)
+    {
+#ifdef USE_MPI
+        MPI_Win_create(&next_index, mpi_rank == 0 ? sizeof(int) : 0, sizeof(int),
+                       MPI_INFO_NULL, MPI_COMM_WORLD, &window);
+#else
+        (void)mpi_rank;
+#endif
+    }
+
+    ~JobCounter()
+    {
+#ifdef USE_MPI
+        MPI_Win_free(&window);
+#endif
+    }
+
+    JobCounter(const JobCounter &) = delete;
+    JobCounter &operator=(const JobCounter &) = delete;
+
+    // First of the next count jobs
+    int claim(int count)
+    {
+#ifdef USE_MPI
+        int first = 0;
+        MPI_Win_lock(MPI_LOCK_SHARED, 0, 0, window);
+        MPI_Fetch_and_op(&count, &first, MPI_INT, 0, 0, MPI_SUM, window);
+        MPI_Win_unlock(0, window);
+        return first;
+#else
+        int first = next_index;
+        next_index += count;
+        return first;
+#endif
+    }
+};
+
+// Run jobs [0, n) over every rank, K at a time per rank with a pool: an even
+// split of the range, or with --schedule dynamic chunks claimed off a shared
+// counter on rank 0. Each packet goes to deliver on this thread: right after
+// its job when sequential, after each batch with a pool. Collective.
+static void distributeJobs(const Config &config, int n, int mpi_rank, int mpi_size, ThreadPool *pool,
+                           const std::function<SimulationSummaryPacket(int)> &run_job,
+                           const std::function<void(const SimulationSummaryPacket &)> &deliver)
+{
+    // Run jobs [first, first + count)
+    auto run_batch = [&](int first, int count)
+    {
+        if (!pool)
+        {
+            for (int i = 0; i < count; i++)
+            {
+                deliver(run_job(first + i));
+            }
+            return;
+        }
+
+        std::vector<SimulationSummaryPacket> results(count);
+        for (int i = 0; i < count; i++)
+        {
+            pool->submit([&run_job, &results, first, i]
+                         { results[i] = run_job(first + i); });
+        }
+        pool->wait();
+
+        for (const auto &packet : results)
+        {
+            deliver(packet);
+        }
+    };
+
+    if (config.dynamic_schedule)
+    {
+        JobCounter counter(mpi_rank);
+        int chunk = config.chunk_size > 0 ? config.chunk_size : (pool ? pool->size() : 1);
+
+        while (true)
+        {
+            int first = counter.claim(chunk);
+            if (first >= n)
+                break;
+
+            run_batch(first, std::min(chunk, n - first));
+        }
+    }
+    else
+    {
+        int base_jobs = n / mpi_size;
+        int extra_jobs = n % mpi_size;
+        int jobs_for_this_rank = base_jobs + (mpi_rank < extra_jobs ? 1 : 0);
+        int start_index = (mpi_rank * base_jobs) + std::min(mpi_rank, extra_jobs);
+
+        run_batch(start_index, jobs_for_this_rank);
+    }
+}
+
+// Print the ensemble summary from rank 0's accumulated results
+static void printEnsembleSummary(const EnsembleAccumulator &summary, const Config &config, int mpi_size)
+{
+    const SimulationSummaryPacket &best = summary.getBest();
+    const SimulationSummaryPacket &worst = summary.getWorst();
+
+    std::cout << "\n=======================================================\n";
+    std::cout << "              ENSEMBLE SUMMARY STATISTICS             \n";
+    std::cout << "=======================================================\n\n";
+
+    std::cout << "Total Simulations: " << config.ensemble_count << "\n";
+    std::cout << "MPI Processes Used: " << mpi_size << "\n\n";
+
+    std::cout << "--- AGGREGATE METRICS ---\n";
+    std::cout << "Grand Total Trades: " << summary.getTotalTrades() << "\n";
+    std::cout << "Grand Total Volume: $" << std::fixed << std::setprecision(2) << summary.getTotalVolume() << "\n\n";
+
+    std::cout << "--- AVERAGE PER SIMULATION ---\n";
+    std::cout << "Avg Trades: " << std::fixed << std::setprecision(2) << summary.getMeanTrades()
+              << " (±" << summary.getStddevTrades() << ")\n";
+    std::cout << "Avg Volume: $" << summary.getMeanVolume()
+              << " (±$" << summary.getStddevVolume() << ")\n";
+    std::cout << "Avg Price: $" << summary.getMeanPrice() << "\n";
+    std::cout << "Avg Volatility: $" << summary.getMeanVolatility() << "\n\n";
+
+    std::cout << "--- BEST SIMULATION ---\n";
+    std::cout << "Sim Index: " << best.simulation_index << "\n";
+    std::cout << "Volume: $" << best.stats.total_volume << "\n";
+    std::cout << "Trades: " << best.stats.total_trades << "\n";
+    std::cout << "Avg Price: $" << best.stats.avg_price << "\n";
+    std::cout << "Volatility: $" << best.stats.price_volatility << "\n";
+
+    std::cout << "\n--- WORST SIMULATION ---\n";
+    std::cout << "Sim Index: " << worst.simulation_index << "\n";
+    std::cout << "Volume: $" << worst.stats.total_volume << "\n";
+    std::cout << "Trades: " << worst.stats.total_trades << "\n";
+    std::cout << "Avg Price: $" << worst.stats.avg_price << "\n";
+    std::cout << "Volatility: $" << worst.stats.price_volatility << "\n";
+
+    // Sketch estimates; exact for small ensembles, within a fraction of a percent of rank beyond
+    static const double PERCENTILES[] = {0.05, 0.25, 0.50, 0.75, 0.95};
+    std::cout << "\n--- PERCENTILES (p5 / p25 / p50 / p75 / p95) ---\n";
+    auto print_row = [](const char *label, const char *unit, auto quantile)
+    {
+        std::cout << label;
+        for (size_t i = 0; i < std::size(PERCENTILES); i++)
+            std::cout << (i ? " / " : " ") << unit << quantile(PERCENTILES[i]);
+        std::cout << "\n";
+    };
+    print_row("Trades:", "", [&](double q) { return summary.getTradesQuantile(q); });
+    print_row("Volume:", "$", [&](double q) { return summary.getVolumeQuantile(q); });
+    print_row("Volatility:", "$", [&](double q) { return summary.getVolatilityQuantile(q); });
+
+    std::cout << "\n=======================================================\n";
+    std::cout << "Ensemble run complete. CSV logs saved to 'logs/' directory.\n";
+    std::cout << "Each simulation has separate CSV files with naming pattern:\n";
+    std::cout << "  trades_sim<N>_rank<R>.csv\n";
+    std::cout << "  prices_sim<N>_rank<R>.csv\n";
+    std::cout << "  trader_stats_sim<N>_rank<R>.csv\n";
+    std::cout << "  order_book_sim<N>_rank<R>.csv\n";
+    std::cout << "=======================================================\n";
+}
+
+// A worker's simulation, kept between sweep jobs of one config and
+// restarted from that config's fresh state for each further seed
+struct SweepWorker
+{
+    int point = -1;
+    bool busy = false;
+    std::unique_ptr<TradingSimulation> sim;
+    std::vector<char> fresh_state;
+};
+
+// --sweep: every config in the file times -E seeds as one job list, spread
+// over the ranks and pool like an ensemble. Config c's seeds are jobs
+// c * seeds .. c * seeds + seeds - 1 on seeds base_seed + 0 .. seeds - 1, so
+// configs are compared on common random numbers, and consecutive jobs of a
+// config reuse one simulation instead of rebuilding it. Returns the exit
+// code; collective.
+static int runSweep(const Config &config, int mpi_rank, int mpi_size)
+{
+    if (config.warmup_seconds > 0.0 || !config.load_checkpoint.empty())
+    {
+        if (mpi_rank == 0)
+            std::cerr << "Error: --warmup and --load-checkpoint do not apply to --sweep (every config starts cold)\n";
+        return 1;
+    }
+
+    SweepPoint defaults;
+    defaults.num_traders = config.num_traders;
+    defaults.initial_price = config.initial_price;
+    defaults.initial_cash = config.initial_cash;
+    defaults.time_scale = config.time_scale;
+    defaults.duration_seconds = config.duration_seconds;
+    defaults.book_type = config.book_type;
+    defaults.tick_size = config.tick_size;
+    defaults.matching_mode = config.matching_mode;
+    defaults.order_lifetime = config.order_lifetime;
+    defaults.population_layout = config.population_layout;
+    defaults.instruments = config.instruments;
+
+    // Parsed on rank 0 and broadcast, so errors are reported once
+    std::vector<SweepPoint> points;
+    std::uint64_t point_count = 0;
+    if (mpi_rank == 0 && loadSweepFile(config.sweep_file, defaults, points))
+    {
+        point_count = points.size();
+        if (point_count == 0)
+            std::cerr << "Error: sweep file '" << config.sweep_file << "' has no configs\n";
+    }
+    broadcastBytes(&point_count, sizeof(point_count));
+    if (point_count == 0)
+        return 1;
+    points.resize(point_count);
+    broadcastBytes(points.data(), point_count * sizeof(SweepPoint));
+
+    int seeds = std::max(1, config.ensemble_count);
+    int n = static_cast<int>(point_count) * seeds;
+    if (mpi_rank == 0)
+    {
+        std::cout << "=== Running Sweep Mode ===\n"
+                  << "Configs: " << point_count << " x " << seeds << " seeds = " << n << " simulations\n"
+                  << "MPI Processes: " << mpi_size << "\n"
+                  << "Scheduling: " << (config.dynamic_schedule ? "dynamic" : "static") << "\n"
+                  << "==========================\n";
+    }
+    auto sweep_start = std::chrono::steady_clock::now();
+
+    std::unique_ptr<ThreadPool> pool;
+    if (config.sim_threads != 1)
+        pool = std::make_unique<ThreadPool>(config.sim_threads);
+
+    // One per concurrent job; a job takes an idle one, preferring its config's
+    std::vector<SweepWorker> workers(pool ? pool->size() : 1);
+    std::mutex worker_mutex;
+    auto claim = [&](int point_index) -> SweepWorker &
+    {
+        std::lock_guard<std::mutex> lock(worker_mutex);
+        SweepWorker *chosen = nullptr;
+        for (auto &worker : workers)
+        {
+            if (!worker.busy && (!chosen || worker.point == point_index))
+                chosen = &worker;
+        }
+        chosen->busy = true;
+        return *chosen;
+    };
+
+    std::mutex output_mutex;
+    std::vector<double> local_seconds(point_count, 0.0);
+
+    auto run_job = [&](int job)
+    {
+        int point_index = job / seeds;
+        unsigned int sim_seed = config.base_seed + job % seeds;
+        const SweepPoint &point = points[point_index];
+        SweepWorker &worker = claim(point_index);
+        auto job_start = std::chrono::steady_clock::now();
+
+        if (worker.point != point_index)
+        {
+            // The old one goes first, closing its logs
+            worker.sim.reset();
+            worker.sim = std::make_unique<TradingSimulation>(point.num_traders, point.initial_price, point.initial_cash,
+                                                             sim_seed, point.population_layout);
+            TradingSimulation &sim = *worker.sim;
+            sim.setTimeScale(point.time_scale);
+            sim.setOrderBookType(point.book_type, point.tick_size);
+            sim.setMatchingMode(point.matching_mode);
+            sim.setOrderLifetime(point.order_lifetime);
+            sim.getLogger().setFormat(config.log_format);
+            sim.getLogger().setOrderLogging(config.log_orders);
+            sim.getLogger().initialize(true, mpi_rank, mpi_size, job);
+            sim.setInstrumentCount(point.instruments);
+            sim.setActivation(config.activation); // SoA or multi-symbol points refuse it and poll
+            if (config.async_log)
+                sim.getLogger().startAsync(config.log_backpressure);
+            sim.setProfiling(config.profile);
+
+            CheckpointWriter state;
+            sim.saveState(state);
+            worker.fresh_state = state.finish();
+            worker.point = point_index;
+        }
+        else
+        {
+            worker.sim->getLogger().initialize(true, mpi_rank, mpi_size, job);
+            worker.sim->restart(worker.fresh_state.data(), worker.fresh_state.size(), sim_seed);
+        }
+
+        SimulationStats stats = worker.sim->runHeadless(point.duration_seconds);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - job_start).count();
+
+        SimulationSummaryPacket packet;
+        packet.simulation_index = job;
+        packet.stats = stats;
+        {
+            std::lock_guard<std::mutex> lock(output_mutex);
+            local_seconds[point_index] += seconds;
+            std::cout << "[Rank " << mpi_rank << "] Finished sim " << job << " (config " << point_index
+                      << ", seed " << sim_seed << ", Trades: " << stats.total_trades
+                      << ", Volume: $" << std::fixed << std::setprecision(2) << stats.total_volume << ")" << std::endl;
+            if (config.profile)
+                printStepProfile(stats.profile, std::cout);
+        }
+
+        std::lock_guard<std::mutex> lock(worker_mutex);
+        worker.busy = false;
+        return packet;
+    };
+
+    std::vector<EnsembleAccumulator> local_results(point_count);
+    distributeJobs(config, n, mpi_rank, mpi_size, pool.get(), run_job,
+                   [&](const SimulationSummaryPacket &packet)
+                   { local_results[packet.simulation_index / seeds].add(packet); });
+    workers.clear();
+
+    // One accumulator per config, reduced element-wise in rank order
+    std::vector<EnsembleAccumulator> results(mpi_rank == 0 ? point_count : 0);
+    std::vector<double> wall_seconds(mpi_rank == 0 ? point_count : 0);
+    reduceSummaries(local_results.data(), results.data(), static_cast<int>(point_count));
+    reduceSums(local_seconds.data(), wall_seconds.data(), static_cast<int>(point_count));
+
+    if (mpi_rank != 0)
+        return 0;
+
+    double sweep_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - sweep_start).count();
+    std::cout << "\n=== SWEEP RESULTS ===\n";
+    for (size_t i = 0; i < point_count; i++)
+    {
+        std::cout << "Config " << i << ": " << describeSweepPoint(points[i]) << "\n"
+                  << "  Avg Trades: " << std::fixed << std::setprecision(2) << results[i].getMeanTrades()
+                  << " (±" << results[i].getStddevTrades() << "), Avg Volume: $" << results[i].getMeanVolume()
+                  << " (±$" << results[i].getStddevVolume() << "), Avg Volatility: $"
+                  << results[i].getMeanVolatility() << "\n";
+    }
+    std::cout << "Wall time: " << std::setprecision(3) << sweep_seconds << " s for " << n << " simulations\n";
+
+    if (!writeSweepResults(config.sweep_output, points, results, wall_seconds, seeds, config.base_seed))
+    {
+        std::cerr << "Error: could not write sweep results to '" << config.sweep_output << "'\n";
+        return 1;
+    }
+    std::cout << "Results table written to " << config.sweep_output << "\n";
+    return 0;
+}
+
+// Ensemble mode: -E seeds of one config
+static int runEnsemble(const Config &config, int mpi_rank, int mpi_size)
+{
+    int n = config.ensemble_count;
+    if (mpi_rank == 0)
+    {
+        std::cout << "=== Running Ensemble Mode ===\n"
+                  << "Total Simulations: " << n << "\n"
+                  << "MPI Processes: " << mpi_size << "\n"
+                  << "Scheduling: " << (config.dynamic_schedule ? "dynamic" : "static") << "\n"
+                  << "==============================\n";
+    }
+
+    // One warm start computed on rank 0 and broadcast, instead of every
+    // sim repeating the warm-up
+    std::vector<char> warm_start;
+    if (config.warmup_seconds > 0.0 || !config.load_checkpoint.empty())
+    {
+        std::uint64_t warm_bytes = 0;
+        if (mpi_rank == 0)
+        {
+            warm_start = buildWarmStart(config);
+            warm_bytes = warm_start.size();
+        }
+        broadcastBytes(&warm_bytes, sizeof(warm_bytes));
+        if (warm_bytes == 0)
+            return 1;
+        warm_start.resize(warm_bytes);
+        broadcastBytes(warm_start.data(), warm_bytes);
+    }
+
+    std::mutex output_mutex;
+
+    // One whole simulation with its own DataLogger
+    auto run_simulation = [&](int global_sim_index)
+    {
+        unsigned int sim_seed = config.base_seed + global_sim_index;
+        {
+            std::lock_guard<std::mutex> lock(output_mutex);
+            std::cout << "[Rank " << mpi_rank << "] Starting sim " << global_sim_index << " (seed " << sim_seed << ")..." << std::endl;
+        }
+
+        TradingSimulation sim(config.num_traders, config.initial_price, config.initial_cash, sim_seed,
+                              config.population_layout);
+        sim.setTimeScale(config.time_scale);
+        sim.setOrderBookType(config.book_type, config.tick_size);
+        sim.setMatchingMode(config.matching_mode);
+        sim.setOrderLifetime(config.order_lifetime);
+        sim.getLogger().setFormat(config.log_format);
+        sim.getLogger().setOrderLogging(config.log_orders);
+        sim.getLogger().initialize(true, mpi_rank, mpi_size, global_sim_index);
+        sim.setInstrumentCount(config.instruments);
+        sim.setActivation(config.activation);
+        if (!config.market_feed.empty())
+        {
+            // One feed per sim, numbered when there are several; a sim whose
+            // feed cannot be created still runs
+            std::string name = (n == 1) ? config.market_feed
+                                        : config.market_feed + "." + std::to_string(global_sim_index);
+            sim.openMarketFeed(name);
+        }
+        if (!warm_start.empty())
+        {
+            // Fork this variant: shared state, own RNG streams from here on
+            sim.loadCheckpoint(warm_start.data(), warm_start.size());
+            sim.reseed(sim_seed);
+            sim.setTimeScale(config.time_scale);
+            sim.setMatchingMode(config.matching_mode);
+        }
+        if (config.async_log)
+            sim.getLogger().startAsync(config.log_backpressure);
+        sim.setProfiling(config.profile);
+        SimulationStats stats = sim.runHeadless(config.duration_seconds);
+
+        SimulationSummaryPacket packet;
+        packet.simulation_index = global_sim_index;
+        packet.stats = stats;
+
+        std::lock_guard<std::mutex> lock(output_mutex);
+        std::cout << "[Rank " << mpi_rank << "] Finished sim " << global_sim_index
+                  << " (Trades: " << stats.total_trades
+                  << ", Volume: $" << std::fixed << std::setprecision(2) << stats.total_volume << ")" << std::endl;
+        if (config.profile)
+            printStepProfile(stats.profile, std::cout);
+        return packet;
+    };
+
+    // K simulations at a time, each single-threaded inside
+    std::unique_ptr<ThreadPool> pool;
+    if (config.sim_threads != 1)
+        pool = std::make_unique<ThreadPool>(config.sim_threads);
+
+    // Every rank folds its own sims into a local summary as they finish;
+    // one reduction then combines the ranks, so no rank ever holds
+    // per-simulation results
+    EnsembleAccumulator local_summary;
+    distributeJobs(config, n, mpi_rank, mpi_size, pool.get(), run_simulation,
+                   [&](const SimulationSummaryPacket &packet)
+                   { local_summary.add(packet); });
+
+    EnsembleAccumulator summary;
+    reduceSummaries(&local_summary, &summary, 1);
+
+    if (mpi_rank == 0)
+    {
+        printEnsembleSummary(summary, config, mpi_size);
+    }
+    return 0;
+}
+
+void prepareRun(const Config &config, const ProcessGroup &group)
+{
+    // Gate every OpenMP region on this machine's measured fork/join cost
+    ExecutionPolicy &execution = ExecutionPolicy::instance();
+    execution.setStrategy(config.exec_strategy);
+    execution.calibrate();
+
+    if (config.profile && !PROFILING_COMPILED && group.rank() == 0)
+    {
+        std::cout << "Note: built without TRADINGSIM_PROFILING, --profile reports counters only\n";
+    }
+}
+
+bool isBatchRun(const Config &config)
+{
+    return !config.replay_file.empty() || !config.sweep_file.empty() || config.ensemble_count > 0;
+}
+
+int runBatch(const Config &config, const ProcessGroup &group)
+{
+    if (!config.market_feed.empty() && (!config.replay_file.empty() || !config.sweep_file.empty()))
+    {
+        if (group.rank() == 0)
+            std::cerr << "Error: --feed applies to live simulations, not --replay or --sweep\n";
+        return 1;
+    }
+    if (config.activation.mode == ActivationMode::EVENT && config.sweep_file.empty() &&
+        (config.population_layout == PopulationLayout::SOA || config.instruments > 1))
+    {
+        if (group.rank() == 0)
+            std::cerr << "Error: --activation event needs the objects layout and one instrument (no --soa / --instruments)\n";
+        return 1;
+    }
+    if (!config.replay_file.empty())
+    {
+        // Single book, nothing to distribute
+        return (group.rank() == 0) ? runReplay(config) : 0;
+    }
+    if (!config.sweep_file.empty())
+        return runSweep(config, group.rank(), group.size());
+    return runEnsemble(config, group.rank(), group.size());
+}
@@ -0,0 +1,106 @@
+#include "../include/ensemble_stats.hpp"
+#include <cmath>
+
+void RunningMoments::add(double value, int simulation_index)
+{
+    count++;
+    double delta = value - mean;
+    mean += delta / count;
+    m2 += delta * (value - mean);
+
+    if (count == 1 || value < min)
+    {
+        min = value;
+        min_index = simulation_index;
+    }
+    if (count == 1 || value > max)
+    {
+        max = value;
+        max_index = simulation_index;
+    }
+}
+
+void RunningMoments::merge(const RunningMoments &other)
+{
+    if (other.count == 0)
+        return;
+    if (count == 0)
+    {
+        *this = other;
+        return;
+    }
+
+    long long combined = count + other.count;
+    double delta = other.mean - mean;
+    mean += delta * other.count / combined;
+    m2 += other.m2 + delta * delta * (static_cast<double>(count) * other.count / combined);
+    count = combined;
+
+    if (other.min < min)
+    {
+        min = other.min;
+        min_index = other.min_index;
+    }
+    if (other.max > max)
+    {
+        max = other.max;
+        max_index = other.max_index;
+    }
+}
+
+double RunningMoments::stddev() const
+{
+    return count ? std::sqrt(m2 / count) : 0.0;
+}
+
+EnsembleAccumulator::EnsembleAccumulator()
+    : count(0), total_trades(0), total_volume(0.0), sum_avg_price(0.0), sum_volatility(0.0)
+{
+}
+
+void EnsembleAccumulator::add(const SimulationSummaryPacket &packet)
+{
+    const SimulationStats &stats = packet.stats;
+
+    count++;
+    total_trades += stats.total_trades;
+    total_volume += stats.total_volume;
+    sum_avg_price += stats.avg_price;
+    sum_volatility += stats.price_volatility;
+
+    trades.add(stats.total_trades, packet.simulation_index);
+    volume.add(stats.total_volume, packet.simulation_index);
+    volatility.add(stats.price_volatility, packet.simulation_index);
+    trades_quantiles.add(stats.total_trades);
+    volume_quantiles.add(stats.total_volume);
+    volatility_quantiles.add(stats.price_volatility);
+
+    if (count == 1 || stats.total_volume > best.stats.total_volume)
+        best = packet;
+    if (count == 1 || stats.total_volume < worst.stats.total_volume)
+        worst = packet;
+}
+
+void EnsembleAccumulator::merge(const EnsembleAccumulator &other)
+{
+    if (other.count == 0)
+        return;
+
+    if (count == 0 || other.best.stats.total_volume > best.stats.total_volume)
+        best = other.best;
+    if (count == 0 || other.worst.stats.total_volume < worst.stats.total_volume)
+        worst = other.worst;
+
+    count += other.count;
+    total_trades += other.total_trades;
+    total_volume += other.total_volume;
+    sum_avg_price += other.sum_avg_price;
+    sum_volatility += other.sum_volatility;
+
+    trades.merge(other.trades);
+    volume.merge(other.volume);
+    volatility.merge(other.volatility);
+    trades_quantiles.merge(other.trades_quantiles);
+    volume_quantiles.merge(other.volume_quantiles);
+    volatility_quantiles.merge(other.volatility_quantiles);
+}
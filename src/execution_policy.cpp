@@ -0,0 +1,209 @@
+#include "../include/execution_policy.hpp"
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include <omp.h>
+
+// Used until calibrate() runs: a typical region on a few cores
+static constexpr double DEFAULT_FORK_JOIN_NS = 5000.0;
+
+// Starting per-item estimates, replaced by measurements as phases run
+static constexpr double DEFAULT_ITEM_NS[PARALLEL_PHASE_COUNT] = {
+    400.0,   // GENERATE: strategy decision and order for one Trader
+    3.0,     // POPULATION: one vectorised decision
+    20000.0, // INSTRUMENTS: a whole symbol step
+    15.0,    // SETTLE: one account update
+    800.0,   // TRADER_STATS: one formatted CSV row
+};
+
+// Phases whose items vary in cost run in dynamic batches
+static constexpr bool UNEVEN_ITEMS[PARALLEL_PHASE_COUNT] = {false, false, false, true, true};
+
+static constexpr int CALIBRATION_REGIONS = 33;
+static constexpr int CALIBRATION_WORK = 20000;       // Serial loop iterations between regions (~10-20 us)
+static constexpr double COST_SMOOTHING = 1.0 / 8.0;  // Weight of each new measurement
+static constexpr double OVERHEAD_RELAX = 1.0 / 64.0; // Pull towards fork/join per serial run
+
+// Serial stand-in for a step's work between regions
+static double calibrationWork()
+{
+    double sum = 0.0;
+    for (int i = 0; i < CALIBRATION_WORK; i++)
+        sum += i * 0.5;
+    return sum;
+}
+
+// Relaxed read-modify-write; concurrent callers may lose an update, which
+// only delays the estimate
+static void smooth(std::atomic<double> &value, double sample, double weight)
+{
+    double current = value.load(std::memory_order_relaxed);
+    value.store(current + (sample - current) * weight, std::memory_order_relaxed);
+}
+
+static long long nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+const char *parallelPhaseName(ParallelPhase phase)
+{
+    switch (phase)
+    {
+    case ParallelPhase::GENERATE:
+        return "generate";
+    case ParallelPhase::POPULATION:
+        return "population";
+    case ParallelPhase::INSTRUMENTS:
+        return "instruments";
+    case ParallelPhase::SETTLE:
+        return "settle";
+    case ParallelPhase::TRADER_STATS:
+        return "trader_stats";
+    default:
+        return "?";
+    }
+}
+
+ExecutionPolicy::ExecutionPolicy()
+    : fork_join_ns(DEFAULT_FORK_JOIN_NS), strategy(ExecutionStrategy::AUTO)
+{
+    for (int p = 0; p < PARALLEL_PHASE_COUNT; p++)
+    {
+        item_ns[p].store(DEFAULT_ITEM_NS[p], std::memory_order_relaxed);
+        overhead_ns[p].store(DEFAULT_FORK_JOIN_NS, std::memory_order_relaxed);
+    }
+}
+
+ExecutionPolicy &ExecutionPolicy::instance()
+{
+    static ExecutionPolicy policy;
+    return policy;
+}
+
+void ExecutionPolicy::calibrate()
+{
+    if (omp_in_parallel() || omp_get_max_threads() <= 1)
+        return;
+
+    // Every thread must do something, or an empty region costs nothing.
+    // The first one also starts the thread team, so it is not timed.
+    std::atomic<int> arrivals(0);
+#pragma omp parallel
+    {
+        arrivals.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Back-to-back regions would find the team hot; serial work in between
+    // also shows what idle workers cost the master (spinning on shared cores)
+    volatile double sink = 0.0;
+    auto median = [](std::vector<long long> &samples)
+    {
+        std::nth_element(samples.begin(), samples.begin() + samples.size() / 2, samples.end());
+        return static_cast<double>(samples[samples.size() / 2]);
+    };
+
+    std::vector<long long> serial(CALIBRATION_REGIONS);
+    std::vector<long long> with_region(CALIBRATION_REGIONS);
+    for (int i = 0; i < CALIBRATION_REGIONS; i++)
+    {
+        long long start = nowNs();
+        sink = sink + calibrationWork();
+        serial[i] = nowNs() - start;
+
+        start = nowNs();
+        sink = sink + calibrationWork();
+#pragma omp parallel
+        {
+            arrivals.fetch_add(1, std::memory_order_relaxed);
+        }
+        with_region[i] = nowNs() - start;
+    }
+    setForkJoinCost(std::max(median(with_region) - median(serial), 0.0));
+}
+
+void ExecutionPolicy::setForkJoinCost(double ns)
+{
+    fork_join_ns.store(ns, std::memory_order_relaxed);
+    for (auto &overhead : overhead_ns)
+        overhead.store(ns, std::memory_order_relaxed);
+}
+
+void ExecutionPolicy::setItemCost(ParallelPhase phase, double ns)
+{
+    item_ns[static_cast<int>(phase)].store(ns, std::memory_order_relaxed);
+}
+
+double ExecutionPolicy::getItemCost(ParallelPhase phase) const
+{
+    return item_ns[static_cast<int>(phase)].load(std::memory_order_relaxed);
+}
+
+double ExecutionPolicy::getOverhead(ParallelPhase phase) const
+{
+    return overhead_ns[static_cast<int>(phase)].load(std::memory_order_relaxed);
+}
+
+ExecutionPlan ExecutionPolicy::plan(ParallelPhase phase, size_t items) const
+{
+    ExecutionPlan result;
+    ExecutionStrategy mode = getStrategy();
+    int max_threads = omp_get_max_threads();
+    if (mode == ExecutionStrategy::SERIAL || items < 2 || max_threads <= 1 || omp_in_parallel())
+        return result;
+
+    int threads = static_cast<int>(std::min<size_t>(max_threads, items));
+    if (mode == ExecutionStrategy::AUTO)
+    {
+        // No thread gets less work than the region costs
+        double work = items * getItemCost(phase);
+        double overhead = getOverhead(phase);
+        if (overhead > 0.0)
+            threads = static_cast<int>(std::min<double>(threads, work / overhead));
+        if (threads < 2 || work < (work / threads + overhead) * GAIN_REQUIRED)
+            return result;
+    }
+
+    result.threads = threads;
+    if (UNEVEN_ITEMS[static_cast<int>(phase)])
+    {
+        result.mode = ExecutionMode::BATCHED;
+        result.batch = static_cast<int>(std::max<size_t>(1, items / (static_cast<size_t>(threads) * BATCHES_PER_THREAD)));
+    }
+    else
+    {
+        result.mode = ExecutionMode::PARALLEL_FOR;
+    }
+    return result;
+}
+
+void ExecutionPolicy::record(ParallelPhase phase, const ExecutionPlan &plan, size_t items, double elapsed_ns)
+{
+    if (items == 0)
+        return;
+
+    int p = static_cast<int>(phase);
+    if (plan.parallel())
+    {
+        // Whatever the run took beyond an even split of the serial work
+        double split = items * getItemCost(phase) / plan.threads;
+        smooth(overhead_ns[p], std::max(elapsed_ns - split, 0.0), COST_SMOOTHING);
+        return;
+    }
+
+    smooth(item_ns[p], elapsed_ns / items, COST_SMOOTHING);
+    smooth(overhead_ns[p], getForkJoinCost(), OVERHEAD_RELAX);
+}
+
+ParallelRegion::ParallelRegion(ParallelPhase region_phase, size_t item_count)
+    : phase(region_phase), items(item_count),
+      execution(ExecutionPolicy::instance().plan(region_phase, item_count)), start_ns(nowNs())
+{
+}
+
+ParallelRegion::~ParallelRegion()
+{
+    ExecutionPolicy::instance().record(phase, execution, items, static_cast<double>(nowNs() - start_ns));
+}
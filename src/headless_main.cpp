@@ -0,0 +1,22 @@
+#include "../include/driver.hpp"
+
+// tradingSim without the TUI, for batch nodes: the same ensemble, sweep
+// and replay modes, and a bare run is one headless simulation
+int main(int argc, char *argv[])
+{
+    ProcessGroup group(argc, argv);
+    Config config = parseArguments(argc, argv);
+
+    if (config.show_help)
+    {
+        if (group.rank() == 0)
+            printHelp(false);
+        return 0;
+    }
+
+    prepareRun(config, group);
+
+    if (!isBatchRun(config))
+        config.ensemble_count = 1;
+    return runBatch(config, group);
+}
@@ -0,0 +1,357 @@
+#include "../include/indicator_engine.hpp"
+#include <cmath>
+#include <algorithm>
+
+RollingStats::RollingStats(int p)
+    : window(std::max(p, 1), 0.0), period(std::max(p, 1)), next(0), count(0), sum(0.0), sum_sq(0.0)
+{
+}
+
+void RollingStats::update(double price)
+{
+    if (count >= period)
+    {
+        double oldest = window[next];
+        sum -= oldest;
+        sum_sq -= oldest * oldest;
+    }
+    else
+    {
+        count++;
+    }
+
+    window[next] = price;
+    sum += price;
+    sum_sq += price * price;
+    next = (next + 1) % period;
+
+    // Re-sum once per full window so add/subtract rounding cannot accumulate
+    if (next == 0)
+    {
+        sum = 0.0;
+        sum_sq = 0.0;
+        for (double value : window)
+        {
+            sum += value;
+            sum_sq += value * value;
+        }
+    }
+}
+
+double RollingStats::mean() const
+{
+    if (count == 0)
+        return 0.0;
+    return sum / count;
+}
+
+double RollingStats::stddev() const
+{
+    if (count == 0)
+        return 0.0;
+
+    // Running sums can drift slightly negative through cancellation
+    double m = mean();
+    double variance = sum_sq / count - m * m;
+    return std::sqrt(std::max(variance, 0.0));
+}
+
+EmaState::EmaState(int p)
+    : period(std::max(p, 1)), multiplier(2.0 / (std::max(p, 1) + 1)),
+      value(0.0), seed_sum(0.0), count(0)
+{
+}
+
+void EmaState::update(double x)
+{
+    if (count < period)
+    {
+        seed_sum += x;
+        count++;
+        if (count == period)
+        {
+            value = seed_sum / period;
+        }
+        return;
+    }
+
+    value = (x - value) * multiplier + value;
+}
+
+WilderRSI::WilderRSI(int p)
+    : period(std::max(p, 1)), previous_price(0.0), avg_gain(0.0), avg_loss(0.0),
+      changes(0), has_previous(false)
+{
+}
+
+void WilderRSI::update(double price)
+{
+    if (!has_previous)
+    {
+        previous_price = price;
+        has_previous = true;
+        return;
+    }
+
+    double change = price - previous_price;
+    previous_price = price;
+
+    double gain = change > 0 ? change : 0.0;
+    double loss = change < 0 ? -change : 0.0;
+
+    if (changes < period)
+    {
+        // Seed with simple averages over the first period
+        avg_gain += gain / period;
+        avg_loss += loss / period;
+        changes++;
+        return;
+    }
+
+    avg_gain = (avg_gain * (period - 1) + gain) / period;
+    avg_loss = (avg_loss * (period - 1) + loss) / period;
+}
+
+double WilderRSI::getValue() const
+{
+    if (!isReady())
+        return 50.0;
+
+    if (avg_loss == 0.0)
+        return 100.0;
+
+    double rs = avg_gain / avg_loss;
+    return 100.0 - (100.0 / (1.0 + rs));
+}
+
+MacdState::MacdState(int f, int s, int sig)
+    : fast_period(f), slow_period(s), signal_period(sig),
+      fast(f), slow(s), signal(sig)
+{
+}
+
+void MacdState::update(double price)
+{
+    fast.update(price);
+    slow.update(price);
+
+    if (fast.isReady() && slow.isReady())
+    {
+        signal.update(fast.getValue() - slow.getValue());
+    }
+}
+
+std::tuple<double, double, double> MacdState::getValue() const
+{
+    if (!slow.isReady())
+        return {0.0, 0.0, 0.0};
+
+    double macd_line = fast.getValue() - slow.getValue();
+    if (!signal.isReady())
+        return {macd_line, 0.0, macd_line};
+
+    double signal_line = signal.getValue();
+    return {macd_line, signal_line, macd_line - signal_line};
+}
+
+IndicatorEngine::IndicatorEngine() : samples(0)
+{
+}
+
+int IndicatorEngine::addRSI(int period)
+{
+    for (size_t i = 0; i < rsi_states.size(); i++)
+    {
+        if (rsi_states[i].getPeriod() == period)
+            return static_cast<int>(i);
+    }
+    rsi_states.emplace_back(period);
+    return static_cast<int>(rsi_states.size() - 1);
+}
+
+int IndicatorEngine::addMACD(int fast_period, int slow_period, int signal_period)
+{
+    for (size_t i = 0; i < macd_states.size(); i++)
+    {
+        if (macd_states[i].matches(fast_period, slow_period, signal_period))
+            return static_cast<int>(i);
+    }
+    macd_states.emplace_back(fast_period, slow_period, signal_period);
+    return static_cast<int>(macd_states.size() - 1);
+}
+
+int IndicatorEngine::addBollinger(int period, double std_dev)
+{
+    int stats_index = -1;
+    for (size_t i = 0; i < rolling_stats.size(); i++)
+    {
+        if (rolling_stats[i].getPeriod() == period)
+        {
+            stats_index = static_cast<int>(i);
+            break;
+        }
+    }
+    if (stats_index < 0)
+    {
+        rolling_stats.emplace_back(period);
+        stats_index = static_cast<int>(rolling_stats.size() - 1);
+    }
+
+    for (size_t i = 0; i < bollinger_params.size(); i++)
+    {
+        if (bollinger_params[i].stats_index == stats_index && bollinger_params[i].std_dev == std_dev)
+            return static_cast<int>(i);
+    }
+    bollinger_params.push_back({stats_index, std_dev});
+    return static_cast<int>(bollinger_params.size() - 1);
+}
+
+IndicatorSet IndicatorEngine::addDefaultSet()
+{
+    IndicatorSet set;
+    set.rsi = addRSI();
+    set.macd = addMACD();
+    set.bollinger = addBollinger();
+    return set;
+}
+
+void IndicatorEngine::update(double price)
+{
+    for (auto &rsi : rsi_states)
+        rsi.update(price);
+    for (auto &macd : macd_states)
+        macd.update(price);
+    for (auto &stats : rolling_stats)
+        stats.update(price);
+    samples++;
+}
+
+double IndicatorEngine::getRSI(int id) const
+{
+    return rsi_states[id].getValue();
+}
+
+std::tuple<double, double, double> IndicatorEngine::getMACD(int id) const
+{
+    return macd_states[id].getValue();
+}
+
+std::tuple<double, double, double> IndicatorEngine::getBollinger(int id) const
+{
+    const BollingerParams &params = bollinger_params[id];
+    const RollingStats &stats = rolling_stats[params.stats_index];
+
+    if (!stats.isReady())
+        return {0.0, 0.0, 0.0};
+
+    double sma = stats.mean();
+    double band = params.std_dev * stats.stddev();
+    return {sma + band, sma, sma - band};
+}
+
+void RollingStats::saveState(CheckpointWriter &out) const
+{
+    out.putVector(window);
+    out.put(next);
+    out.put(count);
+    out.put(sum);
+    out.put(sum_sq);
+}
+
+void RollingStats::loadState(CheckpointReader &in)
+{
+    in.getFixedVector(window);
+    next = in.get<int>();
+    count = in.get<int>();
+    sum = in.get<double>();
+    sum_sq = in.get<double>();
+    if (next < 0 || next >= period || count < 0 || count > period)
+        in.fail();
+}
+
+void EmaState::saveState(CheckpointWriter &out) const
+{
+    out.put(value);
+    out.put(seed_sum);
+    out.put(count);
+}
+
+void EmaState::loadState(CheckpointReader &in)
+{
+    value = in.get<double>();
+    seed_sum = in.get<double>();
+    count = in.get<int>();
+}
+
+void WilderRSI::saveState(CheckpointWriter &out) const
+{
+    out.put(previous_price);
+    out.put(avg_gain);
+    out.put(avg_loss);
+    out.put(changes);
+    out.put(has_previous);
+}
+
+void WilderRSI::loadState(CheckpointReader &in)
+{
+    previous_price = in.get<double>();
+    avg_gain = in.get<double>();
+    avg_loss = in.get<double>();
+    changes = in.get<int>();
+    has_previous = in.get<bool>();
+}
+
+void MacdState::saveState(CheckpointWriter &out) const
+{
+    fast.saveState(out);
+    slow.saveState(out);
+    signal.saveState(out);
+}
+
+void MacdState::loadState(CheckpointReader &in)
+{
+    fast.loadState(in);
+    slow.loadState(in);
+    signal.loadState(in);
+}
+
+// Count then each state, failing if the engines were registered differently
+template <typename State>
+static void saveStates(CheckpointWriter &out, const std::vector<State> &states)
+{
+    out.put(static_cast<std::uint64_t>(states.size()));
+    for (const auto &state : states)
+    {
+        state.saveState(out);
+    }
+}
+
+template <typename State>
+static void loadStates(CheckpointReader &in, std::vector<State> &states)
+{
+    if (in.get<std::uint64_t>() != states.size())
+    {
+        in.fail();
+        return;
+    }
+    for (auto &state : states)
+    {
+        state.loadState(in);
+    }
+}
+
+void IndicatorEngine::saveState(CheckpointWriter &out) const
+{
+    saveStates(out, rsi_states);
+    saveStates(out, macd_states);
+    saveStates(out, rolling_stats);
+    out.put(samples);
+}
+
+void IndicatorEngine::loadState(CheckpointReader &in)
+{
+    loadStates(in, rsi_states);
+    loadStates(in, macd_states);
+    loadStates(in, rolling_stats);
+    samples = in.get<long long>();
+}
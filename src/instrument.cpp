@@ -0,0 +1,184 @@
+#include "../include/instrument.hpp"
+
+// Spreads symbol indices across the 32-bit seed space
+static constexpr unsigned int SYMBOL_SEED_STRIDE = 0x9E3779B9u;
+
+static unsigned int symbolSeed(unsigned int seed, int symbol_index)
+{
+    return seed + static_cast<unsigned int>(symbol_index) * SYMBOL_SEED_STRIDE;
+}
+
+Instrument::Instrument(const std::string &symbol_name, int index, int num_traders,
+                       double initial_price, double initial_cash, unsigned int seed,
+                       const std::string &log_directory)
+    : symbol(symbol_name), symbol_index(index),
+      market(initial_price, symbolSeed(seed, index)),
+      order_book(createOrderBook(OrderBookType::MAP)),
+      logger(log_directory + "/" + symbol_name), reservations(num_traders), order_lifetime(0.0)
+{
+    unsigned int symbol_seed = symbolSeed(seed, index);
+    IndicatorSet default_indicators = indicators.addDefaultSet();
+    int initial_holdings = 50;
+
+    for (int i = 0; i < num_traders; i++)
+    {
+        agents.push_back(std::make_unique<Trader>(i, assignStrategy(i), initial_cash, symbol_seed));
+        agents.back()->attachIndicators(&indicators, default_indicators);
+        agents.back()->attachPriceHistory(&market.getHistory());
+    }
+
+    for (int i = 0; i < num_traders / 2; i++)
+    {
+        agents[i]->setInitialHoldings(initial_holdings);
+    }
+    agent_runs.build(agents);
+
+    step_cash.assign(num_traders, 0.0);
+    cash_delta.assign(num_traders, 0.0);
+}
+
+void Instrument::setOrderBookType(OrderBookType type, double tick_size)
+{
+    MatchingMode mode = order_book->getMatchingMode();
+    order_book = createOrderBook(type, tick_size);
+    reservations.reset(static_cast<int>(agents.size()));
+    order_book->setMatchingMode(mode);
+}
+
+void Instrument::setMatchingMode(MatchingMode mode)
+{
+    order_book->setMatchingMode(mode);
+}
+
+void Instrument::releaseExpiredOrders()
+{
+    order_book->takeExpiredOrders(expired_orders);
+    for (const Order &order : expired_orders)
+    {
+        reservations.release(order.order_id);
+    }
+}
+
+void Instrument::step(double current_time, const std::vector<double> &free_cash)
+{
+    double current_price = market.getCurrentPrice();
+    indicators.update(current_price);
+
+    // Taken before expiry: cash an expired buy releases stays with this
+    // symbol for the rest of the step
+    for (size_t i = 0; i < agents.size(); i++)
+    {
+        step_cash[i] = free_cash[i] + reservations.getReservedCash(static_cast<int>(i));
+        agents[i]->setCash(step_cash[i]);
+    }
+
+    // Serial inside the shard: the simulation already runs one shard per thread
+    order_book->expireOrders(current_time);
+    releaseExpiredOrders();
+    step_orders.clear();
+    int total_buy_quantity = 0;
+    int total_sell_quantity = 0;
+
+    order_slots.assign(agents.size(), TraderOrder{});
+    for (const StrategyRun &run : agent_runs.runs)
+    {
+        Trader::createOrders(run.strategy, agents, agent_runs.indices.data() + run.begin, run.end - run.begin,
+                             current_price, current_time, order_slots.data());
+    }
+
+    // Merged in trader id order, as TradingSimulation does
+    for (const TraderOrder &trader_order : order_slots)
+    {
+        if (trader_order.quantity <= 0)
+            continue;
+
+        step_orders.emplace_back(0, trader_order.trader_id,
+                                 trader_order.is_buy ? OrderType::BUY : OrderType::SELL,
+                                 trader_order.price, trader_order.quantity, trader_order.timestamp);
+        step_orders.back().setLifetime(order_lifetime);
+        if (trader_order.is_buy)
+            total_buy_quantity += trader_order.quantity;
+        else
+            total_sell_quantity += trader_order.quantity;
+    }
+
+    // New orders must fit in the free share: the rest of step_cash is
+    // already reserved by this symbol's resting orders
+    reservations.admit(step_orders, [this](int id)
+                       { return std::make_pair(agents[id]->getCash(), agents[id]->getHoldings()); },
+                       total_buy_quantity, total_sell_quantity);
+
+    logger.logOrders(++steps_run, step_orders.data(), step_orders.size());
+    int first_id = order_book->addOrders(step_orders.data(), step_orders.size());
+    reservations.bind(first_id, step_orders.data(), step_orders.size());
+    last_step_trades = order_book->matchOrders();
+
+    last_step_unsettled = 0;
+    for (const auto &trade : last_step_trades)
+    {
+        reservations.fill(trade.buy_order_id, trade.quantity);
+        reservations.fill(trade.sell_order_id, trade.quantity);
+        if (!agents[trade.buyer_id]->executeOrder(true, trade.price, trade.quantity))
+            last_step_unsettled++;
+        if (!agents[trade.seller_id]->executeOrder(false, trade.price, trade.quantity))
+            last_step_unsettled++;
+    }
+    releaseExpiredOrders();
+    reservations.trim();
+    logger.logTrades(last_step_trades.data(), last_step_trades.size());
+
+    market.updatePrice(total_buy_quantity, total_sell_quantity);
+
+    for (size_t i = 0; i < agents.size(); i++)
+    {
+        cash_delta[i] = agents[i]->getCash() - step_cash[i];
+    }
+
+    if (static_cast<int>(current_time * 10) % 10 == 0)
+    {
+        double volume = 0.0;
+        for (const auto &trade : last_step_trades)
+        {
+            volume += trade.price * trade.quantity;
+        }
+
+        logger.logPrice(current_time, current_price, volume,
+                        order_book->getBuyOrderCount(), order_book->getSellOrderCount());
+        logger.logOrderBook(current_time, order_book->getBuyDepth(5), order_book->getSellDepth(5));
+    }
+}
+
+void Instrument::saveState(CheckpointWriter &out) const
+{
+    market.saveState(out);
+    indicators.saveState(out);
+    order_book->saveState(out);
+    for (const auto &agent : agents)
+    {
+        agent->saveState(out);
+    }
+    reservations.saveState(out);
+}
+
+void Instrument::loadState(CheckpointReader &in)
+{
+    market.loadState(in);
+    indicators.loadState(in);
+    order_book->loadState(in);
+    for (auto &agent : agents)
+    {
+        agent->loadState(in);
+    }
+    reservations.loadState(in);
+    steps_run = 0; // A loaded state starts a new run
+}
+
+void Instrument::reseed(unsigned int seed)
+{
+    unsigned int symbol_seed = symbolSeed(seed, symbol_index);
+    market.reseed(symbol_seed);
+    for (auto &agent : agents)
+    {
+        agent->reseed(symbol_seed);
+    }
+}
@@ -1,11 +1,13 @@
 #include "../include/logger.hpp"
-#include <omp.h>
+#include "../include/execution_policy.hpp"
 #include <iostream>
 #include <sstream>
 #include <iomanip>
 #include <chrono>
 #include <filesystem>
 #include <memory>
+#include <thread>
+#include <limits>
 
 #ifdef _WIN32
 #include <direct.h>
@@ -15,14 +17,53 @@
 #define CREATE_DIR(path) mkdir(path, 0755)
 #endif
 
+static std::vector<LogColumn> tradeSchema()
+{
+    return {{"TradeID", LogColumnKind::INT},
+            {"Timestamp", LogColumnKind::FIXED2},
+            {"BuyOrderID", LogColumnKind::INT},
+            {"SellOrderID", LogColumnKind::INT},
+            {"BuyerID", LogColumnKind::INT},
+            {"SellerID", LogColumnKind::INT},
+            {"Price", LogColumnKind::FIXED2},
+            {"Quantity", LogColumnKind::INT}};
+}
+
+static std::vector<LogColumn> priceSchema()
+{
+    return {{"Timestamp", LogColumnKind::FIXED2},
+            {"Price", LogColumnKind::FIXED2},
+            {"Volume", LogColumnKind::FIXED2},
+            {"BuyOrders", LogColumnKind::INT},
+            {"SellOrders", LogColumnKind::INT}};
+}
+
+static std::vector<LogColumn> orderSchema()
+{
+    return {{"Step", LogColumnKind::INT},
+            {"Timestamp", LogColumnKind::FLOAT64},
+            {"TraderID", LogColumnKind::INT},
+            {"Side", LogColumnKind::INT}, // 0 buy, 1 sell
+            {"Price", LogColumnKind::FLOAT64},
+            {"Quantity", LogColumnKind::INT},
+            {"TimeInForce", LogColumnKind::INT}, // TimeInForce value, 0 GTC
+            {"ExpireTime", LogColumnKind::FLOAT64}};
+}
+
+// Orders log text for each TimeInForce, in enum order
+static const char *const TIME_IN_FORCE_NAMES[] = {"GTC", "GTT", "IOC", "FOK"};
+
 DataLogger::DataLogger(const std::string &directory)
-    : log_directory(directory), mpi_enabled(false), mpi_rank(0), mpi_size(1)
+    : log_directory(directory), mpi_enabled(false), mpi_rank(0), mpi_size(1), sim_index(-1), format(LogFormat::CSV),
+      log_orders(false), trade_writer(tradeSchema()), price_writer(priceSchema()), order_writer(orderSchema()),
+      stop_requested(false), dropped_records(0), backpressure(LogBackpressure::BLOCK)
 {
     createDirectory(log_directory);
 }
 
 DataLogger::~DataLogger()
 {
+    stopAsync();
     flush();
 
     if (trade_log.is_open())
@@ -33,12 +74,20 @@ DataLogger::~DataLogger()
         trader_stats_log.close();
     if (order_book_log.is_open())
         order_book_log.close();
+    if (order_log.is_open())
+        order_log.close();
+    trade_writer.close();
+    price_writer.close();
+    order_writer.close();
 }
 
-void DataLogger::initialize(bool use_mpi, int rank, int size, int sim_index)
+void DataLogger::initialize(bool use_mpi, int rank, int size, int index)
 {
     createDirectory(log_directory);
 
+    // Records already queued belong to the files being closed
+    waitForDrain();
+
     std::lock_guard<std::mutex> lock(log_mutex);
 
     auto flush_and_close = [](std::ofstream &stream, std::vector<std::string> &buffer)
@@ -57,6 +106,15 @@ void DataLogger::initialize(bool use_mpi, int rank, int size, int sim_index)
 
     flush_and_close(trade_log, trade_buffer);
     flush_and_close(price_log, price_buffer);
+    trade_writer.close();
+    price_writer.close();
+    order_writer.close();
+
+    if (order_log.is_open())
+    {
+        order_log.flush();
+        order_log.close();
+    }
 
     if (trader_stats_log.is_open())
     {
@@ -73,6 +131,7 @@ void DataLogger::initialize(bool use_mpi, int rank, int size, int sim_index)
     mpi_enabled = use_mpi;
     mpi_rank = rank;
     mpi_size = size;
+    sim_index = index;
 
     const std::string sim_suffix = (sim_index >= 0) ? "_sim" + std::to_string(sim_index) : "";
     const std::string rank_suffix = mpi_enabled ? "_rank" + std::to_string(mpi_rank) : "";
@@ -90,12 +149,40 @@ void DataLogger::initialize(bool use_mpi, int rank, int size, int sim_index)
         stream.flush();
     };
 
-    open_stream(trade_log, "trades", "TradeID,Timestamp,BuyOrderID,SellOrderID,BuyerID,SellerID,Price,Quantity\n");
-    open_stream(price_log, "prices", "Timestamp,Price,Volume,BuyOrders,SellOrders\n");
+    auto open_writer = [&](BinaryLogWriter &writer, const std::string &base_name)
+    {
+        const std::string filename = log_directory + "/" + base_name + sim_suffix + rank_suffix + ".tslog";
+        if (!writer.open(filename))
+        {
+            std::cerr << "Failed to open log file: " << filename << std::endl;
+        }
+    };
+
+    if (format == LogFormat::BINARY)
+    {
+        open_writer(trade_writer, "trades");
+        open_writer(price_writer, "prices");
+        if (log_orders)
+            open_writer(order_writer, "orders");
+    }
+    else
+    {
+        open_stream(trade_log, "trades", "TradeID,Timestamp,BuyOrderID,SellOrderID,BuyerID,SellerID,Price,Quantity\n");
+        open_stream(price_log, "prices", "Timestamp,Price,Volume,BuyOrders,SellOrders\n");
+        if (log_orders)
+            open_stream(order_log, "orders", "Step,Timestamp,TraderID,Side,Price,Quantity,TimeInForce,ExpireTime\n");
+    }
     open_stream(trader_stats_log, "trader_stats", "Timestamp,TraderID,Strategy,Cash,Holdings,NetWorth,TotalProfit,TradesExecuted,RSI,MACD\n");
     open_stream(order_book_log, "order_book", "Timestamp,Side,Price,Quantity\n");
 }
 
+void DataLogger::initializeLike(const DataLogger &other)
+{
+    format = other.format;
+    log_orders = other.log_orders;
+    initialize(other.mpi_enabled, other.mpi_rank, other.mpi_size, other.sim_index);
+}
+
 void DataLogger::createDirectory(const std::string &dir)
 {
     try
@@ -110,7 +197,41 @@ void DataLogger::createDirectory(const std::string &dir)
 
 void DataLogger::logTrade(const ExecutedTrade &trade)
 {
+    if (trade_channel)
+    {
+        pushRecord(*trade_channel, trade);
+        return;
+    }
+
     std::lock_guard<std::mutex> lock(log_mutex);
+    writeTrade(trade);
+}
+
+void DataLogger::logTrades(const ExecutedTrade *trades, size_t count)
+{
+    if (trade_channel)
+    {
+        for (size_t i = 0; i < count; i++)
+            pushRecord(*trade_channel, trades[i]);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(log_mutex);
+    for (size_t i = 0; i < count; i++)
+        writeTrade(trades[i]);
+}
+
+void DataLogger::writeTrade(const ExecutedTrade &trade)
+{
+    if (trade_writer.isOpen())
+    {
+        std::int64_t row[] = {trade.trade_id, BinaryLogWriter::toFixed2(trade.timestamp),
+                              trade.buy_order_id, trade.sell_order_id,
+                              trade.buyer_id, trade.seller_id,
+                              BinaryLogWriter::toFixed2(trade.price), trade.quantity};
+        trade_writer.appendRow(row);
+        return;
+    }
 
     if (!trade_log.is_open())
         return;
@@ -137,19 +258,84 @@ void DataLogger::logTrade(const ExecutedTrade &trade)
     }
 }
 
+void DataLogger::logOrders(std::uint64_t step, const Order *orders, size_t count)
+{
+    if (!log_orders)
+        return;
+
+    if (order_channel)
+    {
+        for (size_t i = 0; i < count; i++)
+            pushRecord(*order_channel, OrderRecord{step, orders[i]});
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(log_mutex);
+    for (size_t i = 0; i < count; i++)
+        writeOrder(OrderRecord{step, orders[i]});
+}
+
+void DataLogger::writeOrder(const OrderRecord &record)
+{
+    const Order &order = record.order;
+    bool is_buy = order.type == OrderType::BUY;
+
+    if (order_writer.isOpen())
+    {
+        std::int64_t row[] = {static_cast<std::int64_t>(record.step), BinaryLogWriter::toFloat64(order.timestamp),
+                              order.trader_id, is_buy ? 0 : 1,
+                              BinaryLogWriter::toFloat64(order.price), order.quantity,
+                              static_cast<std::int64_t>(order.time_in_force), BinaryLogWriter::toFloat64(order.expire_time)};
+        order_writer.appendRow(row);
+        return;
+    }
+
+    if (!order_log.is_open())
+        return;
+
+    // Full precision so a replayed map book sees the exact prices
+    order_log << std::defaultfloat << std::setprecision(std::numeric_limits<double>::max_digits10)
+              << record.step << "," << order.timestamp << ","
+              << order.trader_id << ","
+              << (is_buy ? "BUY," : "SELL,")
+              << order.price << ","
+              << order.quantity << ","
+              << TIME_IN_FORCE_NAMES[static_cast<int>(order.time_in_force)] << ","
+              << order.expire_time << "\n";
+}
+
 void DataLogger::logPrice(double timestamp, double price, double volume, int buy_orders, int sell_orders)
 {
+    PriceRecord record{timestamp, price, volume, buy_orders, sell_orders};
+    if (price_channel)
+    {
+        pushRecord(*price_channel, record);
+        return;
+    }
+
     std::lock_guard<std::mutex> lock(log_mutex);
+    writePrice(record);
+}
+
+void DataLogger::writePrice(const PriceRecord &record)
+{
+    if (price_writer.isOpen())
+    {
+        std::int64_t row[] = {BinaryLogWriter::toFixed2(record.timestamp), BinaryLogWriter::toFixed2(record.price),
+                              BinaryLogWriter::toFixed2(record.volume), record.buy_orders, record.sell_orders};
+        price_writer.appendRow(row);
+        return;
+    }
 
     if (!price_log.is_open())
         return;
 
     std::ostringstream ss;
-    ss << std::fixed << std::setprecision(2) << timestamp << ","
-       << std::fixed << std::setprecision(2) << price << ","
-       << std::fixed << std::setprecision(2) << volume << ","
-       << buy_orders << ","
-       << sell_orders << "\n";
+    ss << std::fixed << std::setprecision(2) << record.timestamp << ","
+       << std::fixed << std::setprecision(2) << record.price << ","
+       << std::fixed << std::setprecision(2) << record.volume << ","
+       << record.buy_orders << ","
+       << record.sell_orders << "\n";
 
     price_buffer.push_back(ss.str());
 
@@ -165,30 +351,46 @@ void DataLogger::logPrice(double timestamp, double price, double volume, int buy
 
 void DataLogger::logTraderStats(double timestamp, const std::vector<std::unique_ptr<Trader>> &traders, double market_price)
 {
+    if (stats_channel)
+    {
+        for (const auto &trader : traders)
+        {
+            pushRecord(*stats_channel, TraderStatRecord{timestamp, trader->getId(), trader->getStrategy(),
+                                                        trader->getCash(), trader->getHoldings(),
+                                                        trader->getNetWorth(market_price), trader->getTotalProfit(),
+                                                        trader->getTradesExecuted(),
+                                                        trader->getLastRSI(), trader->getLastMACD()});
+        }
+        return;
+    }
+
     std::lock_guard<std::mutex> lock(log_mutex);
 
     if (!trader_stats_log.is_open())
         return;
 
     std::vector<std::string> stats_lines(traders.size());
-
-#pragma omp parallel for schedule(dynamic)
-    for (int i = 0; i < traders.size(); i++)
     {
-        const auto &trader = traders[i];
-        std::ostringstream ss;
-        ss << std::fixed << std::setprecision(2) << timestamp << ","
-           << trader->getId() << ","
-           << trader->getStrategyName() << ","
-           << std::fixed << std::setprecision(2) << trader->getCash() << ","
-           << trader->getHoldings() << ","
-           << std::fixed << std::setprecision(2) << trader->getNetWorth(market_price) << ","
-           << std::fixed << std::setprecision(2) << trader->getTotalProfit() << ","
-           << trader->getTradesExecuted() << ","
-           << std::fixed << std::setprecision(2) << trader->getLastRSI() << ","
-           << std::fixed << std::setprecision(2) << trader->getLastMACD() << "\n";
+        ParallelRegion region(ParallelPhase::TRADER_STATS, traders.size());
 
-        stats_lines[i] = ss.str();
+#pragma omp parallel for schedule(dynamic, region.batch()) if (region.parallel()) num_threads(region.threads())
+        for (int i = 0; i < traders.size(); i++)
+        {
+            const auto &trader = traders[i];
+            std::ostringstream ss;
+            ss << std::fixed << std::setprecision(2) << timestamp << ","
+               << trader->getId() << ","
+               << trader->getStrategyName() << ","
+               << std::fixed << std::setprecision(2) << trader->getCash() << ","
+               << trader->getHoldings() << ","
+               << std::fixed << std::setprecision(2) << trader->getNetWorth(market_price) << ","
+               << std::fixed << std::setprecision(2) << trader->getTotalProfit() << ","
+               << trader->getTradesExecuted() << ","
+               << std::fixed << std::setprecision(2) << trader->getLastRSI() << ","
+               << std::fixed << std::setprecision(2) << trader->getLastMACD() << "\n";
+
+            stats_lines[i] = ss.str();
+        }
     }
 
     for (const auto &line : stats_lines)
@@ -197,34 +399,110 @@ void DataLogger::logTraderStats(double timestamp, const std::vector<std::unique_
     }
 }
 
-void DataLogger::logOrderBook(double timestamp,
-                              const std::vector<std::pair<double, int>> &buy_depth,
-                              const std::vector<std::pair<double, int>> &sell_depth)
+void DataLogger::logTraderStats(double timestamp, const TraderPopulation &population, double market_price)
 {
+    if (stats_channel)
+    {
+        for (int id = 0; id < population.size(); id++)
+        {
+            pushRecord(*stats_channel, TraderStatRecord{timestamp, id, population.getStrategy(id),
+                                                        population.getCash(id), population.getHoldings(id),
+                                                        population.getNetWorth(id, market_price),
+                                                        population.getTotalProfit(id),
+                                                        population.getTradesExecuted(id),
+                                                        population.getLastRSI(id), population.getLastMACD(id)});
+        }
+        return;
+    }
+
     std::lock_guard<std::mutex> lock(log_mutex);
 
-    if (!order_book_log.is_open())
+    if (!trader_stats_log.is_open())
         return;
 
-    for (const auto &[price, quantity] : buy_depth)
+    std::vector<std::string> stats_lines(population.size());
     {
-        order_book_log << std::fixed << std::setprecision(2) << timestamp << ","
-                       << "BUY,"
-                       << std::fixed << std::setprecision(2) << price << ","
-                       << quantity << "\n";
+        ParallelRegion region(ParallelPhase::TRADER_STATS, population.size());
+
+        // Rows stay in trader id order, matching the per-object log
+#pragma omp parallel for schedule(dynamic, region.batch()) if (region.parallel()) num_threads(region.threads())
+        for (int id = 0; id < population.size(); id++)
+        {
+            std::ostringstream ss;
+            ss << std::fixed << std::setprecision(2) << timestamp << ","
+               << id << ","
+               << strategyName(population.getStrategy(id)) << ","
+               << std::fixed << std::setprecision(2) << population.getCash(id) << ","
+               << population.getHoldings(id) << ","
+               << std::fixed << std::setprecision(2) << population.getNetWorth(id, market_price) << ","
+               << std::fixed << std::setprecision(2) << population.getTotalProfit(id) << ","
+               << population.getTradesExecuted(id) << ","
+               << std::fixed << std::setprecision(2) << population.getLastRSI(id) << ","
+               << std::fixed << std::setprecision(2) << population.getLastMACD(id) << "\n";
+
+            stats_lines[id] = ss.str();
+        }
     }
 
-    for (const auto &[price, quantity] : sell_depth)
+    for (const auto &line : stats_lines)
+    {
+        trader_stats_log << line;
+    }
+}
+
+void DataLogger::writeTraderStat(const TraderStatRecord &record)
+{
+    if (!trader_stats_log.is_open())
+        return;
+
+    trader_stats_log << std::fixed << std::setprecision(2) << record.timestamp << ","
+                     << record.trader_id << ","
+                     << strategyName(record.strategy) << ","
+                     << std::fixed << std::setprecision(2) << record.cash << ","
+                     << record.holdings << ","
+                     << std::fixed << std::setprecision(2) << record.net_worth << ","
+                     << std::fixed << std::setprecision(2) << record.total_profit << ","
+                     << record.trades_executed << ","
+                     << std::fixed << std::setprecision(2) << record.rsi << ","
+                     << std::fixed << std::setprecision(2) << record.macd << "\n";
+}
+
+void DataLogger::logOrderBook(double timestamp,
+                              const std::vector<std::pair<double, int>> &buy_depth,
+                              const std::vector<std::pair<double, int>> &sell_depth)
+{
+    if (depth_channel)
     {
-        order_book_log << std::fixed << std::setprecision(2) << timestamp << ","
-                       << "SELL,"
-                       << std::fixed << std::setprecision(2) << price << ","
-                       << quantity << "\n";
+        for (const auto &[price, quantity] : buy_depth)
+            pushRecord(*depth_channel, DepthRecord{timestamp, price, quantity, true});
+        for (const auto &[price, quantity] : sell_depth)
+            pushRecord(*depth_channel, DepthRecord{timestamp, price, quantity, false});
+        return;
     }
+
+    std::lock_guard<std::mutex> lock(log_mutex);
+
+    for (const auto &[price, quantity] : buy_depth)
+        writeDepth(DepthRecord{timestamp, price, quantity, true});
+    for (const auto &[price, quantity] : sell_depth)
+        writeDepth(DepthRecord{timestamp, price, quantity, false});
+}
+
+void DataLogger::writeDepth(const DepthRecord &record)
+{
+    if (!order_book_log.is_open())
+        return;
+
+    order_book_log << std::fixed << std::setprecision(2) << record.timestamp << ","
+                   << (record.is_buy ? "BUY," : "SELL,")
+                   << std::fixed << std::setprecision(2) << record.price << ","
+                   << record.quantity << "\n";
 }
 
 void DataLogger::flush()
 {
+    waitForDrain();
+
     std::lock_guard<std::mutex> lock(log_mutex);
 
     if (trade_log.is_open())
@@ -247,12 +525,154 @@ void DataLogger::flush()
         price_buffer.clear();
     }
 
+    trade_writer.flush();
+    price_writer.flush();
+    order_writer.flush();
+
+    if (order_log.is_open())
+        order_log.flush();
     if (trader_stats_log.is_open())
         trader_stats_log.flush();
     if (order_book_log.is_open())
         order_book_log.flush();
 }
 
+void DataLogger::startAsync(LogBackpressure policy, size_t ring_capacity)
+{
+    if (isAsync())
+        return;
+
+    backpressure = policy;
+    trade_channel = std::make_unique<AsyncChannel<ExecutedTrade>>(ring_capacity);
+    price_channel = std::make_unique<AsyncChannel<PriceRecord>>(ring_capacity);
+    depth_channel = std::make_unique<AsyncChannel<DepthRecord>>(ring_capacity);
+    stats_channel = std::make_unique<AsyncChannel<TraderStatRecord>>(ring_capacity);
+    order_channel = std::make_unique<AsyncChannel<OrderRecord>>(ring_capacity);
+
+    stop_requested.store(false);
+    writer_thread = std::thread(&DataLogger::writerLoop, this);
+}
+
+void DataLogger::stopAsync()
+{
+    if (!isAsync())
+        return;
+
+    waitForDrain();
+    stop_requested.store(true, std::memory_order_release);
+    writer_thread.join();
+
+    trade_channel.reset();
+    price_channel.reset();
+    depth_channel.reset();
+    stats_channel.reset();
+    order_channel.reset();
+}
+
+template <typename T>
+bool DataLogger::drainSpill(AsyncChannel<T> &channel)
+{
+    while (channel.spill_head < channel.spill.size())
+    {
+        if (!channel.ring.tryPush(channel.spill[channel.spill_head]))
+            return false;
+        channel.spill_head++;
+    }
+
+    channel.spill.clear();
+    channel.spill_head = 0;
+    return true;
+}
+
+template <typename T>
+void DataLogger::pushRecord(AsyncChannel<T> &channel, const T &record)
+{
+    // Spilled records go first so each channel stays in order
+    if (drainSpill(channel) && channel.ring.tryPush(record))
+        return;
+
+    switch (backpressure)
+    {
+    case LogBackpressure::BLOCK:
+        while (!channel.ring.tryPush(record))
+        {
+            std::this_thread::yield();
+        }
+        break;
+    case LogBackpressure::DROP:
+        dropped_records.fetch_add(1, std::memory_order_relaxed);
+        break;
+    case LogBackpressure::GROW:
+        channel.spill.push_back(record);
+        break;
+    }
+}
+
+void DataLogger::waitForDrain()
+{
+    if (!isAsync())
+        return;
+
+    auto spills_drained = [this]()
+    {
+        bool trades = drainSpill(*trade_channel);
+        bool prices = drainSpill(*price_channel);
+        bool depth = drainSpill(*depth_channel);
+        bool stats = drainSpill(*stats_channel);
+        bool orders = drainSpill(*order_channel);
+        return trades && prices && depth && stats && orders;
+    };
+
+    while (!spills_drained() || !trade_channel->ring.empty() || !price_channel->ring.empty() ||
+           !depth_channel->ring.empty() || !stats_channel->ring.empty() || !order_channel->ring.empty())
+    {
+        std::this_thread::yield();
+    }
+
+    // The writer pops and writes under log_mutex, so taking it waits out the last batch
+    std::lock_guard<std::mutex> lock(log_mutex);
+}
+
+void DataLogger::writerLoop()
+{
+    // Bound each locked pass so flush() and initialize() are not starved
+    constexpr int BATCH = 1024;
+
+    while (true)
+    {
+        bool stopping = stop_requested.load(std::memory_order_acquire);
+        int written = 0;
+
+        {
+            std::lock_guard<std::mutex> lock(log_mutex);
+
+            ExecutedTrade trade;
+            PriceRecord price;
+            DepthRecord depth;
+            TraderStatRecord stat;
+            OrderRecord order;
+            for (int i = 0; i < BATCH && trade_channel->ring.tryPop(trade); i++, written++)
+                writeTrade(trade);
+            for (int i = 0; i < BATCH && price_channel->ring.tryPop(price); i++, written++)
+                writePrice(price);
+            for (int i = 0; i < BATCH && depth_channel->ring.tryPop(depth); i++, written++)
+                writeDepth(depth);
+            for (int i = 0; i < BATCH && stats_channel->ring.tryPop(stat); i++, written++)
+                writeTraderStat(stat);
+            for (int i = 0; i < BATCH && order_channel->ring.tryPop(order); i++, written++)
+                writeOrder(order);
+        }
+
+        if (written == 0)
+        {
+            // Everything pushed before the stop request has been written
+            if (stopping)
+                break;
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+    }
+}
+
 void DataLogger::exportToJSON(const std::string &filename)
 {
     flush();
@@ -289,13 +709,10 @@ void DataLogger::parallelWrite(const std::string &filename, const std::vector<st
         return;
     }
 
-#pragma omp parallel for ordered
-    for (int i = 0; i < data.size(); i++)
+    // Writes to one stream in order: threads would only queue behind each other
+    for (const auto &chunk : data)
     {
-#pragma omp ordered
-        {
-            file << data[i];
-        }
+        file << chunk;
     }
 
     file.close();
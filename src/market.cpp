@@ -2,12 +2,52 @@
 #include <cmath>
 #include <algorithm>
 
-Market::Market(double initial_price)
+Market::Market(double initial_price, unsigned int seed)
     : current_price(initial_price), previous_price(initial_price), base_price(initial_price),
-      rng(std::random_device{}()), noise_dist(-0.5, 0.5),
-      buy_pressure(0), sell_pressure(0)
+      price_history(MARKET_HISTORY_CAPACITY), rng(seed, MARKET_RNG_STREAM), update_count(0),
+      buy_pressure(0), sell_pressure(0), window_mean(0.0), window_m2(0.0), pushes_since_resync(0)
 {
-    price_history.push_back(initial_price);
+    pushPrice(initial_price);
+}
+
+void Market::pushPrice(double price)
+{
+    size_t count = price_history.size();
+    if (count == price_history.getCapacity())
+    {
+        double evicted = price_history.recent(count)[0];
+        double previous_mean = window_mean;
+        window_mean += (price - evicted) / count;
+        window_m2 += (price - evicted) * (price - window_mean + evicted - previous_mean);
+    }
+    else
+    {
+        double delta = price - window_mean;
+        window_mean += delta / (count + 1);
+        window_m2 += delta * (price - window_mean);
+    }
+    price_history.push(price);
+
+    if (++pushes_since_resync == price_history.getCapacity())
+    {
+        PriceSpan window = price_history.view();
+        window_mean = 0.0;
+        for (double value : window)
+            window_mean += value;
+        window_mean /= window.size();
+        window_m2 = 0.0;
+        for (double value : window)
+            window_m2 += (value - window_mean) * (value - window_mean);
+        pushes_since_resync = 0;
+    }
+}
+
+double Market::getPriceVolatility() const
+{
+    size_t count = price_history.size();
+    if (count < 2)
+        return 0.0;
+    return std::sqrt(std::max(window_m2, 0.0) / count);
 }
 
 void Market::updatePrice(int buy_orders, int sell_orders)
@@ -18,30 +58,45 @@ void Market::updatePrice(int buy_orders, int sell_orders)
     sell_pressure += sell_orders;
 
     double pressure_diff = (buy_pressure - sell_pressure) * 0.1;
-    double noise = noise_dist(rng);
+    double noise = rng.uniform(update_count++) - 0.5;
     double price_change = pressure_diff + noise;
     current_price += price_change;
     current_price = std::max(base_price * 0.2, std::min(current_price, base_price * 3.0));
 
-    price_history.push_back(current_price);
-
-    if (price_history.size() > 1000)
-    {
-        price_history.erase(price_history.begin());
-    }
+    pushPrice(current_price);
 
     buy_pressure = static_cast<int>(buy_pressure * 0.8);
     sell_pressure = static_cast<int>(sell_pressure * 0.8);
 }
 
-std::vector<double> Market::getRecentHistory(int points) const
+void Market::saveState(CheckpointWriter &out) const
 {
-    if (price_history.size() <= points)
-    {
-        return price_history;
-    }
+    out.put(current_price);
+    out.put(previous_price);
+    out.put(base_price);
+    price_history.saveState(out);
+    out.put(rng);
+    out.put(update_count);
+    out.put(buy_pressure);
+    out.put(sell_pressure);
+    out.put(window_mean);
+    out.put(window_m2);
+    out.put(static_cast<std::uint64_t>(pushes_since_resync));
+}
 
-    return std::vector<double>(
-        price_history.end() - points,
-        price_history.end());
+void Market::loadState(CheckpointReader &in)
+{
+    current_price = in.get<double>();
+    previous_price = in.get<double>();
+    base_price = in.get<double>();
+    price_history.loadState(in);
+    rng = in.get<CounterRng>();
+    update_count = in.get<std::uint64_t>();
+    buy_pressure = in.get<int>();
+    sell_pressure = in.get<int>();
+    window_mean = in.get<double>();
+    window_m2 = in.get<double>();
+    pushes_since_resync = static_cast<size_t>(in.get<std::uint64_t>());
+    if (pushes_since_resync >= price_history.getCapacity())
+        in.fail();
 }
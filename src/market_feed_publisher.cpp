@@ -0,0 +1,116 @@
+#include "../include/market_feed_publisher.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+MarketFeedSlot &MarketFeedPublisher::slot(std::uint64_t tick)
+{
+    return reinterpret_cast<MarketFeedSlot *>(mapping + sizeof(MarketFeedHeader))[tick % header().slot_count];
+}
+
+bool MarketFeedPublisher::open(const std::string &name, std::uint32_t slot_count)
+{
+    close();
+    slot_count = std::max<std::uint32_t>(slot_count, 2);
+    path = marketFeedPath(name);
+
+    // Always a new object: one left by an earlier run is unlinked rather
+    // than reused, so processes still mapping it are never cut short
+    shm_unlink(path.c_str());
+    int fd = shm_open(path.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0)
+    {
+        std::cerr << "Error: cannot create market feed '" << path << "': " << std::strerror(errno) << "\n";
+        return false;
+    }
+
+    size_t size = marketFeedSize(slot_count);
+    void *view = MAP_FAILED;
+    if (ftruncate(fd, static_cast<off_t>(size)) == 0)
+        view = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    int error = errno;
+    ::close(fd);
+    if (view == MAP_FAILED)
+    {
+        std::cerr << "Error: cannot map market feed '" << path << "': " << std::strerror(error) << "\n";
+        shm_unlink(path.c_str());
+        return false;
+    }
+
+    mapping = static_cast<char *>(view);
+    mapped_size = size;
+    ticks = 0;
+
+    // The fresh pages are zero: every sequence reads as "never written"
+    MarketFeedHeader &h = header();
+    h.version = MARKET_FEED_VERSION;
+    h.slot_count = slot_count;
+    h.slot_size = sizeof(MarketFeedSlot);
+    h.published.store(0, std::memory_order_relaxed);
+    h.live.store(1, std::memory_order_relaxed);
+    h.magic.store(MARKET_FEED_MAGIC, std::memory_order_release);
+    return true;
+}
+
+void MarketFeedPublisher::close()
+{
+    if (mapping == nullptr)
+        return;
+
+    header().live.store(0, std::memory_order_release);
+    munmap(mapping, mapped_size);
+    shm_unlink(path.c_str());
+    mapping = nullptr;
+    mapped_size = 0;
+}
+
+void MarketFeedPublisher::publish(std::uint64_t step, double simulation_time, int symbol, double price,
+                                  const OrderBook &book, const ExecutedTrade *trades, size_t trade_count)
+{
+    if (mapping == nullptr)
+        return;
+
+    // Odd while the payload is written; readers that saw it or see it
+    // change under them discard their copy
+    MarketFeedSlot &s = slot(ticks);
+    s.sequence.store(2 * ticks + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    MarketFeedTick &tick = s.tick;
+    tick.step = step;
+    tick.simulation_time = simulation_time;
+    tick.symbol = symbol;
+    tick.price = price;
+    tick.best_bid = book.getBestBid();
+    tick.best_ask = book.getBestAsk();
+    tick.spread = book.getSpread();
+
+    auto bids = book.getBuyDepth(MARKET_FEED_DEPTH);
+    auto asks = book.getSellDepth(MARKET_FEED_DEPTH);
+    tick.bid_levels = static_cast<std::int32_t>(bids.size());
+    tick.ask_levels = static_cast<std::int32_t>(asks.size());
+    for (size_t i = 0; i < bids.size(); i++)
+        tick.bids[i] = MarketFeedLevel{bids[i].first, bids[i].second};
+    for (size_t i = 0; i < asks.size(); i++)
+        tick.asks[i] = MarketFeedLevel{asks[i].first, asks[i].second};
+
+    // The newest trades when there are more than fit
+    double volume = 0.0;
+    for (size_t i = 0; i < trade_count; i++)
+        volume += trades[i].price * trades[i].quantity;
+    size_t first = trade_count > MARKET_FEED_TRADES ? trade_count - MARKET_FEED_TRADES : 0;
+    for (size_t i = first; i < trade_count; i++)
+    {
+        const ExecutedTrade &trade = trades[i];
+        tick.trades[i - first] = MarketFeedTrade{trade.price, trade.timestamp, trade.quantity,
+                                                 trade.buyer_id, trade.seller_id, trade.trade_id};
+    }
+    tick.trade_count = static_cast<std::int32_t>(trade_count - first);
+    tick.step_trade_count = static_cast<std::int64_t>(trade_count);
+    tick.step_volume = volume;
+
+    ticks++;
+    s.sequence.store(2 * ticks, std::memory_order_release);
+    header().published.store(ticks, std::memory_order_release);
+}
@@ -1,216 +1,509 @@
 #include "../include/order_book.hpp"
-#include <omp.h>
+#include "../include/tick_order_book.hpp"
 #include <iostream>
+#include <cstring>
+#include <cmath>
 
-OrderBook::OrderBook() : next_order_id(1), next_trade_id(1)
+OrderBook::OrderBook()
+    : trade_retention(0), next_order_id(1), next_trade_id(1), next_sequence(0), matching_mode(MatchingMode::CONTINUOUS),
+      buy_order_count(0), sell_order_count(0), buy_quantity(0), sell_quantity(0)
 {
 }
 
-int OrderBook::addOrder(Order order)
+int OrderBook::addOrder(const Order &order)
 {
     std::lock_guard<std::mutex> lock(book_mutex);
 
-    order.order_id = next_order_id++;
+    Order resting = order;
+    resting.order_id = next_order_id++;
+    resting.price = snapPrice(resting.type, resting.price);
+    insertOrder(resting);
+    trackTimeInForce(resting);
 
-    if (order.type == OrderType::BUY)
+    return resting.order_id;
+}
+
+// First expiry tick at or after time, so an order never leaves early
+static std::uint64_t expiryTick(double time)
+{
+    return time > 0.0 ? static_cast<std::uint64_t>(std::ceil(time / OrderBook::EXPIRY_RESOLUTION)) : 0;
+}
+
+// Last expiry tick at or before now
+static std::uint64_t currentTick(double now)
+{
+    return now > 0.0 ? static_cast<std::uint64_t>(std::floor(now / OrderBook::EXPIRY_RESOLUTION)) : 0;
+}
+
+// Direct-mapped slot for a (side, price) key in the addOrders level cache
+static int bulkCacheSlot(OrderType side, double price, int slots)
+{
+    std::uint64_t bits;
+    std::memcpy(&bits, &price, sizeof(bits));
+    bits ^= static_cast<std::uint64_t>(side);
+    return static_cast<int>((bits * 0x9E3779B97F4A7C15ull) >> 58) & (slots - 1);
+}
+
+int OrderBook::addOrders(const Order *orders, std::size_t count)
+{
+    std::lock_guard<std::mutex> lock(book_mutex);
+
+    int first_id = next_order_id;
+    pool.reserve(static_cast<int>(count));
+
+    // Orders are queued in id order, so each level keeps arrival order. A
+    // small cache of the levels already seen in this batch groups orders by
+    // (side, price) without sorting, so each level is looked up about once.
+    BulkLevelSlot cache[BULK_LEVEL_CACHE] = {};
+    std::uint64_t allocations_seen = counters.allocations;
+
+    for (std::size_t i = 0; i < count; i++)
     {
-        buy_orders[order.price].push_back(order);
+        // The id must be set before allocate() registers it in the id index
+        Order resting = orders[i];
+        resting.order_id = next_order_id++;
+        resting.price = snapPrice(resting.type, resting.price);
+        int handle = pool.allocate(resting);
+        pool[handle].sequence = next_sequence++;
+        const Order &order = pool[handle].order;
+
+        BulkLevelSlot &slot = cache[bulkCacheSlot(order.type, order.price, BULK_LEVEL_CACHE)];
+        if (slot.level == nullptr || slot.side != order.type || slot.price != order.price)
+        {
+            PriceLevel &level = getOrCreateLevel(order.type, order.price);
+            counters.levels_touched++;
+
+            // A new level may have moved the cached ones (tick ring regrowth)
+            if (counters.allocations != allocations_seen)
+            {
+                allocations_seen = counters.allocations;
+                std::fill(std::begin(cache), std::end(cache), BulkLevelSlot{});
+            }
+            slot = {order.type, order.price, &level};
+        }
+
+        pool.pushBack(*slot.level, handle);
+        addSideTotals(order, 1);
+        trackTimeInForce(order);
     }
-    else
+
+    return first_id;
+}
+
+bool OrderBook::cancelOrder(int order_id)
+{
+    std::lock_guard<std::mutex> lock(book_mutex);
+
+    int handle = pool.find(order_id);
+    if (handle < 0)
+        return false;
+
+    pool[handle].order.status = OrderStatus::CANCELLED;
+    removeOrder(handle);
+    return true;
+}
+
+bool OrderBook::modifyOrder(int order_id, int new_quantity, double new_price)
+{
+    std::lock_guard<std::mutex> lock(book_mutex);
+
+    int handle = pool.find(order_id);
+    if (handle < 0)
+        return false;
+
+    Order &order = pool[handle].order;
+    new_price = snapPrice(order.type, new_price);
+
+    if (new_quantity <= order.filled_quantity)
+    {
+        order.status = OrderStatus::CANCELLED;
+        removeOrder(handle);
+        return true;
+    }
+
+    if (new_price == order.price && new_quantity <= order.quantity)
     {
-        sell_orders[order.price].push_back(order);
+        reduceResting(handle, order.quantity - new_quantity);
+        order.quantity = new_quantity;
+        return true;
     }
 
-    return order.order_id;
+    // Loses time priority: moved to the back of the target level as a new
+    // arrival. The order keeps its pool slot, so its id entry stays put and
+    // the re-queue costs the same however old the order is.
+    OrderNode &node = pool[handle];
+    PriceLevel *old_level = node.level;
+    double old_price = order.price;
+    addSideTotals(order, -1);
+    pool.unlink(handle);
+    if (old_level->head < 0)
+        removeLevel(order.type, old_price);
+
+    order.quantity = new_quantity;
+    order.price = new_price;
+    PriceLevel &level = getOrCreateLevel(order.type, new_price);
+    counters.levels_touched++;
+    node.sequence = next_sequence++;
+    pool.pushBack(level, handle);
+    addSideTotals(order, 1);
+    return true;
 }
 
-std::vector<ExecutedTrade> OrderBook::matchOrders()
+const Order *OrderBook::findOrder(int order_id) const
+{
+    int handle = pool.find(order_id);
+    if (handle < 0)
+        return nullptr;
+    return &pool[handle].order;
+}
+
+void OrderBook::insertOrder(const Order &order)
+{
+    PriceLevel &level = getOrCreateLevel(order.type, order.price);
+    counters.levels_touched++;
+    int handle = pool.allocate(order);
+    pool[handle].sequence = next_sequence++;
+    pool.pushBack(level, handle);
+    addSideTotals(order, 1);
+}
+
+void OrderBook::trackTimeInForce(const Order &order)
+{
+    if (order.time_in_force == TimeInForce::GTT)
+        expiry_wheel.schedule(order.order_id, expiryTick(order.expire_time));
+    else if (order.time_in_force != TimeInForce::GTC)
+        immediate_orders.push_back(order.order_id);
+}
+
+void OrderBook::expireOrder(int handle)
+{
+    Order &order = pool[handle].order;
+    order.status = OrderStatus::CANCELLED;
+    expired_orders.push_back(order);
+    removeOrder(handle);
+}
+
+int OrderBook::expireOrders(double now)
 {
     std::lock_guard<std::mutex> lock(book_mutex);
-    std::vector<ExecutedTrade> new_trades;
 
-    while (!buy_orders.empty() && !sell_orders.empty())
+    fired_timers.clear();
+    expiry_wheel.advance(currentTick(now), fired_timers);
+    std::sort(fired_timers.begin(), fired_timers.end());
+
+    // Filled, cancelled or already expired orders left their timers behind
+    int expired = 0;
+    for (int order_id : fired_timers)
     {
-        auto buy_it = buy_orders.begin();   // Highest buy price
-        auto sell_it = sell_orders.begin(); // Lowest sell price
+        int handle = pool.find(order_id);
+        if (handle < 0 || pool[handle].order.time_in_force != TimeInForce::GTT)
+            continue;
+        expireOrder(handle);
+        expired++;
+    }
+    counters.expired += expired;
+    return expired;
+}
 
-        double best_bid = buy_it->first;
-        double best_ask = sell_it->first;
+void OrderBook::takeExpiredOrders(std::vector<Order> &expired)
+{
+    std::lock_guard<std::mutex> lock(book_mutex);
+    expired.clear();
+    expired.swap(expired_orders);
+}
 
-        if (best_bid < best_ask)
-        {
-            break;
-        }
+void OrderBook::killUnfillable()
+{
+    for (int order_id : immediate_orders)
+    {
+        int handle = pool.find(order_id);
+        if (handle < 0 || pool[handle].order.time_in_force != TimeInForce::FOK)
+            continue;
 
-        std::vector<Order> &buy_list = buy_it->second;
-        std::vector<Order> &sell_list = sell_it->second;
+        const Order &order = pool[handle].order;
+        bool is_buy = order.type == OrderType::BUY;
+        int needed = order.getRemainingQuantity();
+        int available = 0;
+        visitLevels(is_buy ? OrderType::SELL : OrderType::BUY, [&](double price, const PriceLevel &level)
+                    {
+            if (is_buy ? price > order.price : price < order.price)
+                return false;
+            available += levelQuantity(level);
+            return available < needed; });
 
-        if (buy_list.empty() || sell_list.empty())
+        if (available < needed)
         {
-            if (buy_list.empty())
-                buy_orders.erase(buy_it);
-            if (sell_list.empty())
-                sell_orders.erase(sell_it);
-            continue;
+            expireOrder(handle);
+            counters.killed++;
         }
+    }
+}
 
-#pragma omp parallel for schedule(dynamic) if (buy_list.size() > 10)
-        for (int i = 0; i < buy_list.size(); i++)
-        {
-            Order &buy_order = buy_list[i];
-            if (buy_order.isFilled())
-                continue;
+void OrderBook::cancelImmediateRemainders()
+{
+    for (int order_id : immediate_orders)
+    {
+        int handle = pool.find(order_id);
+        if (handle < 0)
+            continue;
+        expireOrder(handle);
+        counters.killed++;
+    }
+    immediate_orders.clear();
+}
 
-#pragma omp critical
-            {
-                for (auto &sell_order : sell_list)
-                {
-                    if (sell_order.isFilled())
-                        continue;
-                    if (buy_order.isFilled())
-                        break;
+void OrderBook::addSideTotals(const Order &order, int sign)
+{
+    if (order.type == OrderType::BUY)
+    {
+        buy_order_count += sign;
+        buy_quantity += sign * order.getRemainingQuantity();
+    }
+    else
+    {
+        sell_order_count += sign;
+        sell_quantity += sign * order.getRemainingQuantity();
+    }
+}
+
+void OrderBook::reduceResting(int handle, int quantity)
+{
+    OrderNode &node = pool[handle];
+    node.level->quantity -= quantity;
+    if (node.order.type == OrderType::BUY)
+        buy_quantity -= quantity;
+    else
+        sell_quantity -= quantity;
+}
 
-                    // Match orders
-                    int match_quantity = std::min(
-                        buy_order.getRemainingQuantity(),
-                        sell_order.getRemainingQuantity());
+bool OrderBook::removeOrder(int handle)
+{
+    OrderNode &node = pool[handle];
+    PriceLevel *level = node.level;
+    OrderType side = node.order.type;
+    double price = node.order.price;
 
-                    if (match_quantity > 0)
-                    {
-                        ExecutedTrade trade;
-                        trade.trade_id = next_trade_id++;
-                        trade.buy_order_id = buy_order.order_id;
-                        trade.sell_order_id = sell_order.order_id;
-                        trade.buyer_id = buy_order.trader_id;
-                        trade.seller_id = sell_order.trader_id;
-                        trade.price = sell_order.price;
-                        trade.quantity = match_quantity;
-                        trade.timestamp = buy_order.timestamp;
-
-                        buy_order.filled_quantity += match_quantity;
-                        sell_order.filled_quantity += match_quantity;
-
-                        if (buy_order.isFilled())
-                        {
-                            buy_order.status = OrderStatus::FILLED;
-                        }
-                        else
-                        {
-                            buy_order.status = OrderStatus::PARTIALLY_FILLED;
-                        }
-
-                        if (sell_order.isFilled())
-                        {
-                            sell_order.status = OrderStatus::FILLED;
-                        }
-                        else
-                        {
-                            sell_order.status = OrderStatus::PARTIALLY_FILLED;
-                        }
-
-                        new_trades.push_back(trade);
-                        executed_trades.push_back(trade);
-                    }
-                }
-            }
-        }
+    addSideTotals(node.order, -1);
+    pool.unlink(handle);
+    pool.release(handle);
 
-        buy_list.erase(
-            std::remove_if(buy_list.begin(), buy_list.end(),
-                           [](const Order &o)
-                           { return o.isFilled(); }),
-            buy_list.end());
-
-        sell_list.erase(
-            std::remove_if(sell_list.begin(), sell_list.end(),
-                           [](const Order &o)
-                           { return o.isFilled(); }),
-            sell_list.end());
-
-        if (buy_list.empty())
-            buy_orders.erase(buy_it);
-        if (sell_list.empty())
-            sell_orders.erase(sell_it);
+    if (level->head < 0)
+    {
+        removeLevel(side, price);
+        return true;
     }
-
-    return new_trades;
+    return false;
 }
 
-void OrderBook::cleanupFilledOrders()
+std::vector<ExecutedTrade> OrderBook::matchOrders()
 {
     std::lock_guard<std::mutex> lock(book_mutex);
+    std::vector<ExecutedTrade> new_trades;
 
-    for (auto it = buy_orders.begin(); it != buy_orders.end();)
+    if (!immediate_orders.empty())
+        killUnfillable();
+
+    if (matching_mode == MatchingMode::BATCH_AUCTION)
     {
-        auto &orders = it->second;
-        orders.erase(
-            std::remove_if(orders.begin(), orders.end(),
-                           [](const Order &o)
-                           { return o.isFilled(); }),
-            orders.end());
-
-        if (orders.empty())
-        {
-            it = buy_orders.erase(it);
-        }
-        else
-        {
-            ++it;
-        }
+        matchBatchAuction(new_trades);
     }
+    else
+    {
+        matchContinuous(new_trades);
+    }
+
+    if (!immediate_orders.empty())
+        cancelImmediateRemainders();
 
-    for (auto it = sell_orders.begin(); it != sell_orders.end();)
+    return new_trades;
+}
+
+void OrderBook::crossBook(std::vector<ExecutedTrade> &new_trades, bool uniform_price, double clearing_price)
+{
+    while (true)
     {
-        auto &orders = it->second;
-        orders.erase(
-            std::remove_if(orders.begin(), orders.end(),
-                           [](const Order &o)
-                           { return o.isFilled(); }),
-            orders.end());
-
-        if (orders.empty())
+        PriceLevel *bid_level = bestLevel(OrderType::BUY);
+        PriceLevel *ask_level = bestLevel(OrderType::SELL);
+
+        if (bid_level == nullptr || ask_level == nullptr ||
+            bestPrice(OrderType::BUY) < bestPrice(OrderType::SELL))
         {
-            it = sell_orders.erase(it);
+            break;
         }
-        else
+
+        // Stay on these two levels until one of them empties
+        counters.levels_touched += 2;
+        bool level_removed = false;
+        while (!level_removed)
         {
-            ++it;
+            int buy_handle = bid_level->head;
+            int sell_handle = ask_level->head;
+            Order &buy_order = pool[buy_handle].order;
+            Order &sell_order = pool[sell_handle].order;
+
+            // The earlier arrival is resting and sets the price, the later one
+            // is the aggressor; a modified order arrives again when re-queued
+            bool buy_rests = pool[buy_handle].sequence < pool[sell_handle].sequence;
+            double price = uniform_price ? clearing_price : (buy_rests ? buy_order.price : sell_order.price);
+            double timestamp = buy_rests ? sell_order.timestamp : buy_order.timestamp;
+
+            int match_quantity = std::min(
+                buy_order.getRemainingQuantity(),
+                sell_order.getRemainingQuantity());
+
+            fillOrders(buy_order, sell_order, match_quantity, price, timestamp, new_trades);
+            if (match_quantity > 0)
+            {
+                reduceResting(buy_handle, match_quantity);
+                reduceResting(sell_handle, match_quantity);
+            }
+
+            bool buy_done = buy_order.isFilled();
+            bool sell_done = sell_order.isFilled();
+            if (buy_done)
+                level_removed |= removeOrder(buy_handle);
+            if (sell_done)
+                level_removed |= removeOrder(sell_handle);
         }
     }
 }
 
-int OrderBook::getBuyOrderCount() const
+void OrderBook::matchContinuous(std::vector<ExecutedTrade> &new_trades)
 {
-    int count = 0;
-    for (const auto &[price, orders] : buy_orders)
+    crossBook(new_trades, false, 0.0);
+}
+
+void OrderBook::matchBatchAuction(std::vector<ExecutedTrade> &new_trades)
+{
+    if (buy_order_count == 0 || sell_order_count == 0)
+        return;
+
+    double best_bid = bestPrice(OrderType::BUY);
+    double best_ask = bestPrice(OrderType::SELL);
+    if (best_bid < best_ask)
+        return;
+
+    auto bid_levels = crossingLevels(OrderType::BUY, best_ask);
+    auto ask_levels = crossingLevels(OrderType::SELL, best_bid);
+    counters.levels_touched += bid_levels.size() + ask_levels.size();
+
+    AuctionResult auction = crossAggregates(bid_levels, ask_levels);
+    if (auction.volume == 0)
+        return;
+
+    // Any price between the marginal ask and bid clears the same volume.
+    // Snapping as a bid rounds down, which never falls below the marginal ask.
+    double clearing_price = snapPrice(OrderType::BUY, (auction.marginal_bid + auction.marginal_ask) / 2.0);
+    crossBook(new_trades, true, clearing_price);
+}
+
+void OrderBook::fillOrders(Order &buy_order, Order &sell_order, int quantity, double price,
+                           double timestamp, std::vector<ExecutedTrade> &new_trades)
+{
+    if (quantity <= 0)
+        return;
+
+    ExecutedTrade trade;
+    trade.trade_id = next_trade_id++;
+    trade.buy_order_id = buy_order.order_id;
+    trade.sell_order_id = sell_order.order_id;
+    trade.buyer_id = buy_order.trader_id;
+    trade.seller_id = sell_order.trader_id;
+    trade.price = price;
+    trade.quantity = quantity;
+    trade.timestamp = timestamp;
+
+    buy_order.filled_quantity += quantity;
+    sell_order.filled_quantity += quantity;
+    buy_order.status = buy_order.isFilled() ? OrderStatus::FILLED : OrderStatus::PARTIALLY_FILLED;
+    sell_order.status = sell_order.isFilled() ? OrderStatus::FILLED : OrderStatus::PARTIALLY_FILLED;
+
+    new_trades.push_back(trade);
+
+    trade_totals.count++;
+    trade_totals.volume += trade.quantity * trade.price;
+    trade_totals.price_sum += trade.price;
+    if (trade_retention > 0)
     {
-        count += orders.size();
+        if (recent_trades.size() == trade_retention)
+            recent_trades.pop_front();
+        recent_trades.push_back(trade);
     }
-    return count;
 }
 
-int OrderBook::getSellOrderCount() const
+void OrderBook::setTradeRetention(size_t count)
+{
+    std::lock_guard<std::mutex> lock(book_mutex);
+    trade_retention = count;
+    while (recent_trades.size() > trade_retention)
+        recent_trades.pop_front();
+}
+
+AuctionResult OrderBook::crossAggregates(const std::vector<std::pair<double, int>> &bid_levels,
+                                         const std::vector<std::pair<double, int>> &ask_levels)
 {
-    int count = 0;
-    for (const auto &[price, orders] : sell_orders)
+    AuctionResult result;
+    size_t b = 0;
+    size_t a = 0;
+    int bid_left = bid_levels.empty() ? 0 : bid_levels[0].second;
+    int ask_left = ask_levels.empty() ? 0 : ask_levels[0].second;
+
+    // Walking both cumulative curves from the best price inwards, the point
+    // where they stop crossing is where executable volume is maximised
+    while (b < bid_levels.size() && a < ask_levels.size() && bid_levels[b].first >= ask_levels[a].first)
     {
-        count += orders.size();
+        int quantity = std::min(bid_left, ask_left);
+        if (quantity > 0)
+        {
+            result.volume += quantity;
+            result.marginal_bid = bid_levels[b].first;
+            result.marginal_ask = ask_levels[a].first;
+            bid_left -= quantity;
+            ask_left -= quantity;
+        }
+
+        if (bid_left == 0 && ++b < bid_levels.size())
+            bid_left = bid_levels[b].second;
+        if (ask_left == 0 && ++a < ask_levels.size())
+            ask_left = ask_levels[a].second;
     }
-    return count;
+
+    return result;
 }
 
-double OrderBook::getBestBid() const
+std::vector<std::pair<double, int>> OrderBook::crossingLevels(OrderType side, double limit_price) const
 {
-    if (buy_orders.empty())
-        return 0.0;
-    return buy_orders.begin()->first;
+    std::vector<std::pair<double, int>> levels;
+
+    visitLevels(side, [&](double price, const PriceLevel &level)
+                {
+        if (side == OrderType::BUY ? price < limit_price : price > limit_price)
+            return false;
+        levels.push_back({price, levelQuantity(level)});
+        return true; });
+
+    return levels;
 }
 
-double OrderBook::getBestAsk() const
+std::vector<std::pair<double, int>> OrderBook::getDepth(OrderType side, int levels) const
 {
-    if (sell_orders.empty())
-        return 0.0;
-    return sell_orders.begin()->first;
+    std::vector<std::pair<double, int>> depth;
+    if (levels <= 0)
+        return depth;
+
+    visitLevels(side, [&](double price, const PriceLevel &level)
+                {
+        depth.push_back({price, levelQuantity(level)});
+        return static_cast<int>(depth.size()) < levels; });
+
+    return depth;
+}
+
+BookCounters OrderBook::getCounters() const
+{
+    BookCounters result = counters;
+    result.allocations += pool.getSlabCount();
+    return result;
 }
 
 double OrderBook::getSpread() const
@@ -222,48 +515,228 @@ double OrderBook::getSpread() const
     return ask - bid;
 }
 
-std::vector<std::pair<double, int>> OrderBook::getBuyDepth(int levels) const
+std::unique_ptr<OrderBook> createOrderBook(OrderBookType type, double tick_size)
 {
-    std::vector<std::pair<double, int>> depth;
-    int count = 0;
+    if (type == OrderBookType::TICK)
+    {
+        return std::make_unique<TickOrderBook>(tick_size);
+    }
+    return std::make_unique<MapOrderBook>();
+}
 
-    for (const auto &[price, orders] : buy_orders)
+PriceLevel &MapOrderBook::getOrCreateLevel(OrderType side, double price)
+{
+    if (side == OrderType::BUY)
     {
-        if (count >= levels)
-            break;
+        auto [it, inserted] = buy_levels.try_emplace(price);
+        counters.allocations += inserted;
+        return it->second;
+    }
+    auto [it, inserted] = sell_levels.try_emplace(price);
+    counters.allocations += inserted;
+    return it->second;
+}
+
+void MapOrderBook::removeLevel(OrderType side, double price)
+{
+    if (side == OrderType::BUY)
+        buy_levels.erase(price);
+    else
+        sell_levels.erase(price);
+}
 
-        int total_quantity = 0;
-        for (const auto &order : orders)
+PriceLevel *MapOrderBook::bestLevel(OrderType side)
+{
+    if (side == OrderType::BUY)
+        return buy_levels.empty() ? nullptr : &buy_levels.begin()->second;
+    return sell_levels.empty() ? nullptr : &sell_levels.begin()->second;
+}
+
+double MapOrderBook::bestPrice(OrderType side) const
+{
+    if (side == OrderType::BUY)
+        return buy_levels.empty() ? 0.0 : buy_levels.begin()->first;
+    return sell_levels.empty() ? 0.0 : sell_levels.begin()->first;
+}
+
+void MapOrderBook::visitLevels(OrderType side, const LevelVisitor &visit) const
+{
+    if (side == OrderType::BUY)
+    {
+        for (const auto &[price, level] : buy_levels)
         {
-            total_quantity += order.getRemainingQuantity();
+            if (!visit(price, level))
+                break;
+        }
+    }
+    else
+    {
+        for (const auto &[price, level] : sell_levels)
+        {
+            if (!visit(price, level))
+                break;
         }
-
-        depth.push_back({price, total_quantity});
-        count++;
     }
+}
 
-    return depth;
+void OrderBook::saveSide(CheckpointWriter &out, OrderType side) const
+{
+    std::vector<double> prices;
+    std::vector<int> sizes;
+    std::vector<Order> orders;
+    std::vector<std::uint64_t> sequences;
+
+    visitLevels(side, [&](double price, const PriceLevel &level)
+                {
+        prices.push_back(price);
+        sizes.push_back(level.order_count);
+        for (int handle = level.head; handle >= 0; handle = pool[handle].next)
+        {
+            orders.push_back(pool[handle].order);
+            sequences.push_back(pool[handle].sequence);
+        }
+        return true; });
+
+    out.putVector(prices);
+    out.putVector(sizes);
+    out.putVector(orders);
+    out.putVector(sequences);
 }
 
-std::vector<std::pair<double, int>> OrderBook::getSellDepth(int levels) const
+void OrderBook::saveState(CheckpointWriter &out) const
 {
-    std::vector<std::pair<double, int>> depth;
-    int count = 0;
+    out.put(matching_mode);
+    out.put(next_order_id);
+    out.put(next_trade_id);
+    out.put(next_sequence);
+    out.put(counters);
+    out.put(trade_totals);
+    out.put(static_cast<std::uint64_t>(trade_retention));
+    std::vector<ExecutedTrade> retained(recent_trades.begin(), recent_trades.end());
+    out.putVector(retained);
+    out.put(expiry_wheel.getCurrentTick());
+    out.putVector(immediate_orders);
+    out.putVector(expired_orders);
+    saveSide(out, OrderType::BUY);
+    saveSide(out, OrderType::SELL);
+}
+
+void OrderBook::loadState(CheckpointReader &in)
+{
+    std::lock_guard<std::mutex> lock(book_mutex);
 
-    for (const auto &[price, orders] : sell_orders)
+    if (pool.getLiveCount() != 0)
     {
-        if (count >= levels)
-            break;
+        in.fail();
+        return;
+    }
 
-        int total_quantity = 0;
-        for (const auto &order : orders)
+    matching_mode = in.get<MatchingMode>();
+    next_order_id = in.get<int>();
+    next_trade_id = in.get<int>();
+    next_sequence = in.get<std::uint64_t>();
+    BookCounters saved_counters = in.get<BookCounters>();
+    trade_totals = in.get<TradeTotals>();
+    trade_retention = static_cast<size_t>(in.get<std::uint64_t>());
+    size_t retained_count = 0;
+    const ExecutedTrade *retained = in.getArray<ExecutedTrade>(retained_count);
+    recent_trades.assign(retained, retained + retained_count);
+    std::uint64_t expiry_tick = in.get<std::uint64_t>();
+    in.getVector(immediate_orders);
+    in.getVector(expired_orders);
+
+    struct SavedSide
+    {
+        const double *prices;
+        const int *sizes;
+        const Order *orders;
+        const std::uint64_t *sequences;
+        size_t level_count;
+        size_t order_count;
+    };
+    SavedSide sides[2];
+    for (int s = 0; s < 2; s++)
+    {
+        SavedSide &side = sides[s];
+        size_t size_count = 0;
+        side.prices = in.getArray<double>(side.level_count);
+        side.sizes = in.getArray<int>(size_count);
+        side.orders = in.getArray<Order>(side.order_count);
+        size_t sequence_count = 0;
+        side.sequences = in.getArray<std::uint64_t>(sequence_count);
+        if (sequence_count != side.order_count)
+            in.fail();
+
+        // Every level must be non-empty and every order on its own side
+        long long total = 0;
+        for (size_t i = 0; i < size_count; i++)
+        {
+            if (side.sizes[i] <= 0)
+                in.fail();
+            total += side.sizes[i];
+        }
+        OrderType type = s == 0 ? OrderType::BUY : OrderType::SELL;
+        for (size_t i = 0; i < side.order_count; i++)
+        {
+            if (side.orders[i].type != type)
+                in.fail();
+        }
+        if (size_count != side.level_count || total != static_cast<long long>(side.order_count))
+            in.fail();
+    }
+    if (!in.ok())
+        return;
+
+    // Allocated in id order, so the pool's id index grows at one end and
+    // duplicates are caught; queue order can differ from id order (modify
+    // re-queues), so the queues are linked afterwards
+    std::vector<const Order *> by_id;
+    by_id.reserve(sides[0].order_count + sides[1].order_count);
+    for (const SavedSide &side : sides)
+    {
+        for (size_t i = 0; i < side.order_count; i++)
+            by_id.push_back(&side.orders[i]);
+    }
+    std::sort(by_id.begin(), by_id.end(), [](const Order *a, const Order *b)
+              { return a->order_id < b->order_id; });
+    for (size_t i = 0; i < by_id.size(); i++)
+    {
+        int id = by_id[i]->order_id;
+        if (id <= 0 || id >= next_order_id || (i > 0 && id == by_id[i - 1]->order_id))
         {
-            total_quantity += order.getRemainingQuantity();
+            in.fail();
+            return;
         }
+    }
 
-        depth.push_back({price, total_quantity});
-        count++;
+    // Timers of orders no longer resting were only ever skipped, so
+    // rescheduling the resting GTT orders restores the wheel
+    pool.reserve(static_cast<int>(by_id.size()));
+    expiry_wheel.reset(expiry_tick);
+    for (const Order *order : by_id)
+    {
+        pool.allocate(*order);
+        if (order->time_in_force == TimeInForce::GTT)
+            expiry_wheel.schedule(order->order_id, expiryTick(order->expire_time));
     }
 
-    return depth;
+    for (int s = 0; s < 2; s++)
+    {
+        OrderType type = s == 0 ? OrderType::BUY : OrderType::SELL;
+        const SavedSide &side = sides[s];
+        const Order *order = side.orders;
+        for (size_t l = 0; l < side.level_count; l++)
+        {
+            PriceLevel &level = getOrCreateLevel(type, side.prices[l]);
+            for (int i = 0; i < side.sizes[l]; i++, order++)
+            {
+                int handle = pool.find(order->order_id);
+                pool[handle].sequence = side.sequences[order - side.orders];
+                pool.pushBack(level, handle);
+                addSideTotals(*order, 1);
+            }
+        }
+    }
+
+    counters = saved_counters;
 }
@@ -0,0 +1,134 @@
+#include "../include/order_pool.hpp"
+
+OrderPool::OrderPool() : capacity(0), free_head(-1), live_count(0), id_base(0)
+{
+}
+
+void OrderPool::addSlab()
+{
+    slabs.push_back(std::make_unique<OrderNode[]>(SLAB_SIZE));
+
+    // Thread the new slots onto the free list in index order
+    int first = capacity;
+    capacity += SLAB_SIZE;
+    for (int handle = capacity - 1; handle >= first; handle--)
+    {
+        (*this)[handle].next = free_head;
+        free_head = handle;
+    }
+}
+
+void OrderPool::reserve(int count)
+{
+    while (capacity - live_count < count)
+    {
+        addSlab();
+    }
+}
+
+int OrderPool::allocate(const Order &order)
+{
+    if (free_head < 0)
+    {
+        addSlab();
+    }
+
+    int handle = free_head;
+    OrderNode &node = (*this)[handle];
+    free_head = node.next;
+
+    node.order = order;
+    node.sequence = 0;
+    node.level = nullptr;
+    node.prev = -1;
+    node.next = -1;
+    live_count++;
+
+    if (id_to_handle.empty())
+    {
+        id_base = order.order_id;
+    }
+    while (order.order_id < id_base)
+    {
+        id_to_handle.push_front(-1);
+        id_base--;
+    }
+    while (id_base + static_cast<int>(id_to_handle.size()) <= order.order_id)
+    {
+        id_to_handle.push_back(-1);
+    }
+    id_to_handle[order.order_id - id_base] = handle;
+
+    return handle;
+}
+
+void OrderPool::release(int handle)
+{
+    OrderNode &node = (*this)[handle];
+
+    int order_id = node.order.order_id;
+    if (order_id >= id_base && order_id - id_base < static_cast<int>(id_to_handle.size()))
+    {
+        id_to_handle[order_id - id_base] = -1;
+    }
+    while (!id_to_handle.empty() && id_to_handle.front() < 0)
+    {
+        id_to_handle.pop_front();
+        id_base++;
+    }
+
+    node.level = nullptr;
+    node.prev = -1;
+    node.next = free_head;
+    free_head = handle;
+    live_count--;
+}
+
+int OrderPool::find(int order_id) const
+{
+    if (order_id < id_base || order_id - id_base >= static_cast<int>(id_to_handle.size()))
+        return -1;
+    return id_to_handle[order_id - id_base];
+}
+
+void OrderPool::pushBack(PriceLevel &level, int handle)
+{
+    OrderNode &node = (*this)[handle];
+    node.level = &level;
+    node.prev = level.tail;
+    node.next = -1;
+
+    if (level.tail >= 0)
+    {
+        (*this)[level.tail].next = handle;
+    }
+    else
+    {
+        level.head = handle;
+    }
+    level.tail = handle;
+    level.order_count++;
+    level.quantity += node.order.getRemainingQuantity();
+}
+
+void OrderPool::unlink(int handle)
+{
+    OrderNode &node = (*this)[handle];
+    PriceLevel &level = *node.level;
+
+    if (node.prev >= 0)
+        (*this)[node.prev].next = node.next;
+    else
+        level.head = node.next;
+
+    if (node.next >= 0)
+        (*this)[node.next].prev = node.prev;
+    else
+        level.tail = node.prev;
+
+    level.order_count--;
+    level.quantity -= node.order.getRemainingQuantity();
+    node.level = nullptr;
+    node.prev = -1;
+    node.next = -1;
+}
@@ -0,0 +1,103 @@
+#include "../include/profiler.hpp"
+#include <algorithm>
+#include <cmath>
+
+const char *stepPhaseName(StepPhase phase)
+{
+    switch (phase)
+    {
+    case StepPhase::INDICATORS:
+        return "indicators";
+    case StepPhase::GENERATE:
+        return "generate";
+    case StepPhase::INSERT:
+        return "insert";
+    case StepPhase::MATCH:
+        return "match";
+    case StepPhase::SETTLE:
+        return "settle";
+    case StepPhase::MARKET:
+        return "market";
+    case StepPhase::FEED:
+        return "feed";
+    case StepPhase::PERIODIC_LOG:
+        return "periodic log";
+    default:
+        return "unknown";
+    }
+}
+
+int LatencyHistogram::bucketFor(std::uint64_t ns)
+{
+    if (ns < SUB_COUNT)
+        return static_cast<int>(ns);
+
+    // Top SUB_BITS bits below the leading one pick the sub-bucket
+    int msb = 63 - __builtin_clzll(ns);
+    int sub = static_cast<int>((ns >> (msb - SUB_BITS)) & (SUB_COUNT - 1));
+    return (msb - SUB_BITS + 1) * SUB_COUNT + sub;
+}
+
+std::uint64_t LatencyHistogram::bucketUpperBound(int bucket)
+{
+    if (bucket < SUB_COUNT)
+        return static_cast<std::uint64_t>(bucket);
+
+    int msb = bucket / SUB_COUNT + SUB_BITS - 1;
+    std::uint64_t sub = bucket % SUB_COUNT;
+    std::uint64_t width = std::uint64_t(1) << (msb - SUB_BITS);
+    return ((SUB_COUNT + sub) << (msb - SUB_BITS)) + width - 1;
+}
+
+void LatencyHistogram::record(std::uint64_t ns)
+{
+    buckets[bucketFor(ns)]++;
+    count++;
+    total_ns += ns;
+    max_ns = std::max(max_ns, ns);
+}
+
+std::uint64_t LatencyHistogram::percentile(double q) const
+{
+    if (count == 0)
+        return 0;
+
+    std::uint64_t rank = static_cast<std::uint64_t>(std::ceil(std::clamp(q, 0.0, 1.0) * count));
+    rank = std::max<std::uint64_t>(rank, 1);
+
+    std::uint64_t seen = 0;
+    for (int bucket = 0; bucket < BUCKET_COUNT; bucket++)
+    {
+        seen += buckets[bucket];
+        if (seen >= rank)
+            return std::min(bucketUpperBound(bucket), max_ns);
+    }
+    return max_ns;
+}
+
+void StepProfiler::reset()
+{
+    for (auto &phase : phases)
+        phase = LatencyHistogram();
+    counters = StepCounters();
+}
+
+StepProfileSummary StepProfiler::summarize() const
+{
+    StepProfileSummary summary;
+    summary.enabled = enabled && PROFILING_COMPILED;
+    summary.counters = counters;
+
+    for (int i = 0; i < STEP_PHASE_COUNT; i++)
+    {
+        const LatencyHistogram &histogram = phases[i];
+        PhaseSummary &phase = summary.phases[i];
+        phase.samples = histogram.getCount();
+        phase.total_us = histogram.getTotal() / 1000.0;
+        phase.p50_us = histogram.percentile(0.50) / 1000.0;
+        phase.p99_us = histogram.percentile(0.99) / 1000.0;
+        phase.max_us = histogram.getMax() / 1000.0;
+    }
+
+    return summary;
+}
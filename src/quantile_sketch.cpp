@@ -0,0 +1,149 @@
+#include "../include/quantile_sketch.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+static constexpr double PI = 3.14159265358979323846;
+
+// k1 scale function: centroid k-size is limited to 1, which bounds a
+// centroid's weight by about q(1 - q) * total / COMPRESSION
+static double scaleK(double q)
+{
+    return QuantileSketch::COMPRESSION / (2.0 * PI) * std::asin(2.0 * q - 1.0);
+}
+
+static double scaleQ(double k)
+{
+    double quarter = QuantileSketch::COMPRESSION / 4.0;
+    if (k >= quarter)
+        return 1.0;
+    return (std::sin(k * 2.0 * PI / QuantileSketch::COMPRESSION) + 1.0) / 2.0;
+}
+
+QuantileSketch::QuantileSketch()
+    : means{}, weights{}, centroid_count(0), compressed(true), total_weight(0.0),
+      min_value(std::numeric_limits<double>::infinity()), max_value(-std::numeric_limits<double>::infinity())
+{
+}
+
+void QuantileSketch::append(double mean, double weight)
+{
+    if (centroid_count == CAPACITY)
+        compress();
+    means[centroid_count] = mean;
+    weights[centroid_count] = weight;
+    centroid_count++;
+    compressed = false;
+}
+
+void QuantileSketch::add(double value)
+{
+    append(value, 1.0);
+    total_weight += 1.0;
+    min_value = std::min(min_value, value);
+    max_value = std::max(max_value, value);
+}
+
+void QuantileSketch::merge(const QuantileSketch &other)
+{
+    for (int i = 0; i < other.centroid_count; i++)
+    {
+        append(other.means[i], other.weights[i]);
+    }
+    total_weight += other.total_weight;
+    min_value = std::min(min_value, other.min_value);
+    max_value = std::max(max_value, other.max_value);
+}
+
+void QuantileSketch::compress()
+{
+    if (compressed || centroid_count == 0)
+        return;
+
+    // Sort by mean; equal means keep their insertion order so results are reproducible
+    int order[CAPACITY];
+    for (int i = 0; i < centroid_count; i++)
+        order[i] = i;
+    std::stable_sort(order, order + centroid_count, [this](int a, int b)
+                     { return means[a] < means[b]; });
+
+    // Summed here rather than taken from total_weight, which merge() only
+    // updates after its appends
+    double sorted_means[CAPACITY] = {};
+    double sorted_weights[CAPACITY] = {};
+    double weight_sum = 0.0;
+    for (int i = 0; i < centroid_count; i++)
+    {
+        sorted_means[i] = means[order[i]];
+        sorted_weights[i] = weights[order[i]];
+        weight_sum += sorted_weights[i];
+    }
+
+    // Greedily merge neighbours while the merged centroid stays within one
+    // unit of k from where it starts
+    int out = 0;
+    double weight_before = 0.0;
+    double q_limit = scaleQ(scaleK(0.0) + 1.0);
+    means[0] = sorted_means[0];
+    weights[0] = sorted_weights[0];
+
+    for (int i = 1; i < centroid_count; i++)
+    {
+        double proposed = (weight_before + weights[out] + sorted_weights[i]) / weight_sum;
+        if (proposed <= q_limit)
+        {
+            double merged = weights[out] + sorted_weights[i];
+            means[out] += (sorted_means[i] - means[out]) * sorted_weights[i] / merged;
+            weights[out] = merged;
+        }
+        else
+        {
+            weight_before += weights[out];
+            q_limit = scaleQ(scaleK(weight_before / weight_sum) + 1.0);
+            out++;
+            means[out] = sorted_means[i];
+            weights[out] = sorted_weights[i];
+        }
+    }
+
+    centroid_count = out + 1;
+    compressed = true;
+}
+
+double QuantileSketch::quantile(double q) const
+{
+    if (centroid_count == 0)
+        return 0.0;
+    if (!compressed)
+    {
+        QuantileSketch sorted = *this;
+        sorted.compress();
+        return sorted.quantile(q);
+    }
+
+    q = std::max(0.0, std::min(q, 1.0));
+    if (centroid_count == 1)
+        return means[0];
+
+    // Interpolate between centroid centres, and from the outer centres to min/max
+    double target = q * total_weight;
+    double first_centre = weights[0] / 2.0;
+    if (target <= first_centre)
+        return min_value + (means[0] - min_value) * (target / first_centre);
+
+    double centre = first_centre;
+    for (int i = 0; i + 1 < centroid_count; i++)
+    {
+        double next_centre = centre + (weights[i] + weights[i + 1]) / 2.0;
+        if (target <= next_centre)
+        {
+            double t = (target - centre) / (next_centre - centre);
+            return means[i] + (means[i + 1] - means[i]) * t;
+        }
+        centre = next_centre;
+    }
+
+    double last_weight = weights[centroid_count - 1] / 2.0;
+    double t = std::min((target - centre) / last_weight, 1.0);
+    return means[centroid_count - 1] + (max_value - means[centroid_count - 1]) * t;
+}
@@ -0,0 +1,401 @@
+#include "../include/replay.hpp"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static constexpr std::uint64_t FNV_OFFSET = 0xcbf29ce484222325ull;
+static constexpr std::uint64_t FNV_PRIME = 0x100000001b3ull;
+
+// Column names per field, as DataLogger writes them
+static const char *const FIELD_NAMES[] = {"Step", "Timestamp", "TraderID", "Side",
+                                          "BuyerID", "SellerID", "Price", "Quantity",
+                                          "TimeInForce", "ExpireTime"};
+
+// TimeInForce text as the CSV orders log writes it, enum order
+static const char *const TIME_IN_FORCE_NAMES[] = {"GTC", "GTT", "IOC", "FOK"};
+
+static bool parseInt(const char *first, const char *last, long long &value)
+{
+    auto result = std::from_chars(first, last, value);
+    return result.ec == std::errc() && result.ptr == last;
+}
+
+static bool parseDouble(const char *first, const char *last, double &value)
+{
+    auto result = std::from_chars(first, last, value);
+    return result.ec == std::errc() && result.ptr == last;
+}
+
+// BUY/SELL as the CSV orders log writes it, 0/1 as the binary one does
+static bool parseSide(const char *first, const char *last, bool &is_buy)
+{
+    size_t length = last - first;
+    if ((length == 3 && std::memcmp(first, "BUY", 3) == 0) || (length == 1 && *first == '0'))
+        is_buy = true;
+    else if ((length == 4 && std::memcmp(first, "SELL", 4) == 0) || (length == 1 && *first == '1'))
+        is_buy = false;
+    else
+        return false;
+    return true;
+}
+
+// GTC/GTT/IOC/FOK, or the enum value as the binary log stores it
+static bool parseTimeInForce(const char *first, const char *last, TimeInForce &time_in_force)
+{
+    size_t length = last - first;
+    for (int i = 0; i < 4; i++)
+    {
+        if ((length == 3 && std::memcmp(first, TIME_IN_FORCE_NAMES[i], 3) == 0) || (length == 1 && *first == '0' + i))
+        {
+            time_in_force = static_cast<TimeInForce>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+static std::uint64_t mixChecksum(std::uint64_t hash, std::uint64_t word)
+{
+    return (hash ^ word) * FNV_PRIME;
+}
+
+OrderFlowReader::OrderFlowReader()
+    : format(OrderFlowFormat::ORDERS), rows_read(0), map_data(nullptr), map_size(0), position(0),
+      binary(false), block_rows(0), block_row(0), has_pending(false)
+{
+    std::fill(field_columns, field_columns + FIELD_COUNT, -1);
+}
+
+OrderFlowReader::~OrderFlowReader()
+{
+    close();
+}
+
+void OrderFlowReader::close()
+{
+    if (map_data)
+        munmap(const_cast<char *>(map_data), map_size);
+    map_data = nullptr;
+    map_size = 0;
+    position = 0;
+    binary = false;
+    block_rows = 0;
+    block_row = 0;
+    has_pending = false;
+    rows_read = 0;
+}
+
+bool OrderFlowReader::bindColumns(const std::vector<std::string> &names)
+{
+    std::fill(field_columns, field_columns + FIELD_COUNT, -1);
+    for (size_t c = 0; c < names.size(); c++)
+    {
+        for (int f = 0; f < FIELD_COUNT; f++)
+        {
+            if (names[c] == FIELD_NAMES[f])
+                field_columns[f] = static_cast<int>(c);
+        }
+    }
+
+    bool priced = field_columns[TIMESTAMP] >= 0 && field_columns[PRICE] >= 0 && field_columns[QUANTITY] >= 0;
+    if (priced && field_columns[STEP] >= 0 && field_columns[TRADER_ID] >= 0 && field_columns[SIDE] >= 0)
+    {
+        format = OrderFlowFormat::ORDERS;
+        return true;
+    }
+    if (priced && field_columns[BUYER_ID] >= 0 && field_columns[SELLER_ID] >= 0)
+    {
+        format = OrderFlowFormat::TRADES;
+        return true;
+    }
+    return false;
+}
+
+bool OrderFlowReader::open(const std::string &filename)
+{
+    close();
+
+    if (binary_reader.open(filename))
+    {
+        binary = true;
+        std::vector<std::string> names;
+        for (const auto &column : binary_reader.getColumns())
+            names.push_back(column.name);
+        return bindColumns(names);
+    }
+
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat info;
+    void *mapping = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && info.st_size > 0)
+        mapping = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED)
+        return false;
+
+    map_data = static_cast<const char *>(mapping);
+    map_size = static_cast<size_t>(info.st_size);
+    madvise(mapping, map_size, MADV_SEQUENTIAL);
+
+    // Header line
+    const char *end = static_cast<const char *>(std::memchr(map_data, '\n', map_size));
+    const char *header_end = end ? end : map_data + map_size;
+    position = end ? (end - map_data) + 1 : map_size;
+
+    std::vector<std::string> names;
+    const char *field = map_data;
+    for (const char *at = map_data; at <= header_end; at++)
+    {
+        if (at == header_end || *at == ',')
+        {
+            const char *field_end = (at > field && at[-1] == '\r') ? at - 1 : at;
+            names.emplace_back(field, field_end);
+            field = at + 1;
+        }
+    }
+    return bindColumns(names);
+}
+
+int OrderFlowReader::readCsvRow(Row &row)
+{
+    // Skip blank lines
+    while (position < map_size && (map_data[position] == '\n' || map_data[position] == '\r'))
+        position++;
+    if (position >= map_size)
+        return 0;
+
+    const char *line = map_data + position;
+    const char *line_end = static_cast<const char *>(std::memchr(line, '\n', map_size - position));
+    if (!line_end)
+        line_end = map_data + map_size;
+    position = (line_end - map_data) + 1;
+    if (line_end > line && line_end[-1] == '\r')
+        line_end--;
+
+    int column = 0;
+    int fields_seen = 0;
+    const char *field = line;
+    for (const char *at = line; at <= line_end; at++)
+    {
+        if (at != line_end && *at != ',')
+            continue;
+
+        long long integer = 0;
+        for (int f = 0; f < FIELD_COUNT; f++)
+        {
+            if (field_columns[f] != column)
+                continue;
+
+            bool parsed = true;
+            switch (f)
+            {
+            case STEP:
+                parsed = parseInt(field, at, integer);
+                row.step = static_cast<std::uint64_t>(integer);
+                break;
+            case TIMESTAMP:
+                parsed = parseDouble(field, at, row.timestamp);
+                break;
+            case TRADER_ID:
+                parsed = parseInt(field, at, integer);
+                row.trader_id = static_cast<int>(integer);
+                break;
+            case SIDE:
+                parsed = parseSide(field, at, row.is_buy);
+                break;
+            case BUYER_ID:
+                parsed = parseInt(field, at, integer);
+                row.buyer_id = static_cast<int>(integer);
+                break;
+            case SELLER_ID:
+                parsed = parseInt(field, at, integer);
+                row.seller_id = static_cast<int>(integer);
+                break;
+            case PRICE:
+                parsed = parseDouble(field, at, row.price);
+                break;
+            case QUANTITY:
+                parsed = parseInt(field, at, integer);
+                row.quantity = static_cast<int>(integer);
+                break;
+            case TIME_IN_FORCE:
+                parsed = parseTimeInForce(field, at, row.time_in_force);
+                break;
+            case EXPIRE_TIME:
+                parsed = parseDouble(field, at, row.expire_time);
+                break;
+            }
+            if (!parsed)
+                return -1;
+            fields_seen++;
+        }
+
+        column++;
+        field = at + 1;
+    }
+
+    int fields_wanted = 0;
+    for (int f = 0; f < FIELD_COUNT; f++)
+        fields_wanted += field_columns[f] >= 0;
+    return fields_seen == fields_wanted ? 1 : -1;
+}
+
+int OrderFlowReader::readBinaryRow(Row &row)
+{
+    if (block_row == block_rows)
+    {
+        block_rows = binary_reader.readBlock(block);
+        block_row = 0;
+        if (block_rows <= 0)
+            return block_rows;
+    }
+
+    const auto &columns = binary_reader.getColumns();
+    auto value = [&](Field f)
+    { return block[field_columns[f]][block_row]; };
+    auto real = [&](Field f)
+    { return BinaryLogReader::toDouble(columns[field_columns[f]].kind, value(f)); };
+
+    row.timestamp = real(TIMESTAMP);
+    row.price = real(PRICE);
+    row.quantity = static_cast<int>(value(QUANTITY));
+    if (format == OrderFlowFormat::ORDERS)
+    {
+        row.step = static_cast<std::uint64_t>(value(STEP));
+        row.trader_id = static_cast<int>(value(TRADER_ID));
+        row.is_buy = value(SIDE) == 0;
+        if (field_columns[TIME_IN_FORCE] >= 0)
+        {
+            std::int64_t time_in_force = value(TIME_IN_FORCE);
+            if (time_in_force < 0 || time_in_force > static_cast<int>(TimeInForce::FOK))
+                return -1;
+            row.time_in_force = static_cast<TimeInForce>(time_in_force);
+        }
+        if (field_columns[EXPIRE_TIME] >= 0)
+            row.expire_time = real(EXPIRE_TIME);
+    }
+    else
+    {
+        row.buyer_id = static_cast<int>(value(BUYER_ID));
+        row.seller_id = static_cast<int>(value(SELLER_ID));
+    }
+    block_row++;
+    return 1;
+}
+
+int OrderFlowReader::readRow(Row &row)
+{
+    int status = binary ? readBinaryRow(row) : readCsvRow(row);
+    if (status > 0)
+        rows_read++;
+    return status;
+}
+
+int OrderFlowReader::nextRound(std::vector<Order> &orders)
+{
+    orders.clear();
+
+    if (format == OrderFlowFormat::TRADES)
+    {
+        Row row;
+        int status = readRow(row);
+        if (status <= 0)
+            return status;
+        orders.emplace_back(0, row.seller_id, OrderType::SELL, row.price, row.quantity, row.timestamp);
+        orders.emplace_back(0, row.buyer_id, OrderType::BUY, row.price, row.quantity, row.timestamp);
+        return 2;
+    }
+
+    if (!has_pending)
+    {
+        int status = readRow(pending);
+        if (status <= 0)
+            return status;
+    }
+
+    // Every row of one step, in the order they were submitted
+    std::uint64_t step = pending.step;
+    Row row = pending;
+    int status;
+    do
+    {
+        orders.emplace_back(0, row.trader_id, row.is_buy ? OrderType::BUY : OrderType::SELL,
+                            row.price, row.quantity, row.timestamp);
+        orders.back().time_in_force = row.time_in_force;
+        orders.back().expire_time = row.expire_time;
+        status = readRow(row);
+    } while (status > 0 && row.step == step);
+
+    if (status < 0)
+        return -1;
+    has_pending = status > 0;
+    pending = row;
+    return static_cast<int>(orders.size());
+}
+
+ReplayResult replayOrderFlow(OrderFlowReader &reader, OrderBook &book, DataLogger *trade_log)
+{
+    using Clock = std::chrono::steady_clock;
+
+    ReplayResult result;
+    result.trade_checksum = FNV_OFFSET;
+
+    std::vector<Order> round;
+    std::vector<Order> expired;
+    auto replay_start = Clock::now();
+    int count;
+    while ((count = reader.nextRound(round)) > 0)
+    {
+        // Human orders carry the previous step's time, agent orders this one's
+        double now = round[0].timestamp;
+        for (const Order &order : round)
+            now = std::max(now, order.timestamp);
+
+        auto insert_start = Clock::now();
+        book.expireOrders(now);
+        book.addOrders(round.data(), round.size());
+        auto match_start = Clock::now();
+        std::vector<ExecutedTrade> trades = book.matchOrders();
+        auto match_end = Clock::now();
+        book.takeExpiredOrders(expired); // Nothing holds funds here
+
+        result.match_latency.record(static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(match_end - match_start).count()));
+        result.book_seconds += std::chrono::duration<double>(match_end - insert_start).count();
+        result.rounds++;
+        result.orders += round.size();
+        result.trades += trades.size();
+
+        for (const auto &trade : trades)
+        {
+            std::uint64_t price_bits;
+            std::memcpy(&price_bits, &trade.price, sizeof(price_bits));
+            std::uint64_t hash = result.trade_checksum;
+            hash = mixChecksum(hash, static_cast<std::uint64_t>(trade.trade_id));
+            hash = mixChecksum(hash, static_cast<std::uint64_t>(trade.buy_order_id));
+            hash = mixChecksum(hash, static_cast<std::uint64_t>(trade.sell_order_id));
+            hash = mixChecksum(hash, static_cast<std::uint64_t>(trade.buyer_id));
+            hash = mixChecksum(hash, static_cast<std::uint64_t>(trade.seller_id));
+            hash = mixChecksum(hash, price_bits);
+            result.trade_checksum = mixChecksum(hash, static_cast<std::uint64_t>(trade.quantity));
+
+            result.volume += trade.price * trade.quantity;
+            if (trade_log)
+                trade_log->logTrade(trade);
+        }
+    }
+    result.wall_seconds = std::chrono::duration<double>(Clock::now() - replay_start).count();
+    result.ok = count == 0;
+
+    if (trade_log)
+        trade_log->flush();
+    return result;
+}
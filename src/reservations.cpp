@@ -0,0 +1,125 @@
+#include "../include/reservations.hpp"
+#include <algorithm>
+
+OrderReservations::OrderReservations(int trader_count)
+    : first_id(1), rejected(0)
+{
+    reset(trader_count);
+}
+
+void OrderReservations::reset(int trader_count)
+{
+    reserved_cash.assign(trader_count, 0.0);
+    reserved_holdings.assign(trader_count, 0);
+    orders.clear();
+    first_id = 1;
+    rejected = 0;
+}
+
+OrderReservations::Reservation *OrderReservations::find(int order_id)
+{
+    if (order_id < first_id || order_id - first_id >= static_cast<long long>(orders.size()))
+        return nullptr;
+    return &orders[order_id - first_id];
+}
+
+bool OrderReservations::canAfford(const Order &order, double cash, int holdings) const
+{
+    if (order.trader_id < 0 || order.trader_id >= static_cast<int>(reserved_cash.size()) || order.quantity <= 0)
+        return false;
+    if (order.type == OrderType::BUY)
+        return cash - reserved_cash[order.trader_id] >= order.price * order.quantity;
+    return holdings - reserved_holdings[order.trader_id] >= order.quantity;
+}
+
+bool OrderReservations::reserve(const Order &order, double cash, int holdings)
+{
+    if (!canAfford(order, cash, holdings))
+    {
+        rejected++;
+        return false;
+    }
+
+    if (order.type == OrderType::BUY)
+        reserved_cash[order.trader_id] += order.price * order.quantity;
+    else
+        reserved_holdings[order.trader_id] += order.quantity;
+    return true;
+}
+
+void OrderReservations::bind(int first_order_id, const Order *admitted, size_t count)
+{
+    if (count == 0)
+        return;
+
+    if (orders.empty())
+        first_id = first_order_id;
+
+    // Ids handed out by the book without a reservation hold nothing
+    while (first_id + static_cast<long long>(orders.size()) < first_order_id)
+        orders.push_back(Reservation{0, true, 0, 0.0});
+
+    for (size_t i = 0; i < count; i++)
+    {
+        const Order &order = admitted[i];
+        orders.push_back(Reservation{order.trader_id, order.type == OrderType::BUY, order.quantity, order.price});
+    }
+}
+
+void OrderReservations::fill(int order_id, int quantity)
+{
+    Reservation *reservation = find(order_id);
+    if (!reservation || reservation->remaining == 0)
+        return;
+
+    quantity = std::min(quantity, reservation->remaining);
+    reservation->remaining -= quantity;
+    if (reservation->is_buy)
+    {
+        reserved_cash[reservation->trader_id] -= reservation->price * quantity;
+        // Rounding must not leave a trader with no open orders owing cash
+        if (reserved_cash[reservation->trader_id] < 0.0)
+            reserved_cash[reservation->trader_id] = 0.0;
+    }
+    else
+    {
+        reserved_holdings[reservation->trader_id] -= quantity;
+    }
+}
+
+void OrderReservations::release(int order_id)
+{
+    Reservation *reservation = find(order_id);
+    if (reservation)
+        fill(order_id, reservation->remaining);
+}
+
+void OrderReservations::trim()
+{
+    while (!orders.empty() && orders.front().remaining == 0)
+    {
+        orders.pop_front();
+        first_id++;
+    }
+}
+
+void OrderReservations::saveState(CheckpointWriter &out) const
+{
+    out.putVector(reserved_cash);
+    out.putVector(reserved_holdings);
+    out.put(first_id);
+    out.put(rejected);
+    std::vector<Reservation> records(orders.begin(), orders.end());
+    out.putVector(records);
+}
+
+void OrderReservations::loadState(CheckpointReader &in)
+{
+    in.getFixedVector(reserved_cash);
+    in.getFixedVector(reserved_holdings);
+    first_id = in.get<int>();
+    rejected = in.get<std::uint64_t>();
+    size_t count = 0;
+    const Reservation *records = in.getArray<Reservation>(count);
+    orders.assign(records, records + count);
+}
@@ -0,0 +1,40 @@
+#include "../include/settlement.hpp"
+#include <algorithm>
+
+// A few buckets per thread so dynamic scheduling can even out busy traders
+static constexpr int BUCKETS_PER_THREAD = 4;
+
+int SettlementStage::bucketsFor(const ExecutionPlan &plan, int trader_count)
+{
+    if (!plan.parallel() || trader_count < 2)
+        return 0;
+    return std::min(plan.threads * BUCKETS_PER_THREAD, trader_count);
+}
+
+void SettlementStage::bucket(const std::vector<ExecutedTrade> &trades, int trader_count)
+{
+    // Contiguous id ranges, so neighbouring accounts stay on one thread
+    auto bucket_of = [&](int trader_id)
+    { return static_cast<int>(static_cast<long long>(trader_id) * bucket_count / trader_count); };
+
+    bucket_start.assign(bucket_count + 1, 0);
+    for (const auto &trade : trades)
+    {
+        bucket_start[bucket_of(trade.buyer_id) + 1]++;
+        bucket_start[bucket_of(trade.seller_id) + 1]++;
+    }
+    for (int b = 0; b < bucket_count; b++)
+    {
+        bucket_start[b + 1] += bucket_start[b];
+    }
+
+    legs.resize(2 * trades.size());
+    bucket_cursor.assign(bucket_start.begin(), bucket_start.end() - 1);
+    for (const auto &trade : trades)
+    {
+        legs[bucket_cursor[bucket_of(trade.buyer_id)]++] =
+            Leg{trade.buyer_id, trade.buy_order_id, true, trade.price, trade.quantity};
+        legs[bucket_cursor[bucket_of(trade.seller_id)]++] =
+            Leg{trade.seller_id, trade.sell_order_id, false, trade.price, trade.quantity};
+    }
+}
@@ -0,0 +1,63 @@
+#include "../include/sim_snapshot.hpp"
+#include <algorithm>
+
+void SnapshotBuilder::capture(const TradingSimulation &simulation, int human_id, std::uint64_t steps,
+                              SimulationSnapshot &out)
+{
+    const Market &market = simulation.getMarket();
+    const OrderBook &order_book = simulation.getOrderBook();
+    double price = market.getCurrentPrice();
+
+    out.steps = steps;
+    out.current_price = price;
+    out.price_change_percent = market.getPriceChangePercent();
+
+    PriceSpan history = market.getRecentHistory(history_points);
+    out.price_window.assign(history.begin(), history.end());
+
+    out.buy_depth = order_book.getBuyDepth(depth_levels);
+    out.sell_depth = order_book.getSellDepth(depth_levels);
+    out.best_bid = order_book.getBestBid();
+    out.best_ask = order_book.getBestAsk();
+    out.spread = order_book.getSpread();
+    out.stats = simulation.getStats();
+    out.simulation_time = out.stats.simulation_time;
+
+    ranking.clear();
+    out.human_id = human_id;
+    if (const TraderPopulation *population = simulation.getPopulation())
+    {
+        for (int id = 0; id < population->size(); id++)
+        {
+            if (id != human_id)
+                ranking.push_back({id, population->getStrategy(id), population->getNetWorth(id, price)});
+        }
+        out.human_cash = population->getCash(human_id);
+        out.human_holdings = population->getHoldings(human_id);
+        out.human_net_worth = population->getNetWorth(human_id, price);
+    }
+    else
+    {
+        for (const auto &trader : simulation.getTraders())
+        {
+            if (trader->getId() != human_id)
+                ranking.push_back({trader->getId(), trader->getStrategy(), trader->getNetWorth(price)});
+        }
+        const Trader &human = *simulation.getTraders()[human_id];
+        out.human_cash = human.getCash();
+        out.human_holdings = human.getHoldings();
+        out.human_net_worth = human.getNetWorth(price);
+    }
+    out.human_notification = simulation.getHumanNotification();
+
+    // Only the top few are shown, so partially sort them out of the population
+    size_t shown = std::min(ranking.size(), static_cast<size_t>(std::max(leaderboard_size, 0)));
+    std::partial_sort(ranking.begin(), ranking.begin() + shown, ranking.end(),
+                      [](const LeaderboardEntry &a, const LeaderboardEntry &b)
+                      {
+                          if (a.net_worth != b.net_worth)
+                              return a.net_worth > b.net_worth;
+                          return a.trader_id < b.trader_id;
+                      });
+    out.leaderboard.assign(ranking.begin(), ranking.begin() + shown);
+}
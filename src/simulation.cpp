@@ -1,54 +1,50 @@
 #include "../include/simulation.hpp"
+#include "../include/execution_policy.hpp"
+#include "../include/strategy_policy.hpp"
 #include <omp.h>
 #include <algorithm>
-#include <numeric>
+#include <atomic>
+#include <cmath>
 #include <sstream>
 #include <iomanip>
-
-TradingSimulation::TradingSimulation(int num_traders, double initial_price, double initial_cash, unsigned int seed)
-    : market(initial_price), current_time(0.0), time_step(0.1),
-      base_seed(seed), mpi_enabled(false), mpi_rank(0), mpi_size(1)
+#include <iostream>
+
+TradingSimulation::TradingSimulation(int num_traders, double initial_price, double initial_cash, unsigned int seed,
+                                     PopulationLayout layout)
+    : market(initial_price, seed), order_book(createOrderBook(OrderBookType::MAP)),
+      trader_count(num_traders), starting_cash(initial_cash),
+      book_type(OrderBookType::MAP), book_tick_size(0.01),
+      current_time(0.0), time_step(0.1), steps_run(0), order_lifetime(DEFAULT_ORDER_LIFETIME),
+      base_seed(seed), mpi_enabled(false), mpi_rank(0), mpi_size(1), last_human_trade(), has_human_trade(false),
+      human_rejected(false), reservations(num_traders)
 {
+    IndicatorSet default_indicators = indicators.addDefaultSet();
+    trader_indicator_ids = default_indicators;
+    int initial_holdings = 50;
+
+    if (layout == PopulationLayout::SOA)
+    {
+        population = std::make_unique<TraderPopulation>(num_traders, initial_cash, base_seed);
+        population->attachIndicators(&indicators, default_indicators);
+        population->attachPriceHistory(&market.getHistory());
+        population->setInitialHoldings(num_traders / 2, initial_holdings);
+        return;
+    }
+
     for (int i = 0; i < num_traders; i++)
     {
-        Strategy strat;
+        Strategy strat = assignStrategy(i);
 
-        if (i == 0)
-        {
-            strat = Strategy::HUMAN;
-        }
-        else
-        {
-            int strategy_type = i % 9;
-            if (strategy_type == 0)
-                strat = Strategy::MOMENTUM;
-            else if (strategy_type == 1)
-                strat = Strategy::MEAN_REVERSION;
-            else if (strategy_type == 2)
-                strat = Strategy::RANDOM;
-            else if (strategy_type == 3)
-                strat = Strategy::RISK_AVERSE;
-            else if (strategy_type == 4)
-                strat = Strategy::HIGH_RISK;
-            else if (strategy_type == 5)
-                strat = Strategy::RSI_BASED;
-            else if (strategy_type == 6)
-                strat = Strategy::MACD_BASED;
-            else if (strategy_type == 7)
-                strat = Strategy::BOLLINGER;
-            else
-                strat = Strategy::MULTI_INDICATOR;
-        }
-
-        unsigned int trader_seed = base_seed + i;
-        traders.push_back(std::make_unique<Trader>(i, strat, initial_cash, trader_seed));
+        traders.push_back(std::make_unique<Trader>(i, strat, initial_cash, base_seed));
+        traders.back()->attachIndicators(&indicators, default_indicators);
+        traders.back()->attachPriceHistory(&market.getHistory());
     }
 
-    int initial_holdings = 50;
     for (int i = 0; i < num_traders / 2; i++)
     {
         traders[i]->setInitialHoldings(initial_holdings);
     }
+    trader_runs.build(traders);
 }
 
 void TradingSimulation::setTimeScale(double scale)
@@ -56,6 +52,181 @@ void TradingSimulation::setTimeScale(double scale)
     if (scale <= 0.0)
         scale = 1.0;
     time_step = 0.1 / scale;
+    activation_armed = false; // Arrival gaps are drawn in steps
+}
+
+bool TradingSimulation::setActivation(const ActivationSettings &settings)
+{
+    if (settings.mode == ActivationMode::EVENT && (population || !instruments.empty()))
+    {
+        std::cerr << "Error: event-driven activation needs the objects layout and a single instrument\n";
+        return false;
+    }
+    activation_settings = settings;
+    activation_armed = false;
+    return true;
+}
+
+void TradingSimulation::setOrderBookType(OrderBookType type, double tick_size)
+{
+    MatchingMode mode = order_book->getMatchingMode();
+    order_book = createOrderBook(type, tick_size);
+    order_book->setMatchingMode(mode);
+    reservations.reset(trader_count); // The new book hands out ids from 1 again
+
+    book_type = type;
+    book_tick_size = tick_size;
+    for (auto &instrument : instruments)
+    {
+        instrument->setOrderBookType(type, tick_size);
+    }
+}
+
+void TradingSimulation::setMatchingMode(MatchingMode mode)
+{
+    order_book->setMatchingMode(mode);
+    for (auto &instrument : instruments)
+    {
+        instrument->setMatchingMode(mode);
+    }
+}
+
+void TradingSimulation::setOrderLifetime(double seconds)
+{
+    order_lifetime = std::max(seconds, 0.0);
+    for (auto &instrument : instruments)
+    {
+        instrument->setOrderLifetime(order_lifetime);
+    }
+}
+
+void TradingSimulation::releaseExpiredOrders()
+{
+    order_book->takeExpiredOrders(expired_orders);
+    for (const Order &order : expired_orders)
+    {
+        reservations.release(order.order_id);
+    }
+}
+
+void TradingSimulation::setInstrumentCount(int count)
+{
+    instruments.clear();
+    portfolio_cash.clear();
+    free_cash.clear();
+
+    for (int k = 0; count > 1 && k < count; k++)
+    {
+        auto instrument = std::make_unique<Instrument>("SYM" + std::to_string(k), k, trader_count,
+                                                       market.getCurrentPrice(), starting_cash, base_seed,
+                                                       logger.getDirectory());
+        instrument->setOrderBookType(book_type, book_tick_size);
+        instrument->setMatchingMode(order_book->getMatchingMode());
+        instrument->setOrderLifetime(order_lifetime);
+        instrument->getLogger().initializeLike(logger);
+        instruments.push_back(std::move(instrument));
+    }
+
+    if (count > 1)
+    {
+        portfolio_cash.assign(trader_count, starting_cash);
+        free_cash.assign(trader_count, 0.0);
+    }
+
+    if (!feed_name.empty() && static_cast<int>(feeds.size()) != getInstrumentCount())
+        openMarketFeed(feed_name);
+}
+
+bool TradingSimulation::openMarketFeed(const std::string &name)
+{
+    feeds.clear();
+    feed_name = name;
+    if (name.empty())
+        return true;
+
+    for (int k = 0; k < getInstrumentCount(); k++)
+    {
+        auto feed = std::make_unique<MarketFeedPublisher>();
+        if (!feed->open(instruments.empty() ? name : name + "." + instruments[k]->getSymbol()))
+        {
+            feeds.clear();
+            return false;
+        }
+        feeds.push_back(std::move(feed));
+    }
+    return true;
+}
+
+double TradingSimulation::getPortfolioNetWorth(int trader_id) const
+{
+    double net_worth = portfolio_cash[trader_id];
+    for (const auto &instrument : instruments)
+    {
+        net_worth += instrument->getAgents()[trader_id]->getHoldings() * instrument->getMarket().getCurrentPrice();
+    }
+    return net_worth;
+}
+
+void TradingSimulation::stepInstruments()
+{
+    // The cash no symbol has reserved is split evenly for new orders; each
+    // shard adds back what its own resting buys reserve. The shards together
+    // never hand out more than the account holds, and every resting buy
+    // that fills can be paid.
+    double share = 1.0 / instruments.size();
+    for (size_t i = 0; i < portfolio_cash.size(); i++)
+    {
+        double reserved = 0.0;
+        for (const auto &instrument : instruments)
+            reserved += instrument->getReservations().getReservedCash(static_cast<int>(i));
+        free_cash[i] = std::max(portfolio_cash[i] - reserved, 0.0) * share;
+    }
+
+    // One shard per symbol. The static schedule keeps each symbol on the same
+    // thread every step, and no book or agent is touched by two threads.
+    {
+        PROFILE_PHASE(profiler, StepPhase::MATCH);
+        ParallelRegion region(ParallelPhase::INSTRUMENTS, instruments.size());
+
+#pragma omp parallel for schedule(static) if (region.parallel()) num_threads(region.threads())
+        for (int k = 0; k < static_cast<int>(instruments.size()); k++)
+        {
+            instruments[k]->step(current_time, free_cash);
+        }
+    }
+
+    // Deterministic reduce: fold cash changes back in symbol order
+    std::uint64_t orders = 0;
+    std::uint64_t trades = 0;
+    {
+        PROFILE_PHASE(profiler, StepPhase::SETTLE);
+        for (const auto &instrument : instruments)
+        {
+            const std::vector<double> &delta = instrument->getCashDelta();
+            for (size_t i = 0; i < portfolio_cash.size(); i++)
+            {
+                portfolio_cash[i] += delta[i];
+            }
+            orders += instrument->getLastStepOrderCount();
+            trades += instrument->getLastStepTrades().size();
+            profiler.countDecisions(instrument->getDecisionCount());
+            profiler.countUnsettled(instrument->getLastStepUnsettledCount());
+        }
+    }
+
+    if (!feeds.empty())
+    {
+        PROFILE_PHASE(profiler, StepPhase::FEED);
+        for (size_t k = 0; k < instruments.size(); k++)
+        {
+            const Instrument &instrument = *instruments[k];
+            const std::vector<ExecutedTrade> &step_trades = instrument.getLastStepTrades();
+            feeds[k]->publish(steps_run, current_time, static_cast<int>(k), instrument.getMarket().getCurrentPrice(),
+                              instrument.getOrderBook(), step_trades.data(), step_trades.size());
+        }
+    }
+
+    profiler.countStep(orders, trades);
 }
 
 void TradingSimulation::initializeMPI(bool use_mpi, int rank, int size)
@@ -67,95 +238,274 @@ void TradingSimulation::initializeMPI(bool use_mpi, int rank, int size)
     logger.initialize(use_mpi, rank, size);
 }
 
+void TradingSimulation::createRunOrders(const StrategyRuns &runs, double current_price)
+{
+    // Each thread takes a static slice of every strategy run and writes only
+    // those traders' slots, so the result is independent of scheduling
+    ParallelRegion region(ParallelPhase::GENERATE, runs.indices.size());
+
+#pragma omp parallel if (region.parallel()) num_threads(region.threads())
+    {
+        int thread = omp_get_thread_num();
+        int thread_count = omp_get_num_threads();
+        for (const StrategyRun &run : runs.runs)
+        {
+            int length = run.end - run.begin;
+            int first = run.begin + static_cast<int>(static_cast<long long>(length) * thread / thread_count);
+            int last = run.begin + static_cast<int>(static_cast<long long>(length) * (thread + 1) / thread_count);
+            Trader::createOrders(run.strategy, traders, runs.indices.data() + first, last - first,
+                                 current_price, current_time, order_slots.data());
+        }
+    }
+}
+
+void TradingSimulation::collectWokenTraders(double current_price)
+{
+    // First event step since the mode or a run setting changed: everyone
+    // starts armed on the current price
+    if (!activation_armed)
+    {
+        activation.reset(trader_count, activation_settings, time_step, base_seed, steps_run);
+        for (int i : trader_runs.indices)
+            activation.arm(i, steps_run, current_price);
+        run_signals.assign(trader_runs.runs.size(), RunSignal{});
+        order_slots.assign(traders.size(), TraderOrder{});
+        activation_armed = true;
+    }
+
+    woken.clear();
+    activation.collect(steps_run, current_price, woken);
+
+    // A strategy's signal turning on wakes all of its traders; while it
+    // stays on, they are left to their arrivals and bands
+    PriceSpan prices = market.getHistory().recent(TRADER_PRICE_WINDOW);
+    if (activation_settings.signal_wakes && prices.size() >= 5)
+    {
+        for (size_t r = 0; r < trader_runs.runs.size(); r++)
+        {
+            const StrategyRun &run = trader_runs.runs[r];
+            RunSignal &state = run_signals[r];
+            bool on = sharedSignal(run.strategy, state.indicators, prices, current_price, &indicators,
+                                   trader_indicator_ids);
+            if (on && !state.on)
+            {
+                for (int k = run.begin; k < run.end; k++)
+                    activation.wake(trader_runs.indices[k], steps_run, woken);
+            }
+            state.on = on;
+        }
+    }
+
+    // Into id order; when many traders woke, a scan beats sorting them
+    if (woken.size() * 8 > traders.size())
+    {
+        woken.clear();
+        for (int i = 0; i < static_cast<int>(traders.size()); i++)
+        {
+            if (activation.isWoken(i, steps_run))
+                woken.push_back(i);
+        }
+    }
+    else
+    {
+        std::sort(woken.begin(), woken.end());
+    }
+    woken_runs.build(traders, woken.data(), woken.size());
+}
+
+void TradingSimulation::generateTraderOrders(double current_price, std::vector<Order> &current_orders,
+                                             int &total_buy_quantity, int &total_sell_quantity)
+{
+    auto merge = [&](TraderOrder &trader_order)
+    {
+        if (trader_order.quantity <= 0)
+            return;
+
+        current_orders.emplace_back(
+            0, // order_id will be assigned by OrderBook
+            trader_order.trader_id,
+            trader_order.is_buy ? OrderType::BUY : OrderType::SELL,
+            trader_order.price,
+            trader_order.quantity,
+            trader_order.timestamp);
+
+        if (trader_order.is_buy)
+        {
+            total_buy_quantity += trader_order.quantity;
+        }
+        else
+        {
+            total_sell_quantity += trader_order.quantity;
+        }
+    };
+
+    if (activation_settings.mode == ActivationMode::EVENT)
+    {
+        // Only woken traders decide; their slots are cleared again after the
+        // merge, so a step costs O(woken) rather than O(traders)
+        collectWokenTraders(current_price);
+        createRunOrders(woken_runs, current_price);
+        for (int i : woken)
+        {
+            merge(order_slots[i]);
+            order_slots[i] = TraderOrder{};
+            activation.arm(i, steps_run, current_price);
+        }
+        profiler.countDecisions(woken.size());
+        return;
+    }
+
+    // The human's slot stays empty; its orders come from addHumanOrder
+    order_slots.assign(traders.size(), TraderOrder{});
+    createRunOrders(trader_runs, current_price);
+
+    // Deterministic merge: orders reach the book in trader id order
+    for (auto &trader_order : order_slots)
+    {
+        merge(trader_order);
+    }
+    profiler.countDecisions(trader_runs.indices.size());
+}
+
 void TradingSimulation::step()
 {
     current_time += time_step;
+    steps_run++;
+
+    if (!instruments.empty())
+    {
+        stepInstruments();
+        return;
+    }
 
     std::vector<Order> current_orders;
+    std::vector<ExecutedTrade> executed_trades;
     int total_buy_quantity = 0;
     int total_sell_quantity = 0;
 
     double current_price = market.getCurrentPrice();
 
-#pragma omp parallel
     {
-        std::vector<Order> local_orders;
-        int local_buy = 0;
-        int local_sell = 0;
+        PROFILE_PHASE(profiler, StepPhase::INDICATORS);
+
+        // One O(1) indicator update per tick, read by every trader below
+        indicators.update(current_price);
+    }
+
+    {
+        PROFILE_PHASE(profiler, StepPhase::GENERATE);
 
-#pragma omp for nowait
-        for (int i = 0; i < traders.size(); i++)
+        if (population)
         {
-            if (traders[i]->getId() == 0)
-            {
-                continue;
-            }
+            population->generateOrders(current_price, current_time, current_orders,
+                                       total_buy_quantity, total_sell_quantity);
+            profiler.countDecisions(std::max(population->size() - 1, 0)); // All but the human
+        }
+        else
+        {
+            generateTraderOrders(current_price, current_orders, total_buy_quantity, total_sell_quantity);
+        }
+    }
 
-            TraderOrder trader_order = traders[i]->createOrder(current_price, current_time);
+    {
+        PROFILE_PHASE(profiler, StepPhase::INSERT);
 
-            if (trader_order.quantity > 0)
-            {
-                Order order(
-                    0, // order_id will be assigned by OrderBook
-                    trader_order.trader_id,
-                    trader_order.is_buy ? OrderType::BUY : OrderType::SELL,
-                    trader_order.price,
-                    trader_order.quantity,
-                    trader_order.timestamp);
-
-                local_orders.push_back(order);
-
-                if (trader_order.is_buy)
-                {
-                    local_buy += trader_order.quantity;
-                }
-                else
-                {
-                    local_sell += trader_order.quantity;
-                }
-            }
+        // Expired quotes go first, so their funds back this step's orders
+        order_book->expireOrders(current_time);
+        releaseExpiredOrders();
+        for (Order &order : current_orders)
+        {
+            order.setLifetime(order_lifetime);
         }
 
-#pragma omp critical
+        // Pre-trade check: unfundable orders never reach the book
+        if (population)
         {
-            current_orders.insert(current_orders.end(), local_orders.begin(), local_orders.end());
-            total_buy_quantity += local_buy;
-            total_sell_quantity += local_sell;
+            const TraderPopulation &accounts = *population;
+            reservations.admit(current_orders, [&accounts](int id)
+                               { return std::make_pair(accounts.getCash(id), accounts.getHoldings(id)); },
+                               total_buy_quantity, total_sell_quantity);
         }
+        else
+        {
+            reservations.admit(current_orders, [this](int id)
+                               { return std::make_pair(traders[id]->getCash(), traders[id]->getHoldings()); },
+                               total_buy_quantity, total_sell_quantity);
+        }
+
+        logger.logOrders(steps_run, current_orders.data(), current_orders.size());
+        int first_id = order_book->addOrders(current_orders.data(), current_orders.size());
+        reservations.bind(first_id, current_orders.data(), current_orders.size());
     }
 
-    for (auto &order : current_orders)
     {
-        order_book.addOrder(order);
+        PROFILE_PHASE(profiler, StepPhase::MATCH);
+        executed_trades = order_book->matchOrders();
     }
 
-    std::vector<ExecutedTrade> executed_trades = order_book.matchOrders();
-
-    for (const auto &trade : executed_trades)
     {
-        std::stringstream ss;
-        if (trade.buyer_id == 0)
+        PROFILE_PHASE(profiler, StepPhase::SETTLE);
+
+        // Only the human's last fill is kept; the text is built when asked for
+        for (auto trade = executed_trades.rbegin(); trade != executed_trades.rend(); ++trade)
+        {
+            if (trade->buyer_id == 0 || trade->seller_id == 0)
+            {
+                last_human_trade = *trade;
+                has_human_trade = true;
+                human_rejected = false;
+                break;
+            }
+        }
+
+        // Each fill releases its order's reservation before the account pays.
+        // A leg the account refuses is counted, never expected: the book has
+        // already matched it
+        std::atomic<std::uint64_t> unsettled(0);
+        if (population)
         {
-            ss << "SUCCESS: Bought " << trade.quantity << " @ $"
-               << std::fixed << std::setprecision(2) << trade.price;
-            last_human_trade_notification = ss.str();
+            TraderPopulation &accounts = *population;
+            settlement.settle(executed_trades, trader_count,
+                              [this, &accounts, &unsettled](int trader_id, int order_id, bool is_buy, double price,
+                                                            int quantity)
+                              {
+                                  reservations.fill(order_id, quantity);
+                                  if (!accounts.executeOrder(trader_id, is_buy, price, quantity))
+                                      unsettled.fetch_add(1, std::memory_order_relaxed);
+                              });
         }
-        else if (trade.seller_id == 0)
+        else
         {
-            ss << "SUCCESS: Sold " << trade.quantity << " @ $"
-               << std::fixed << std::setprecision(2) << trade.price;
-            last_human_trade_notification = ss.str();
+            settlement.settle(executed_trades, trader_count,
+                              [this, &unsettled](int trader_id, int order_id, bool is_buy, double price, int quantity)
+                              {
+                                  reservations.fill(order_id, quantity);
+                                  if (!traders[trader_id]->executeOrder(is_buy, price, quantity))
+                                      unsettled.fetch_add(1, std::memory_order_relaxed);
+                              });
         }
+        profiler.countUnsettled(unsettled.load(std::memory_order_relaxed));
+        releaseExpiredOrders(); // IOC/FOK remainders
+        reservations.trim();
+        logger.logTrades(executed_trades.data(), executed_trades.size());
+    }
 
-        traders[trade.buyer_id]->executeOrder(true, trade.price, trade.quantity);
-        traders[trade.seller_id]->executeOrder(false, trade.price, trade.quantity);
-        logger.logTrade(trade);
+    {
+        PROFILE_PHASE(profiler, StepPhase::MARKET);
+        market.updatePrice(total_buy_quantity, total_sell_quantity);
     }
 
-    market.updatePrice(total_buy_quantity, total_sell_quantity);
+    if (!feeds.empty())
+    {
+        PROFILE_PHASE(profiler, StepPhase::FEED);
+        feeds[0]->publish(steps_run, current_time, 0, market.getCurrentPrice(), *order_book,
+                          executed_trades.data(), executed_trades.size());
+    }
 
     if (static_cast<int>(current_time * 10) % 10 == 0)
     {
+        PROFILE_PHASE(profiler, StepPhase::PERIODIC_LOG);
+
         double volume = 0.0;
         for (const auto &trade : executed_trades)
         {
@@ -163,62 +513,41 @@ void TradingSimulation::step()
         }
 
         logger.logPrice(current_time, current_price, volume,
-                        order_book.getBuyOrderCount(), order_book.getSellOrderCount());
+                        order_book->getBuyOrderCount(), order_book->getSellOrderCount());
 
-        logger.logTraderStats(current_time, traders, current_price);
+        if (population)
+            logger.logTraderStats(current_time, *population, current_price);
+        else
+            logger.logTraderStats(current_time, traders, current_price);
 
-        auto buy_depth = order_book.getBuyDepth(5);
-        auto sell_depth = order_book.getSellDepth(5);
+        auto buy_depth = order_book->getBuyDepth(5);
+        auto sell_depth = order_book->getSellDepth(5);
         logger.logOrderBook(current_time, buy_depth, sell_depth);
     }
 
-    if (static_cast<int>(current_time) % 10 == 0)
-    {
-        order_book.cleanupFilledOrders();
-    }
+    profiler.countStep(current_orders.size(), executed_trades.size());
 }
 
-SimulationStats TradingSimulation::getStats() const
+// Statistics of one symbol's price path and book
+static SimulationStats marketStats(double simulation_time, const Market &market, const OrderBook &order_book)
 {
     SimulationStats stats;
-    stats.simulation_time = current_time;
+    stats.simulation_time = simulation_time;
 
-    const auto &executed_trades = order_book.getExecutedTrades();
-    stats.total_trades = executed_trades.size();
+    // O(1): running totals from the book and windowed moments from the market
+    const TradeTotals &totals = order_book.getTradeTotals();
+    stats.total_trades = static_cast<int>(totals.count);
+    stats.total_volume = totals.volume;
 
-    if (executed_trades.empty())
+    if (totals.count == 0)
     {
-        stats.total_volume = 0;
         stats.avg_price = market.getCurrentPrice();
         stats.price_volatility = 0;
     }
     else
     {
-        stats.total_volume = 0;
-        double sum_price = 0;
-        for (const auto &trade : executed_trades)
-        {
-            stats.total_volume += trade.quantity * trade.price;
-            sum_price += trade.price;
-        }
-
-        stats.avg_price = sum_price / executed_trades.size();
-
-        const auto &history = market.getPriceHistory();
-        if (history.size() > 1)
-        {
-            double mean = std::accumulate(history.begin(), history.end(), 0.0) / history.size();
-            double sq_sum = 0;
-            for (double price : history)
-            {
-                sq_sum += (price - mean) * (price - mean);
-            }
-            stats.price_volatility = std::sqrt(sq_sum / history.size());
-        }
-        else
-        {
-            stats.price_volatility = 0;
-        }
+        stats.avg_price = totals.price_sum / totals.count;
+        stats.price_volatility = market.getPriceVolatility();
     }
 
     stats.pending_buy_orders = order_book.getBuyOrderCount();
@@ -230,9 +559,101 @@ SimulationStats TradingSimulation::getStats() const
     return stats;
 }
 
-void TradingSimulation::addHumanOrder(Order order)
+SimulationStats TradingSimulation::getInstrumentStats(int index) const
 {
-    order_book.addOrder(order);
+    if (instruments.empty())
+        return getStats();
+    return marketStats(current_time, instruments[index]->getMarket(), instruments[index]->getOrderBook());
+}
+
+SimulationStats TradingSimulation::getStats() const
+{
+    SimulationStats stats;
+    BookCounters book_counters;
+    std::uint64_t rejected = 0;
+
+    if (instruments.empty())
+    {
+        stats = marketStats(current_time, market, *order_book);
+        book_counters = order_book->getCounters();
+        rejected = reservations.getRejectedCount();
+    }
+    else
+    {
+        // Symbol 0's quotes, sums of activity and means of per-symbol prices
+        stats = marketStats(current_time, instruments[0]->getMarket(), instruments[0]->getOrderBook());
+        stats.total_trades = 0;
+        stats.total_volume = 0.0;
+        stats.pending_buy_orders = 0;
+        stats.pending_sell_orders = 0;
+        double sum_avg_price = 0.0;
+        double sum_volatility = 0.0;
+        for (const auto &instrument : instruments)
+        {
+            SimulationStats symbol_stats = marketStats(current_time, instrument->getMarket(), instrument->getOrderBook());
+            stats.total_trades += symbol_stats.total_trades;
+            stats.total_volume += symbol_stats.total_volume;
+            stats.pending_buy_orders += symbol_stats.pending_buy_orders;
+            stats.pending_sell_orders += symbol_stats.pending_sell_orders;
+            sum_avg_price += symbol_stats.avg_price;
+            sum_volatility += symbol_stats.price_volatility;
+
+            BookCounters counters = instrument->getOrderBook().getCounters();
+            book_counters.levels_touched += counters.levels_touched;
+            book_counters.allocations += counters.allocations;
+            book_counters.expired += counters.expired;
+            book_counters.killed += counters.killed;
+            rejected += instrument->getReservations().getRejectedCount();
+        }
+        stats.avg_price = sum_avg_price / instruments.size();
+        stats.price_volatility = sum_volatility / instruments.size();
+        stats.instrument_count = static_cast<int>(instruments.size());
+    }
+
+    stats.profile = profiler.summarize();
+    stats.profile.counters.levels_touched = book_counters.levels_touched;
+    stats.profile.counters.allocations = book_counters.allocations;
+    stats.profile.counters.rejected = rejected;
+    stats.profile.counters.expired = book_counters.expired + book_counters.killed;
+
+    return stats;
+}
+
+std::string TradingSimulation::getHumanNotification() const
+{
+    std::stringstream ss;
+    if (human_rejected)
+    {
+        bool is_buy = last_human_rejection.type == OrderType::BUY;
+        ss << "REJECTED: " << (is_buy ? "Buy " : "Sell ") << last_human_rejection.quantity << " @ $"
+           << std::fixed << std::setprecision(2) << last_human_rejection.price
+           << (is_buy ? " exceeds free cash" : " exceeds free holdings");
+        return ss.str();
+    }
+    if (!has_human_trade)
+        return "";
+
+    ss << (last_human_trade.buyer_id == 0 ? "SUCCESS: Bought " : "SUCCESS: Sold ") << last_human_trade.quantity
+       << " @ $" << std::fixed << std::setprecision(2) << last_human_trade.price;
+    return ss.str();
+}
+
+int TradingSimulation::addHumanOrder(const Order &order)
+{
+    double cash = population ? population->getCash(order.trader_id) : traders[order.trader_id]->getCash();
+    int holdings = population ? population->getHoldings(order.trader_id) : traders[order.trader_id]->getHoldings();
+    if (!reservations.reserve(order, cash, holdings))
+    {
+        last_human_rejection = order;
+        human_rejected = true;
+        return -1;
+    }
+
+    // Rests until the next step's match, so it replays as part of that step
+    logger.logOrders(steps_run + 1, &order, 1);
+    int order_id = order_book->addOrder(order);
+    reservations.bind(order_id, &order, 1);
+    return order_id;
 }
 
 SimulationStats TradingSimulation::runHeadless(double duration_seconds)
@@ -245,5 +666,142 @@ SimulationStats TradingSimulation::runHeadless(double duration_seconds)
     }
 
     logger.flush();
+    for (auto &instrument : instruments)
+    {
+        instrument->getLogger().flush();
+    }
     return getStats();
-}
\ No newline at end of file
+}
+void TradingSimulation::saveState(CheckpointWriter &out) const
+{
+    out.put(trader_count);
+    out.put(population != nullptr);
+    out.put(current_time);
+    out.put(time_step);
+    out.put(base_seed);
+    out.put(book_type);
+    out.put(book_tick_size);
+    out.put(has_human_trade);
+    out.put(last_human_trade);
+
+    market.saveState(out);
+    indicators.saveState(out);
+    order_book->saveState(out);
+    if (population)
+    {
+        population->saveState(out);
+    }
+    else
+    {
+        for (const auto &trader : traders)
+        {
+            trader->saveState(out);
+        }
+    }
+    reservations.saveState(out);
+
+    out.put(static_cast<std::uint64_t>(instruments.size()));
+    for (const auto &instrument : instruments)
+    {
+        instrument->saveState(out);
+    }
+    out.putVector(portfolio_cash);
+}
+
+bool TradingSimulation::loadState(CheckpointReader &in)
+{
+    if (in.get<int>() != trader_count || in.get<bool>() != (population != nullptr))
+        return false;
+
+    current_time = in.get<double>();
+    time_step = in.get<double>();
+    base_seed = in.get<unsigned int>();
+    steps_run = 0; // A loaded state starts a new run
+    activation_armed = false;
+    OrderBookType saved_book_type = in.get<OrderBookType>();
+    double saved_tick_size = in.get<double>();
+    has_human_trade = in.get<bool>();
+    last_human_trade = in.get<ExecutedTrade>();
+    if (!in.ok())
+        return false;
+
+    // Fresh books of the saved type; their state is loaded below
+    setOrderBookType(saved_book_type, saved_tick_size);
+
+    market.loadState(in);
+    indicators.loadState(in);
+    order_book->loadState(in);
+    if (population)
+    {
+        population->loadState(in);
+    }
+    else
+    {
+        for (auto &trader : traders)
+        {
+            trader->loadState(in);
+        }
+    }
+    reservations.loadState(in);
+
+    int instrument_count = static_cast<int>(in.get<std::uint64_t>());
+    if (!in.ok())
+        return false;
+    if (instrument_count != static_cast<int>(instruments.size()))
+        setInstrumentCount(instrument_count); // Builds books of the saved type
+    for (auto &instrument : instruments)
+    {
+        instrument->loadState(in);
+    }
+    in.getFixedVector(portfolio_cash);
+
+    return in.ok();
+}
+
+bool TradingSimulation::saveCheckpoint(const std::string &filename) const
+{
+    CheckpointWriter out;
+    saveState(out);
+    return out.writeFile(filename);
+}
+
+bool TradingSimulation::loadCheckpoint(const std::string &filename)
+{
+    MappedCheckpoint mapping;
+    if (!mapping.open(filename))
+        return false;
+    return loadCheckpoint(mapping.getData(), mapping.getSize());
+}
+
+bool TradingSimulation::restart(const char *data, size_t size, unsigned int seed)
+{
+    if (!loadCheckpoint(data, size))
+        return false;
+    reseed(seed);
+    profiler.reset();
+    human_rejected = false;
+
+    // loadState() keeps the symbols it already has, and their logs
+    for (auto &instrument : instruments)
+    {
+        instrument->getLogger().initializeLike(logger);
+    }
+    return true;
+}
+
+void TradingSimulation::reseed(unsigned int seed)
+{
+    base_seed = seed;
+    activation_armed = false;
+    market.reseed(seed);
+    if (population)
+        population->reseed(seed);
+    for (auto &trader : traders)
+    {
+        trader->reseed(seed);
+    }
+    for (auto &instrument : instruments)
+    {
+        instrument->reseed(seed);
+    }
+}
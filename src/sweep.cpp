@@ -0,0 +1,209 @@
+#include "../include/sweep.hpp"
+#include <charconv>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+static const char *const SWEEP_KEYS[] = {"traders", "price", "cash", "speed", "duration", "book",
+                                         "tick", "matching", "ttl", "layout", "instruments"};
+
+static bool parseNumber(const std::string &text, double &value)
+{
+    auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    return result.ec == std::errc() && result.ptr == text.data() + text.size();
+}
+
+static bool parseCount(const std::string &text, int &value)
+{
+    auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    return result.ec == std::errc() && result.ptr == text.data() + text.size() && value > 0;
+}
+
+static bool isSweepKey(const std::string &key)
+{
+    for (const char *name : SWEEP_KEYS)
+    {
+        if (key == name)
+            return true;
+    }
+    return false;
+}
+
+// Same limits as the matching command-line options
+static bool applySetting(SweepPoint &point, const std::string &key, const std::string &value)
+{
+    double number = 0.0;
+    if (key == "traders")
+        return parseCount(value, point.num_traders);
+    if (key == "instruments")
+        return parseCount(value, point.instruments);
+    if (key == "book")
+    {
+        if (value != "map" && value != "tick")
+            return false;
+        point.book_type = (value == "tick") ? OrderBookType::TICK : OrderBookType::MAP;
+        return true;
+    }
+    if (key == "matching")
+    {
+        if (value != "continuous" && value != "batch")
+            return false;
+        point.matching_mode = (value == "batch") ? MatchingMode::BATCH_AUCTION : MatchingMode::CONTINUOUS;
+        return true;
+    }
+    if (key == "layout")
+    {
+        if (value != "objects" && value != "soa")
+            return false;
+        point.population_layout = (value == "soa") ? PopulationLayout::SOA : PopulationLayout::OBJECTS;
+        return true;
+    }
+
+    if (!parseNumber(value, number))
+        return false;
+    if (key == "price" && number > 0.0)
+        point.initial_price = number;
+    else if (key == "cash" && number >= 0.0)
+        point.initial_cash = number;
+    else if (key == "speed" && number > 0.0)
+        point.time_scale = number;
+    else if (key == "duration" && number > 0.0)
+        point.duration_seconds = number;
+    else if (key == "tick" && number > 0.0)
+        point.tick_size = number;
+    else if (key == "ttl" && number >= 0.0)
+        point.order_lifetime = number;
+    else
+        return false;
+    return true;
+}
+
+bool loadSweepFile(const std::string &filename, const SweepPoint &defaults, std::vector<SweepPoint> &points)
+{
+    std::ifstream file(filename);
+    if (!file.is_open())
+    {
+        std::cerr << "Error: cannot open sweep file '" << filename << "'\n";
+        return false;
+    }
+
+    std::string line;
+    int line_number = 0;
+    while (std::getline(file, line))
+    {
+        line_number++;
+        line = line.substr(0, line.find('#'));
+
+        // Each setting's values, in the order written
+        std::vector<std::pair<std::string, std::vector<std::string>>> axes;
+        std::istringstream settings(line);
+        std::string setting;
+        while (settings >> setting)
+        {
+            size_t equals = setting.find('=');
+            std::string key = setting.substr(0, equals);
+            if (equals == std::string::npos || !isSweepKey(key))
+            {
+                std::cerr << "Error: " << filename << ":" << line_number << ": expected <key>=<values>, got '"
+                          << setting << "'\n";
+                return false;
+            }
+
+            std::vector<std::string> values;
+            std::istringstream list(setting.substr(equals + 1));
+            std::string value;
+            while (std::getline(list, value, ','))
+                values.push_back(value);
+
+            // Every value is checked here, not only the first config using it
+            SweepPoint probe = defaults;
+            for (const std::string &candidate : values)
+            {
+                if (!applySetting(probe, key, candidate))
+                {
+                    std::cerr << "Error: " << filename << ":" << line_number << ": bad value '" << candidate
+                              << "' for " << key << "\n";
+                    return false;
+                }
+            }
+            if (values.empty())
+            {
+                std::cerr << "Error: " << filename << ":" << line_number << ": no values for " << key << "\n";
+                return false;
+            }
+            axes.emplace_back(key, values);
+        }
+        if (axes.empty())
+            continue;
+
+        // Odometer over the axes, the last one turning fastest
+        std::vector<size_t> digits(axes.size(), 0);
+        while (true)
+        {
+            SweepPoint point = defaults;
+            for (size_t a = 0; a < axes.size(); a++)
+                applySetting(point, axes[a].first, axes[a].second[digits[a]]);
+            points.push_back(point);
+
+            size_t a = axes.size();
+            while (a > 0 && ++digits[a - 1] == axes[a - 1].second.size())
+                digits[--a] = 0;
+            if (a == 0)
+                break;
+        }
+    }
+    return true;
+}
+
+std::string describeSweepPoint(const SweepPoint &point)
+{
+    std::ostringstream out;
+    out << "traders=" << point.num_traders << " price=" << point.initial_price << " cash=" << point.initial_cash
+        << " speed=" << point.time_scale << " duration=" << point.duration_seconds
+        << " book=" << (point.book_type == OrderBookType::TICK ? "tick" : "map") << " tick=" << point.tick_size
+        << " matching=" << (point.matching_mode == MatchingMode::BATCH_AUCTION ? "batch" : "continuous")
+        << " ttl=" << point.order_lifetime
+        << " layout=" << (point.population_layout == PopulationLayout::SOA ? "soa" : "objects")
+        << " instruments=" << point.instruments;
+    return out.str();
+}
+
+bool writeSweepResults(const std::string &filename, const std::vector<SweepPoint> &points,
+                       const std::vector<EnsembleAccumulator> &results, const std::vector<double> &wall_seconds,
+                       int seeds, unsigned int base_seed)
+{
+    std::ofstream out(filename, std::ios::out | std::ios::trunc);
+    if (!out.is_open())
+        return false;
+
+    out << "Config,Traders,Price,Cash,Speed,Duration,Book,Tick,Matching,OrderTTL,Layout,Instruments,"
+        << "Seeds,WallSeconds,MeanTrades,StddevTrades,MeanVolume,StddevVolume,P5Volume,P50Volume,P95Volume,"
+        << "MeanPrice,MeanVolatility,BestSeed,BestVolume,WorstSeed,WorstVolume\n";
+
+    // Sim indices are job numbers, config * seeds + seed offset
+    auto seed_of = [&](const SimulationSummaryPacket &packet)
+    { return base_seed + static_cast<unsigned int>(packet.simulation_index % seeds); };
+
+    for (size_t i = 0; i < points.size(); i++)
+    {
+        const SweepPoint &point = points[i];
+        const EnsembleAccumulator &summary = results[i];
+        out << i << "," << point.num_traders << "," << point.initial_price << "," << point.initial_cash << ","
+            << point.time_scale << "," << point.duration_seconds << ","
+            << (point.book_type == OrderBookType::TICK ? "tick" : "map") << "," << point.tick_size << ","
+            << (point.matching_mode == MatchingMode::BATCH_AUCTION ? "batch" : "continuous") << ","
+            << point.order_lifetime << "," << (point.population_layout == PopulationLayout::SOA ? "soa" : "objects")
+            << "," << point.instruments << "," << summary.getCount() << ","
+            << std::fixed << std::setprecision(3) << wall_seconds[i] << std::setprecision(2) << ","
+            << summary.getMeanTrades() << "," << summary.getStddevTrades() << ","
+            << summary.getMeanVolume() << "," << summary.getStddevVolume() << ","
+            << summary.getVolumeQuantile(0.05) << "," << summary.getVolumeQuantile(0.50) << ","
+            << summary.getVolumeQuantile(0.95) << ","
+            << summary.getMeanPrice() << "," << summary.getMeanVolatility() << ","
+            << seed_of(summary.getBest()) << "," << summary.getBest().stats.total_volume << ","
+            << seed_of(summary.getWorst()) << "," << summary.getWorst().stats.total_volume << "\n";
+        out << std::defaultfloat << std::setprecision(6);
+    }
+    return out.good();
+}
@@ -0,0 +1,122 @@
+#include "../include/thread_pool.hpp"
+#include <omp.h>
+#include <algorithm>
+
+ThreadPool::ThreadPool(int num_threads)
+    : queued(0), pending(0), stopping(false), next_queue(0)
+{
+    if (num_threads <= 0)
+    {
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for (int i = 0; i < num_threads; i++)
+    {
+        queues.push_back(std::make_unique<WorkQueue>());
+    }
+    for (int i = 0; i < num_threads; i++)
+    {
+        workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(state_mutex);
+        stopping = true;
+    }
+    work_available.notify_all();
+
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task)
+{
+    unsigned target = next_queue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+    {
+        std::lock_guard<std::mutex> lock(queues[target]->mutex);
+        queues[target]->tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> lock(state_mutex);
+        queued++;
+        pending++;
+    }
+    work_available.notify_one();
+}
+
+void ThreadPool::wait()
+{
+    std::unique_lock<std::mutex> lock(state_mutex);
+    all_done.wait(lock, [this]
+                  { return pending == 0; });
+}
+
+bool ThreadPool::takeTask(int worker, std::function<void()> &task)
+{
+    // Own queue first, newest task
+    {
+        WorkQueue &own = *queues[worker];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty())
+        {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+
+    // Steal the oldest task from the next non-empty victim
+    int count = static_cast<int>(queues.size());
+    for (int offset = 1; offset < count; offset++)
+    {
+        WorkQueue &victim = *queues[(worker + offset) % count];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty())
+        {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void ThreadPool::workerLoop(int worker)
+{
+    // Tasks are whole simulations; nested OpenMP would only oversubscribe
+    omp_set_num_threads(1);
+
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(state_mutex);
+            work_available.wait(lock, [this]
+                                { return queued > 0 || stopping; });
+            if (queued == 0 && stopping)
+                return;
+        }
+
+        std::function<void()> task;
+        if (!takeTask(worker, task))
+            continue; // Another worker got there first
+
+        {
+            std::lock_guard<std::mutex> lock(state_mutex);
+            queued--;
+        }
+
+        task();
+
+        {
+            std::lock_guard<std::mutex> lock(state_mutex);
+            if (--pending == 0)
+                all_done.notify_all();
+        }
+    }
+}
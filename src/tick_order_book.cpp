@@ -0,0 +1,191 @@
+#include "../include/tick_order_book.hpp"
+#include <cmath>
+
+// Tolerance when snapping to ticks so 170.85 stored as 170.8499999 stays on 170.85
+static constexpr double TICK_EPSILON = 1e-9;
+
+static std::int64_t nextPowerOfTwo(std::int64_t value)
+{
+    std::int64_t result = 1;
+    while (result < value)
+    {
+        result <<= 1;
+    }
+    return result;
+}
+
+TickOrderBook::TickOrderBook(double tick, int initial_levels)
+    : tick_size(tick > 0.0 ? tick : 0.01)
+{
+    std::int64_t capacity = nextPowerOfTwo(std::max(initial_levels, 64));
+
+    bids.levels.resize(capacity);
+    bids.mask = capacity - 1;
+    bids.is_bid = true;
+
+    asks.levels.resize(capacity);
+    asks.mask = capacity - 1;
+    asks.is_bid = false;
+}
+
+double TickOrderBook::snapPrice(OrderType side, double price) const
+{
+    double ticks = price / tick_size;
+    if (side == OrderType::BUY)
+    {
+        return tickToPrice(static_cast<std::int64_t>(std::floor(ticks + TICK_EPSILON)));
+    }
+    return tickToPrice(static_cast<std::int64_t>(std::ceil(ticks - TICK_EPSILON)));
+}
+
+std::int64_t TickOrderBook::toTick(double price) const
+{
+    return std::llround(price / tick_size);
+}
+
+void TickOrderBook::ensureRange(BookSide &side, std::int64_t tick)
+{
+    if (side.empty())
+        return;
+
+    std::int64_t lo = std::min({side.best_tick, side.worst_tick, tick});
+    std::int64_t hi = std::max({side.best_tick, side.worst_tick, tick});
+    std::int64_t width = hi - lo + 1;
+    std::int64_t capacity = side.mask + 1;
+
+    if (width <= capacity)
+        return;
+
+    // Re-home the live window into a larger ring; only the old window is copied
+    std::int64_t new_capacity = nextPowerOfTwo(width * 2);
+    std::vector<PriceLevel> new_levels(new_capacity);
+    counters.allocations++;
+    std::int64_t new_mask = new_capacity - 1;
+
+    std::int64_t old_lo = std::min(side.best_tick, side.worst_tick);
+    std::int64_t old_hi = std::max(side.best_tick, side.worst_tick);
+    for (std::int64_t t = old_lo; t <= old_hi; t++)
+    {
+        PriceLevel &moved = new_levels[t & new_mask];
+        moved = side.at(t);
+
+        // Queued orders point back at their level, repoint them
+        for (int handle = moved.head; handle >= 0; handle = pool[handle].next)
+        {
+            pool[handle].level = &moved;
+        }
+    }
+
+    side.levels.swap(new_levels);
+    side.mask = new_mask;
+}
+
+void TickOrderBook::advanceBest(BookSide &side)
+{
+    if (side.empty())
+        return;
+
+    // Walk away from the old best towards the worst live tick
+    std::int64_t step = side.is_bid ? -1 : 1;
+    std::int64_t tick = side.best_tick;
+    while (side.at(tick).head < 0 && tick != side.worst_tick)
+    {
+        tick += step;
+    }
+    side.best_tick = tick;
+}
+
+void TickOrderBook::retreatWorst(BookSide &side)
+{
+    if (side.empty())
+        return;
+
+    // Walk back from the old worst towards the best live tick
+    std::int64_t step = side.is_bid ? 1 : -1;
+    std::int64_t tick = side.worst_tick;
+    while (side.at(tick).head < 0 && tick != side.best_tick)
+    {
+        tick += step;
+    }
+    side.worst_tick = tick;
+}
+
+PriceLevel &TickOrderBook::getOrCreateLevel(OrderType type, double price)
+{
+    BookSide &side = sideFor(type);
+    std::int64_t tick = toTick(price);
+
+    ensureRange(side, tick);
+
+    PriceLevel &level = side.at(tick);
+    if (level.head < 0)
+    {
+        if (side.empty())
+        {
+            side.best_tick = tick;
+            side.worst_tick = tick;
+        }
+        else
+        {
+            if (side.better(tick, side.best_tick))
+                side.best_tick = tick;
+            if (side.better(side.worst_tick, tick))
+                side.worst_tick = tick;
+        }
+        side.level_count++;
+    }
+
+    return level;
+}
+
+void TickOrderBook::removeLevel(OrderType type, double price)
+{
+    BookSide &side = sideFor(type);
+    side.level_count--;
+
+    // Keep both ends on live levels so the window that ensureRange sizes the
+    // ring by and visitLevels walks only spans resting prices
+    std::int64_t tick = toTick(price);
+    if (tick == side.best_tick)
+    {
+        advanceBest(side);
+    }
+    else if (tick == side.worst_tick)
+    {
+        retreatWorst(side);
+    }
+}
+
+PriceLevel *TickOrderBook::bestLevel(OrderType type)
+{
+    BookSide &side = sideFor(type);
+    if (side.empty())
+        return nullptr;
+    return &side.at(side.best_tick);
+}
+
+double TickOrderBook::bestPrice(OrderType type) const
+{
+    const BookSide &side = sideFor(type);
+    if (side.empty())
+        return 0.0;
+    return tickToPrice(side.best_tick);
+}
+
+void TickOrderBook::visitLevels(OrderType type, const LevelVisitor &visit) const
+{
+    const BookSide &side = sideFor(type);
+    if (side.empty())
+        return;
+
+    std::int64_t step = side.is_bid ? -1 : 1;
+    for (std::int64_t tick = side.best_tick;; tick += step)
+    {
+        const PriceLevel &level = side.at(tick);
+        if (level.head >= 0 && !visit(tickToPrice(tick), level))
+            break;
+
+        if (tick == side.worst_tick)
+            break;
+    }
+}
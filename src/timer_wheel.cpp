@@ -0,0 +1,101 @@
+#include "../include/timer_wheel.hpp"
+
+static constexpr std::uint64_t SLOT_MASK = TimerWheel::SLOTS - 1;
+static constexpr int WHEEL_BITS = TimerWheel::SLOT_BITS * TimerWheel::LEVELS;
+
+TimerWheel::TimerWheel()
+    : current_tick(0), pending(0)
+{
+}
+
+void TimerWheel::reset(std::uint64_t tick)
+{
+    for (auto &level : slots)
+    {
+        for (auto &slot : level)
+            slot.clear();
+    }
+    overflow.clear();
+    due.clear();
+    current_tick = tick;
+    pending = 0;
+}
+
+void TimerWheel::place(const Timer &timer)
+{
+    if (timer.tick <= current_tick)
+    {
+        due.push_back(timer);
+        return;
+    }
+
+    // Level from the highest bit group where the tick leaves the current one
+    std::uint64_t differing = timer.tick ^ current_tick;
+    if (differing >> WHEEL_BITS)
+    {
+        overflow.push_back(timer);
+        return;
+    }
+    int level = 0;
+    while (differing >> (SLOT_BITS * (level + 1)))
+        level++;
+    slots[level][(timer.tick >> (SLOT_BITS * level)) & SLOT_MASK].push_back(timer);
+}
+
+void TimerWheel::cascade(std::vector<Timer> &slot)
+{
+    if (slot.empty())
+        return;
+
+    // Swapped out first: overflow timers can be placed straight back
+    std::vector<Timer> timers;
+    timers.swap(slot);
+    for (const Timer &timer : timers)
+        place(timer);
+}
+
+void TimerWheel::schedule(int id, std::uint64_t tick)
+{
+    place(Timer{id, tick});
+    pending++;
+}
+
+void TimerWheel::advance(std::uint64_t now_tick, std::vector<int> &fired)
+{
+    for (const Timer &timer : due)
+        fired.push_back(timer.id);
+    pending -= due.size();
+    due.clear();
+
+    while (current_tick < now_tick)
+    {
+        if (pending == 0)
+        {
+            current_tick = now_tick;
+            break;
+        }
+
+        current_tick++;
+
+        // Higher levels first, so their timers land in the slots cascaded next
+        if ((current_tick & ((std::uint64_t(1) << WHEEL_BITS) - 1)) == 0)
+            cascade(overflow);
+        for (int level = LEVELS - 1; level > 0; level--)
+        {
+            int shift = SLOT_BITS * level;
+            if ((current_tick & ((std::uint64_t(1) << shift) - 1)) == 0)
+                cascade(slots[level][(current_tick >> shift) & SLOT_MASK]);
+        }
+
+        // Cascading only re-places timers for this tick or later, so any
+        // due ones were added above
+        std::vector<Timer> &slot = slots[0][current_tick & SLOT_MASK];
+        for (const Timer &timer : slot)
+            fired.push_back(timer.id);
+        for (const Timer &timer : due)
+            fired.push_back(timer.id);
+        pending -= slot.size() + due.size();
+        slot.clear();
+        due.clear();
+    }
+}
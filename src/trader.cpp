@@ -1,16 +1,16 @@
 #include "../include/trader.hpp"
+#include "../include/strategy_policy.hpp"
 #include <cmath>
 #include <algorithm>
-#include <numeric>
-#include <omp.h>
 
-double TechnicalIndicators::calculateSMA(const std::vector<double> &prices, int period)
+double TechnicalIndicators::calculateSMA(PriceSpan prices, int period)
 {
     if (prices.size() < period)
         return 0.0;
 
+    // Serial: callers run inside the per-trader loop, and a window sum is
+    // far below the cost of an OpenMP region
     double sum = 0.0;
-#pragma omp parallel for reduction(+ : sum) if (period > 50)
     for (int i = prices.size() - period; i < prices.size(); i++)
     {
         sum += prices[i];
@@ -19,7 +19,7 @@ double TechnicalIndicators::calculateSMA(const std::vector<double> &prices, int
     return sum / period;
 }
 
-double TechnicalIndicators::calculateEMA(const std::vector<double> &prices, int period)
+double TechnicalIndicators::calculateEMA(PriceSpan prices, int period)
 {
     if (prices.size() < period)
         return 0.0;
@@ -35,41 +35,24 @@ double TechnicalIndicators::calculateEMA(const std::vector<double> &prices, int
     return ema;
 }
 
-double TechnicalIndicators::calculateRSI(const std::vector<double> &prices, int period)
+double TechnicalIndicators::calculateRSI(PriceSpan prices, int period)
 {
     if (prices.size() < period + 1)
         return 50.0;
 
-    std::vector<double> gains, losses;
+    double gain_sum = 0.0, loss_sum = 0.0;
 
     for (int i = prices.size() - period; i < prices.size(); i++)
     {
         double change = prices[i] - prices[i - 1];
         if (change > 0)
-        {
-            gains.push_back(change);
-            losses.push_back(0);
-        }
+            gain_sum += change;
         else
-        {
-            gains.push_back(0);
-            losses.push_back(-change);
-        }
+            loss_sum -= change;
     }
 
-    double avg_gain = 0.0, avg_loss = 0.0;
-
-#pragma omp parallel sections
-    {
-#pragma omp section
-        {
-            avg_gain = std::accumulate(gains.begin(), gains.end(), 0.0) / period;
-        }
-#pragma omp section
-        {
-            avg_loss = std::accumulate(losses.begin(), losses.end(), 0.0) / period;
-        }
-    }
+    double avg_gain = gain_sum / period;
+    double avg_loss = loss_sum / period;
 
     if (avg_loss == 0.0)
         return 100.0;
@@ -80,8 +63,29 @@ double TechnicalIndicators::calculateRSI(const std::vector<double> &prices, int
     return rsi;
 }
 
+// EMA of prices[0..end) as calculateEMA would compute it on that prefix,
+// without copying the prefix out
+static double emaOfPrefix(PriceSpan prices, size_t end, int period)
+{
+    double multiplier = 2.0 / (period + 1);
+
+    double ema = 0.0;
+    for (size_t i = end - period; i < end; i++)
+    {
+        ema += prices[i];
+    }
+    ema /= period;
+
+    for (size_t i = end - period + 1; i < end; i++)
+    {
+        ema = (prices[i] - ema) * multiplier + ema;
+    }
+
+    return ema;
+}
+
 std::tuple<double, double, double> TechnicalIndicators::calculateMACD(
-    const std::vector<double> &prices,
+    PriceSpan prices,
     int fast_period,
     int slow_period,
     int signal_period)
@@ -96,17 +100,16 @@ std::tuple<double, double, double> TechnicalIndicators::calculateMACD(
     double macd_line = fast_ema_latest - slow_ema_latest;
 
     std::vector<double> macd_series;
-    macd_series.reserve(signal_period);
+    macd_series.reserve(signal_period + 1);
 
     size_t start_index = prices.size() - (signal_period + 1);
     for (size_t idx = start_index; idx < prices.size(); ++idx)
     {
-        std::vector<double> prefix(prices.begin(), prices.begin() + idx + 1);
-        if (prefix.size() >= slow_period)
+        size_t prefix_size = idx + 1;
+        if (prefix_size >= static_cast<size_t>(slow_period))
         {
-            double fast_ema = calculateEMA(prefix, fast_period);
-            double slow_ema = calculateEMA(prefix, slow_period);
-            macd_series.push_back(fast_ema - slow_ema);
+            macd_series.push_back(emaOfPrefix(prices, prefix_size, fast_period) -
+                                  emaOfPrefix(prices, prefix_size, slow_period));
         }
     }
 
@@ -122,7 +125,7 @@ std::tuple<double, double, double> TechnicalIndicators::calculateMACD(
 }
 
 std::tuple<double, double, double> TechnicalIndicators::calculateBollingerBands(
-    const std::vector<double> &prices,
+    PriceSpan prices,
     int period,
     double std_dev)
 {
@@ -134,7 +137,6 @@ std::tuple<double, double, double> TechnicalIndicators::calculateBollingerBands(
     double sma = calculateSMA(prices, period);
 
     double variance = 0.0;
-#pragma omp parallel for reduction(+ : variance) if (period > 50)
     for (int i = prices.size() - period; i < prices.size(); i++)
     {
         double diff = prices[i] - sma;
@@ -150,38 +152,50 @@ std::tuple<double, double, double> TechnicalIndicators::calculateBollingerBands(
 }
 
 void TechnicalIndicators::calculateAllIndicators(
-    const std::vector<double> &prices,
+    PriceSpan prices,
     double &rsi,
     std::tuple<double, double, double> &macd,
     std::tuple<double, double, double> &bollinger)
 {
-#pragma omp parallel sections
-    {
-#pragma omp section
-        {
-            rsi = calculateRSI(prices);
-        }
-#pragma omp section
-        {
-            macd = calculateMACD(prices);
-        }
-#pragma omp section
-        {
-            bollinger = calculateBollingerBands(prices);
-        }
-    }
+    // Three window scans of microseconds each: a thread team costs more
+    rsi = calculateRSI(prices);
+    macd = calculateMACD(prices);
+    bollinger = calculateBollingerBands(prices);
 }
 
 Trader::Trader(int trader_id, Strategy strat, double initial_cash, unsigned int seed)
     : id(trader_id), strategy(strat), cash(initial_cash),
       holdings(0), total_profit(0), trades_executed(0),
-      rng(seed),
-      last_rsi(50.0), last_macd(0.0), last_bollinger_upper(0.0), last_bollinger_lower(0.0)
+      own_history(std::make_unique<PriceHistory>(TRADER_PRICE_WINDOW)),
+      rng(seed, static_cast<std::uint32_t>(trader_id)), decision_step(0), indicators(nullptr)
 {
+    price_history = own_history.get();
 }
 
-Trade Trader::makeDecision(double current_price, double timestamp)
+void Trader::attachIndicators(const IndicatorEngine *engine, IndicatorSet ids)
+{
+    indicators = engine;
+    indicator_ids = ids;
+}
+
+void Trader::attachPriceHistory(const PriceHistory *history)
+{
+    if (history == nullptr)
+    {
+        own_history = std::make_unique<PriceHistory>(TRADER_PRICE_WINDOW);
+        price_history = own_history.get();
+        return;
+    }
+
+    own_history.reset();
+    price_history = history;
+}
+
+template <typename Policy>
+Trade Trader::decide(double current_price, double timestamp)
 {
+    PriceSpan prices = recentPrices();
+
     Trade trade;
     trade.trader_id = id;
     trade.price = current_price;
@@ -189,207 +203,30 @@ Trade Trader::makeDecision(double current_price, double timestamp)
     trade.quantity = 0;
     trade.is_buy = true;
 
-    if (price_history.size() < 5)
+    if (prices.size() < 5)
     {
         return trade;
     }
 
-    bool should_buy = false;
-    bool should_sell = false;
-
-    switch (strategy)
-    {
-    case Strategy::MOMENTUM:
-    {
-        double recent_avg = 0;
-        double older_avg = 0;
-        int half = price_history.size() / 2;
-
-        for (int i = half; i < price_history.size(); i++)
-        {
-            recent_avg += price_history[i];
-        }
-        recent_avg /= (price_history.size() - half);
-
-        for (int i = 0; i < half; i++)
-        {
-            older_avg += price_history[i];
-        }
-        older_avg /= half;
-
-        if (recent_avg > older_avg * 1.02)
-        {
-            should_buy = true;
-        }
-        else if (recent_avg < older_avg * 0.98)
-        {
-            should_sell = true;
-        }
-        break;
-    }
-
-    case Strategy::MEAN_REVERSION:
-    {
-        double mean = 0;
-        for (double p : price_history)
-        {
-            mean += p;
-        }
-        mean /= price_history.size();
-
-        if (current_price < mean * 0.95)
-        {
-            should_buy = true;
-        }
-        else if (current_price > mean * 1.05)
-        {
-            should_sell = true;
-        }
-        break;
-    }
-
-    case Strategy::RANDOM:
-    {
-        std::uniform_int_distribution<> dist(0, 10);
-        int decision = dist(rng);
-        should_buy = (decision == 1);
-        should_sell = (decision == 2);
-        break;
-    }
-
-    case Strategy::RISK_AVERSE:
-    {
-        double mean = 0;
-        for (double p : price_history)
-        {
-            mean += p;
-        }
-        mean /= price_history.size();
-
-        if (current_price < mean * 0.90)
-        {
-            should_buy = true;
-        }
-        else if (current_price > mean * 1.10)
-        {
-            should_sell = true;
-        }
-        break;
-    }
-
-    case Strategy::HIGH_RISK:
-    {
-        double recent_avg = 0;
-        int recent_count = std::min(3, static_cast<int>(price_history.size()));
-        for (int i = price_history.size() - recent_count; i < price_history.size(); i++)
-        {
-            recent_avg += price_history[i];
-        }
-        recent_avg /= recent_count;
-
-        if (current_price > recent_avg * 1.01)
-        {
-            should_buy = true;
-        }
-        else if (current_price < recent_avg * 0.99)
-        {
-            should_sell = true;
-        }
-        break;
-    }
-
-    case Strategy::RSI_BASED:
+    Signal signal;
+    if constexpr (Policy::draws_per_trader)
     {
-        updateIndicators();
-        if (last_rsi < 30)
-        {
-            should_buy = true;
-        }
-        else if (last_rsi > 70)
-        {
-            should_sell = true;
-        }
-        break;
+        signal = Policy::fromRoll(rng.uniformInt(decision_step, Policy::ROLL_SIDES));
     }
-
-    case Strategy::MACD_BASED:
-    {
-        updateIndicators();
-        auto [macd_line, signal_line, histogram] = TechnicalIndicators::calculateMACD(price_history);
-
-        if (histogram > 0 && last_macd <= 0)
-        {
-            should_buy = true;
-        }
-        else if (histogram < 0 && last_macd >= 0)
-        {
-            should_sell = true;
-        }
-        last_macd = histogram;
-        break;
-    }
-
-    case Strategy::BOLLINGER:
-    {
-        updateIndicators();
-        if (current_price < last_bollinger_lower)
-        {
-            should_buy = true;
-        }
-        else if (current_price > last_bollinger_upper)
-        {
-            should_sell = true;
-        }
-        break;
-    }
-
-    case Strategy::MULTI_INDICATOR:
-    {
-        updateIndicators();
-        int buy_signals = 0;
-        int sell_signals = 0;
-
-        if (last_rsi < 35)
-            buy_signals++;
-        if (last_rsi > 65)
-            sell_signals++;
-
-        if (current_price < last_bollinger_lower)
-            buy_signals++;
-        if (current_price > last_bollinger_upper)
-            sell_signals++;
-
-        auto [macd_line, signal_line, histogram] = TechnicalIndicators::calculateMACD(price_history);
-        if (histogram > 0)
-            buy_signals++;
-        if (histogram < 0)
-            sell_signals++;
-
-        if (buy_signals >= 2)
-            should_buy = true;
-        if (sell_signals >= 2)
-            should_sell = true;
-        break;
-    }
-    }
-
-    int trade_size = 10;
-
-    if (strategy == Strategy::RISK_AVERSE)
-    {
-        trade_size = 5;
-    }
-    else if (strategy == Strategy::HIGH_RISK)
+    else
     {
-        trade_size = 20;
+        double previous_macd = last_indicators.macd;
+        refreshIndicators<Policy::needs>(last_indicators, prices, indicators, indicator_ids);
+        signal = Policy::signal(SignalInputs{prices, current_price, last_indicators, previous_macd});
     }
 
-    if (should_buy && cash >= current_price * trade_size)
+    constexpr int trade_size = Policy::trade_size;
+    if (signal.buy && cash >= current_price * trade_size)
     {
         trade.is_buy = true;
         trade.quantity = std::min(trade_size, static_cast<int>(cash / current_price));
     }
-    else if (should_sell && holdings >= trade_size)
+    else if (signal.sell && holdings >= trade_size)
     {
         trade.is_buy = false;
         trade.quantity = std::min(trade_size, holdings);
@@ -398,7 +235,8 @@ Trade Trader::makeDecision(double current_price, double timestamp)
     return trade;
 }
 
-TraderOrder Trader::createOrder(double current_price, double timestamp)
+template <typename Policy>
+TraderOrder Trader::createOrderAs(double current_price, double timestamp)
 {
     TraderOrder order;
     order.trader_id = id;
@@ -406,18 +244,20 @@ TraderOrder Trader::createOrder(double current_price, double timestamp)
     order.quantity = 0;
     order.is_buy = true;
 
-    price_history.push_back(current_price);
-    if (price_history.size() > 50)
+    // One RNG step per call, whether or not a draw is made
+    decision_step++;
+
+    if (own_history)
     {
-        price_history.erase(price_history.begin());
+        own_history->push(current_price);
     }
 
-    if (price_history.size() < 3)
+    if (price_history->size() < 3)
     {
         return order;
     }
 
-    Trade trade = makeDecision(current_price, timestamp);
+    Trade trade = decide<Policy>(current_price, timestamp);
 
     if (trade.quantity > 0)
     {
@@ -437,10 +277,77 @@ TraderOrder Trader::createOrder(double current_price, double timestamp)
     return order;
 }
 
-void Trader::executeOrder(bool is_buy, double price, int quantity)
+Trade Trader::makeDecision(double current_price, double timestamp)
+{
+    return visitStrategy(strategy, [&](auto policy)
+                         { return decide<decltype(policy)>(current_price, timestamp); });
+}
+
+TraderOrder Trader::createOrder(double current_price, double timestamp)
+{
+    return visitStrategy(strategy, [&](auto policy)
+                         { return createOrderAs<decltype(policy)>(current_price, timestamp); });
+}
+
+void Trader::createOrders(Strategy strategy, const std::vector<std::unique_ptr<Trader>> &traders,
+                          const int *indices, int count, double current_price, double timestamp,
+                          TraderOrder *slots)
+{
+    visitStrategy(strategy, [&](auto policy)
+                  {
+                      using Policy = decltype(policy);
+                      for (int k = 0; k < count; k++)
+                      {
+                          int i = indices[k];
+                          slots[i] = traders[i]->createOrderAs<Policy>(current_price, timestamp);
+                      }
+                  });
+}
+
+void StrategyRuns::build(const std::vector<std::unique_ptr<Trader>> &traders)
+{
+    std::vector<int> positions(traders.size());
+    for (size_t i = 0; i < positions.size(); i++)
+        positions[i] = static_cast<int>(i);
+    build(traders, positions.data(), positions.size());
+}
+
+void StrategyRuns::build(const std::vector<std::unique_ptr<Trader>> &traders, const int *positions, size_t count)
+{
+    // Counting sort by strategy; stable, so id order holds inside each run
+    constexpr int STRATEGY_COUNT = static_cast<int>(Strategy::MULTI_INDICATOR) + 1;
+    int starts[STRATEGY_COUNT] = {};
+    for (size_t k = 0; k < count; k++)
+    {
+        Strategy strategy = traders[positions[k]]->getStrategy();
+        if (strategy != Strategy::HUMAN)
+            starts[static_cast<int>(strategy)]++;
+    }
+
+    runs.clear();
+    int offset = 0;
+    for (int s = 0; s < STRATEGY_COUNT; s++)
+    {
+        int length = starts[s];
+        starts[s] = offset;
+        if (length > 0)
+            runs.push_back(StrategyRun{static_cast<Strategy>(s), offset, offset + length});
+        offset += length;
+    }
+
+    indices.resize(offset);
+    for (size_t k = 0; k < count; k++)
+    {
+        Strategy strategy = traders[positions[k]]->getStrategy();
+        if (strategy != Strategy::HUMAN)
+            indices[starts[static_cast<int>(strategy)]++] = positions[k];
+    }
+}
+
+bool Trader::executeOrder(bool is_buy, double price, int quantity)
 {
     if (quantity == 0)
-        return;
+        return true;
 
     if (is_buy)
     {
@@ -450,6 +357,7 @@ void Trader::executeOrder(bool is_buy, double price, int quantity)
             cash -= cost;
             holdings += quantity;
             trades_executed++;
+            return true;
         }
     }
     else
@@ -459,35 +367,10 @@ void Trader::executeOrder(bool is_buy, double price, int quantity)
             cash += price * quantity;
             holdings -= quantity;
             trades_executed++;
+            return true;
         }
     }
-}
-
-void Trader::updateIndicators()
-{
-    if (price_history.size() < 14)
-        return;
-
-    std::tuple<double, double, double> macd, bollinger;
-
-#pragma omp parallel sections
-    {
-#pragma omp section
-        {
-            last_rsi = TechnicalIndicators::calculateRSI(price_history);
-        }
-#pragma omp section
-        {
-            macd = TechnicalIndicators::calculateMACD(price_history);
-            last_macd = std::get<2>(macd); // histogram
-        }
-#pragma omp section
-        {
-            bollinger = TechnicalIndicators::calculateBollingerBands(price_history);
-            last_bollinger_upper = std::get<0>(bollinger);
-            last_bollinger_lower = std::get<2>(bollinger);
-        }
-    }
+    return false;
 }
 
 void Trader::executeTrade(const Trade &trade)
@@ -516,7 +399,32 @@ void Trader::executeTrade(const Trade &trade)
     }
 }
 
-std::string Trader::getStrategyName() const
+Strategy assignStrategy(int trader_index)
+{
+    if (trader_index == 0)
+        return Strategy::HUMAN;
+
+    int strategy_type = trader_index % 9;
+    if (strategy_type == 0)
+        return Strategy::MOMENTUM;
+    else if (strategy_type == 1)
+        return Strategy::MEAN_REVERSION;
+    else if (strategy_type == 2)
+        return Strategy::RANDOM;
+    else if (strategy_type == 3)
+        return Strategy::RISK_AVERSE;
+    else if (strategy_type == 4)
+        return Strategy::HIGH_RISK;
+    else if (strategy_type == 5)
+        return Strategy::RSI_BASED;
+    else if (strategy_type == 6)
+        return Strategy::MACD_BASED;
+    else if (strategy_type == 7)
+        return Strategy::BOLLINGER;
+    return Strategy::MULTI_INDICATOR;
+}
+
+std::string strategyName(Strategy strategy)
 {
     switch (strategy)
     {
@@ -542,3 +450,55 @@ std::string Trader::getStrategyName() const
         return "You";
     }
 }
+
+std::string Trader::getStrategyName() const
+{
+    return strategyName(strategy);
+}
+
+void Trader::saveState(CheckpointWriter &out) const
+{
+    out.put(id);
+    out.put(strategy);
+    out.put(cash);
+    out.put(holdings);
+    out.put(total_profit);
+    out.put(trades_executed);
+    out.put(rng);
+    out.put(decision_step);
+    out.put(last_indicators.rsi);
+    out.put(last_indicators.macd);
+    out.put(last_indicators.bollinger_upper);
+    out.put(last_indicators.bollinger_lower);
+
+    out.put(own_history != nullptr);
+    if (own_history)
+        own_history->saveState(out);
+}
+
+void Trader::loadState(CheckpointReader &in)
+{
+    if (in.get<int>() != id || in.get<Strategy>() != strategy)
+    {
+        in.fail();
+        return;
+    }
+    cash = in.get<double>();
+    holdings = in.get<int>();
+    total_profit = in.get<double>();
+    trades_executed = in.get<int>();
+    rng = in.get<CounterRng>();
+    decision_step = in.get<std::uint64_t>();
+    last_indicators.rsi = in.get<double>();
+    last_indicators.macd = in.get<double>();
+    last_indicators.bollinger_upper = in.get<double>();
+    last_indicators.bollinger_lower = in.get<double>();
+
+    if (in.get<bool>() != (own_history != nullptr))
+    {
+        in.fail();
+        return;
+    }
+    if (own_history)
+        own_history->loadState(in);
+}
@@ -0,0 +1,293 @@
+#include "../include/trader_population.hpp"
+#include "../include/execution_policy.hpp"
+#include "../include/strategy_policy.hpp"
+#include <algorithm>
+#include <omp.h>
+
+TraderPopulation::TraderPopulation(int num_traders, double initial_cash, unsigned int rng_seed)
+    : price_history(nullptr), own_history(std::make_unique<PriceHistory>(TRADER_PRICE_WINDOW)),
+      seed(rng_seed), tick(0), indicators(nullptr)
+{
+    // Bucket trader ids by strategy, keeping id order inside each bucket
+    std::vector<std::vector<int>> buckets(static_cast<int>(Strategy::MULTI_INDICATOR) + 1);
+    for (int i = 0; i < num_traders; i++)
+    {
+        buckets[static_cast<int>(assignStrategy(i))].push_back(i);
+    }
+
+    trader_ids.reserve(num_traders);
+    strategies.reserve(num_traders);
+    slot_of.assign(num_traders, -1);
+
+    for (size_t s = 0; s < buckets.size(); s++)
+    {
+        if (buckets[s].empty())
+            continue;
+
+        StrategyGroup group;
+        group.strategy = static_cast<Strategy>(s);
+        group.begin = static_cast<int>(trader_ids.size());
+        for (int id : buckets[s])
+        {
+            slot_of[id] = static_cast<int>(trader_ids.size());
+            trader_ids.push_back(id);
+            strategies.push_back(group.strategy);
+        }
+        group.end = static_cast<int>(trader_ids.size());
+        groups.push_back(group);
+    }
+
+    cash.assign(num_traders, initial_cash);
+    holdings.assign(num_traders, 0);
+    total_profit.assign(num_traders, 0.0);
+    trades_executed.assign(num_traders, 0);
+    decisions.assign(num_traders, 0);
+
+    price_history = own_history.get();
+}
+
+void TraderPopulation::attachIndicators(const IndicatorEngine *engine, IndicatorSet ids)
+{
+    indicators = engine;
+    indicator_ids = ids;
+}
+
+void TraderPopulation::attachPriceHistory(const PriceHistory *history)
+{
+    if (history == nullptr)
+    {
+        own_history = std::make_unique<PriceHistory>(TRADER_PRICE_WINDOW);
+        price_history = own_history.get();
+        return;
+    }
+
+    own_history.reset();
+    price_history = history;
+}
+
+void TraderPopulation::setInitialHoldings(int count, int initial_holdings)
+{
+    count = std::min(count, size());
+    for (int id = 0; id < count; id++)
+    {
+        holdings[slot_of[id]] = initial_holdings;
+    }
+}
+
+template <typename Policy>
+void TraderPopulation::decideGroup(StrategyGroup &group, double current_price)
+{
+    int begin = group.begin;
+    int end = group.end;
+
+    // Same signal as Trader::decide, once for the whole group
+    PriceSpan prices = price_history->recent(TRADER_PRICE_WINDOW);
+    double previous_macd = group.last_indicators.macd;
+    refreshIndicators<Policy::needs>(group.last_indicators, prices, indicators, indicator_ids);
+    Signal signal = Policy::signal(SignalInputs{prices, current_price, group.last_indicators, previous_macd});
+
+    if (!signal.buy && !signal.sell)
+    {
+        std::fill(decisions.begin() + begin, decisions.begin() + end, 0);
+        return;
+    }
+
+    constexpr int trade_size = Policy::trade_size;
+    const double buy_cost = current_price * trade_size;
+    const int buy_flag = signal.buy;
+    const int sell_flag = signal.sell;
+    const double *cash_data = cash.data();
+    const int *holdings_data = holdings.data();
+    int *decision_data = decisions.data();
+
+    // Same rules as Trader::decide: buy if affordable, otherwise sell if
+    // enough shares are held. cash >= price * size implies the full size fits.
+    ParallelRegion region(ParallelPhase::POPULATION, end - begin);
+#pragma omp parallel for simd schedule(static) if (region.parallel()) num_threads(region.threads())
+    for (int slot = begin; slot < end; slot++)
+    {
+        int buy = buy_flag & (cash_data[slot] >= buy_cost);
+        int sell = (1 - buy) & sell_flag & (holdings_data[slot] >= trade_size);
+        decision_data[slot] = (buy - sell) * trade_size;
+    }
+}
+
+template <typename Policy>
+void TraderPopulation::decideRandomGroup(const StrategyGroup &group, double current_price)
+{
+    int begin = group.begin;
+    int end = group.end;
+
+    constexpr int trade_size = Policy::trade_size;
+    const double buy_cost = current_price * trade_size;
+    const double *cash_data = cash.data();
+    const int *holdings_data = holdings.data();
+    const int *id_data = trader_ids.data();
+    int *decision_data = decisions.data();
+
+    ParallelRegion region(ParallelPhase::POPULATION, end - begin);
+#pragma omp parallel for simd schedule(static) if (region.parallel()) num_threads(region.threads())
+    for (int slot = begin; slot < end; slot++)
+    {
+        CounterRng rng(seed, static_cast<std::uint32_t>(id_data[slot]));
+        Signal signal = Policy::fromRoll(rng.uniformInt(tick, Policy::ROLL_SIDES));
+        int buy = signal.buy & (cash_data[slot] >= buy_cost);
+        int sell = signal.sell & (holdings_data[slot] >= trade_size);
+        decision_data[slot] = (buy - sell) * trade_size;
+    }
+}
+
+void TraderPopulation::generateOrders(double current_price, double timestamp, std::vector<Order> &orders,
+                                      int &total_buy_quantity, int &total_sell_quantity)
+{
+    tick++;
+
+    if (own_history)
+    {
+        own_history->push(current_price);
+    }
+
+    // Trader::createOrder needs 3 prices and makeDecision 5 before acting
+    if (price_history->size() < 5)
+        return;
+
+    for (auto &group : groups)
+    {
+        if (group.strategy == Strategy::HUMAN)
+            continue;
+
+        visitStrategy(group.strategy, [&](auto policy)
+                      {
+                          using Policy = decltype(policy);
+                          if constexpr (Policy::draws_per_trader)
+                              decideRandomGroup<Policy>(group, current_price);
+                          else
+                              decideGroup<Policy>(group, current_price);
+                      });
+    }
+
+    // Compact non-zero decisions into limit orders in trader id order
+    for (int id = 0; id < size(); id++)
+    {
+        int decision = decisions[slot_of[id]];
+        if (decision == 0)
+            continue;
+
+        if (decision > 0)
+        {
+            orders.emplace_back(0, id, OrderType::BUY, current_price * 1.005, decision, timestamp);
+            total_buy_quantity += decision;
+        }
+        else
+        {
+            orders.emplace_back(0, id, OrderType::SELL, current_price * 0.995, -decision, timestamp);
+            total_sell_quantity -= decision;
+        }
+    }
+}
+
+bool TraderPopulation::executeOrder(int trader_id, bool is_buy, double price, int quantity)
+{
+    if (quantity == 0)
+        return true;
+
+    int slot = slot_of[trader_id];
+    if (is_buy)
+    {
+        double cost = price * quantity;
+        if (cash[slot] >= cost)
+        {
+            cash[slot] -= cost;
+            holdings[slot] += quantity;
+            trades_executed[slot]++;
+            return true;
+        }
+    }
+    else
+    {
+        if (holdings[slot] >= quantity)
+        {
+            cash[slot] += price * quantity;
+            holdings[slot] -= quantity;
+            trades_executed[slot]++;
+            return true;
+        }
+    }
+    return false;
+}
+
+double TraderPopulation::getLastRSI(int trader_id) const
+{
+    Strategy strategy = getStrategy(trader_id);
+    for (const auto &group : groups)
+    {
+        if (group.strategy == strategy)
+            return group.last_indicators.rsi;
+    }
+    return 50.0;
+}
+
+double TraderPopulation::getLastMACD(int trader_id) const
+{
+    Strategy strategy = getStrategy(trader_id);
+    for (const auto &group : groups)
+    {
+        if (group.strategy == strategy)
+            return group.last_indicators.macd;
+    }
+    return 0.0;
+}
+
+void TraderPopulation::saveState(CheckpointWriter &out) const
+{
+    out.putVector(cash);
+    out.putVector(holdings);
+    out.putVector(total_profit);
+    out.putVector(trades_executed);
+    out.put(seed);
+    out.put(tick);
+
+    out.put(static_cast<std::uint64_t>(groups.size()));
+    for (const auto &group : groups)
+    {
+        out.put(group);
+    }
+
+    out.put(own_history != nullptr);
+    if (own_history)
+        own_history->saveState(out);
+}
+
+void TraderPopulation::loadState(CheckpointReader &in)
+{
+    in.getFixedVector(cash);
+    in.getFixedVector(holdings);
+    in.getFixedVector(total_profit);
+    in.getFixedVector(trades_executed);
+    seed = in.get<unsigned int>();
+    tick = in.get<std::uint64_t>();
+
+    if (in.get<std::uint64_t>() != groups.size())
+    {
+        in.fail();
+        return;
+    }
+    for (auto &group : groups)
+    {
+        StrategyGroup saved = in.get<StrategyGroup>();
+        if (saved.strategy != group.strategy || saved.begin != group.begin || saved.end != group.end)
+        {
+            in.fail();
+            return;
+        }
+        group = saved;
+    }
+
+    if (in.get<bool>() != (own_history != nullptr))
+    {
+        in.fail();
+        return;
+    }
+    if (own_history)
+        own_history->loadState(in);
+}
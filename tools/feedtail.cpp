@@ -0,0 +1,53 @@
+// Print a running simulation's shared-memory market feed, one line per tick.
+// Usage: feedtail <feed name> [ticks]   (until the simulation closes the feed if no count given)
+// Doubles as the reference subscriber: it needs nothing but market_feed.hpp.
+#include "../include/market_feed.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: feedtail <feed name> [ticks]\n";
+        return 1;
+    }
+    long long limit = argc > 2 ? std::atoll(argv[2]) : -1;
+
+    MarketFeedSubscriber feed;
+    if (!feed.open(argv[1]))
+    {
+        std::cerr << "No market feed '" << argv[1] << "' (start the simulation with --feed " << argv[1] << ")\n";
+        return 1;
+    }
+
+    std::cout << "Step,Time,Symbol,Price,BestBid,BestAsk,Spread,BidQty,AskQty,Trades,Volume\n"
+              << std::fixed << std::setprecision(2);
+    MarketFeedTick tick;
+    long long printed = 0;
+    while (limit < 0 || printed < limit)
+    {
+        if (!feed.next(tick))
+        {
+            if (!feed.isLive())
+                break;
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+            continue;
+        }
+
+        std::cout << tick.step << "," << tick.simulation_time << "," << tick.symbol << "," << tick.price << ","
+                  << tick.best_bid << "," << tick.best_ask << "," << tick.spread << ","
+                  << (tick.bid_levels > 0 ? tick.bids[0].quantity : 0) << ","
+                  << (tick.ask_levels > 0 ? tick.asks[0].quantity : 0) << "," << tick.step_trade_count << ","
+                  << tick.step_volume << "\n";
+        printed++;
+    }
+
+    std::cout.flush();
+    if (feed.getDropped() > 0)
+        std::cerr << "Dropped " << feed.getDropped() << " ticks the ring overwrote before they were read\n";
+    return 0;
+}
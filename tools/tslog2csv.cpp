@@ -0,0 +1,87 @@
+// Convert a binary .tslog file back into the CSV the text logger writes.
+// Usage: tslog2csv <input.tslog> [output.csv]   (stdout if no output given)
+#include "../include/binary_log.hpp"
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+
+static void writeFixed2(std::ostream &out, std::int64_t value)
+{
+    if (value < 0)
+    {
+        out << '-';
+        value = -value;
+    }
+    std::int64_t fraction = value % 100;
+    out << value / 100 << '.' << (fraction < 10 ? "0" : "") << fraction;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: tslog2csv <input.tslog> [output.csv]\n";
+        return 1;
+    }
+
+    BinaryLogReader reader;
+    if (!reader.open(argv[1]))
+    {
+        std::cerr << "Not a tslog file: " << argv[1] << std::endl;
+        return 1;
+    }
+
+    std::ofstream output_file;
+    if (argc > 2)
+    {
+        output_file.open(argv[2], std::ios::out | std::ios::trunc);
+        if (!output_file.is_open())
+        {
+            std::cerr << "Failed to open output file: " << argv[2] << std::endl;
+            return 1;
+        }
+    }
+    std::ostream &out = (argc > 2) ? output_file : std::cout;
+    out << std::setprecision(std::numeric_limits<double>::max_digits10); // FLOAT64 columns round-trip
+
+    const auto &columns = reader.getColumns();
+    for (size_t c = 0; c < columns.size(); c++)
+    {
+        out << (c ? "," : "") << columns[c].name;
+    }
+    out << "\n";
+
+    std::vector<std::vector<std::int64_t>> values;
+    long long total_rows = 0;
+    int rows;
+    while ((rows = reader.readBlock(values)) > 0)
+    {
+        for (int r = 0; r < rows; r++)
+        {
+            for (size_t c = 0; c < columns.size(); c++)
+            {
+                if (c)
+                    out << ',';
+                if (columns[c].kind == LogColumnKind::FIXED2)
+                    writeFixed2(out, values[c][r]);
+                else if (columns[c].kind == LogColumnKind::FLOAT64)
+                    out << BinaryLogReader::toDouble(columns[c].kind, values[c][r]);
+                else
+                    out << values[c][r];
+            }
+            out << '\n';
+        }
+        total_rows += rows;
+    }
+
+    if (rows < 0)
+    {
+        std::cerr << "Corrupt block after " << total_rows << " rows" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}